@@ -24,8 +24,9 @@ import {
   confirmWeight,
   confirmHeight,
   cancelWeighingFlow,
+  confirmNutritionStatus,
 } from "../../services/globalSessionService";
-import { addMeasurement } from "../../services/dataService";
+import { addMeasurement, updateMeasurement } from "../../services/dataService";
 import { updateUserProfile } from "../../services/userService";
 import {
   GLOBAL_SESSION_TYPES,
@@ -35,6 +36,9 @@ import {
 } from "../../utils/globalStates";
 import { Colors } from "../../constants/Colors";
 
+// Labels the device's KNN model learns from, in the order shown to the health worker
+const NUTRITION_STATUSES = ["gizi buruk", "gizi kurang", "gizi baik", "overweight", "obesitas"];
+
 export default function TimbangScreen() {
   const { userProfile } = useAuth();
   const router = useRouter();
@@ -50,6 +54,9 @@ export default function TimbangScreen() {
   const [weighingControlVisible, setWeighingControlVisible] = useState(false);
   const [currentWeighingStep, setCurrentWeighingStep] = useState('idle');
 
+  // Last measurement waiting for the health worker to confirm or correct its status
+  const [statusToConfirm, setStatusToConfirm] = useState(null);
+
   useEffect(() => {
     initializeSystemStatus();
   }, []);
@@ -225,6 +232,12 @@ export default function TimbangScreen() {
         handleRFIDVerificationFailed();
         break;
         
+      case 'classification_failed':
+        console.log('❌ Classification failed - hiding modal and showing alert');
+        setWeighingControlVisible(false);
+        handleClassificationFailed();
+        break;
+        
       default:
         console.log('💤 Default state - hiding modal, status:', weighingStatus);
         setWeighingControlVisible(false);
@@ -250,6 +263,24 @@ export default function TimbangScreen() {
     );
   };
 
+  const handleClassificationFailed = async () => {
+    setWeighingControlVisible(false);
+    setCurrentWeighingStep('idle');
+    
+    Alert.alert(
+      "Status Gizi Gagal Dihitung",
+      "Alat tidak dapat menentukan status gizi dari pengukuran ini, sehingga data tidak disimpan. Silakan ulangi penimbangan.",
+      [
+        {
+          text: "OK",
+          onPress: async () => {
+            await endGlobalSession();
+          }
+        }
+      ]
+    );
+  };
+
   const handleWeighingCompleted = async (data) => {
     try {
       setLoading(true);
@@ -284,6 +315,10 @@ export default function TimbangScreen() {
           dateTime: new Date(),
         });
         setResultModalVisible(true);
+        setStatusToConfirm({
+          measurementId: addResult.id,
+          status: data.nutritionStatus,
+        });
       }
 
       await endGlobalSession();
@@ -295,6 +330,34 @@ export default function TimbangScreen() {
     }
   };
 
+  const handleConfirmStatus = async (status) => {
+    try {
+      setLoading(true);
+      const result = await confirmNutritionStatus(status);
+      if (!result.success) {
+        Alert.alert("Kesalahan", result.error);
+        return;
+      }
+
+      if (status !== statusToConfirm.status) {
+        await updateMeasurement(userProfile.id, statusToConfirm.measurementId, {
+          nutritionStatus: status,
+        });
+      }
+
+      setStatusToConfirm(null);
+      Alert.alert(
+        "Status Dikonfirmasi",
+        `Status "${status}" dikirim ke alat untuk memperbarui model.`
+      );
+    } catch (error) {
+      console.error("Error confirming nutrition status:", error);
+      Alert.alert("Kesalahan", "Gagal mengirim konfirmasi status gizi");
+    } finally {
+      setLoading(false);
+    }
+  };
+
   const hasRFID = () => {
     return userProfile?.rfid && userProfile.rfid.trim() !== "";
   };
@@ -551,6 +614,34 @@ export default function TimbangScreen() {
             </View>
           )}
 
+          {statusToConfirm && (
+            <View style={styles.confirmContainer}>
+              <Text style={styles.confirmTitle}>Konfirmasi Status Gizi</Text>
+              <Text style={styles.confirmDescription}>
+                Petugas kesehatan: pilih status yang benar untuk pengukuran
+                terakhir. Alat akan belajar dari status ini.
+              </Text>
+              {NUTRITION_STATUSES.map((status) => (
+                <Button
+                  key={status}
+                  title={
+                    status === statusToConfirm.status
+                      ? `✅ ${status} (hasil alat)`
+                      : status
+                  }
+                  onPress={() => handleConfirmStatus(status)}
+                  variant={status === statusToConfirm.status ? "primary" : "outline"}
+                />
+              ))}
+              <Button
+                title="Lewati"
+                onPress={() => setStatusToConfirm(null)}
+                variant="outline"
+                style={styles.cancelButton}
+              />
+            </View>
+          )}
+
           <View style={styles.actionsContainer}>
             {canStartSession() ? (
               <>
@@ -773,6 +864,29 @@ const styles = StyleSheet.create({
     color: Colors.white,
     opacity: 0.9,
   },
+  confirmContainer: {
+    backgroundColor: Colors.white,
+    borderRadius: 16,
+    padding: 20,
+    marginBottom: 24,
+    gap: 8,
+    shadowColor: Colors.shadow.color,
+    shadowOffset: { width: 0, height: 4 },
+    shadowOpacity: 0.1,
+    shadowRadius: 8,
+    elevation: 4,
+  },
+  confirmTitle: {
+    fontSize: 18,
+    fontWeight: "600",
+    color: Colors.gray900,
+  },
+  confirmDescription: {
+    fontSize: 14,
+    color: Colors.gray600,
+    marginBottom: 8,
+    lineHeight: 20,
+  },
   actionsContainer: {
     gap: 16,
   },
@@ -0,0 +1,71 @@
+#define ENABLE_MODULE_KNN
+
+#include "Kinematrix.h"
+
+const int SAMPLES = 120;
+const int QUERIES = 200;
+
+KNN runtimeKNN(5, 8, SAMPLES);
+KNNFixed<8, 5, EUCLIDEAN, SAMPLES> fixedKNN;
+
+float queries[QUERIES][8];
+
+const char *makeSample(float features[]) {
+  float weight = random(140, 350) / 10.0;
+  float height = random(1000, 1300) / 10.0;
+  float imt = weight / ((height / 100.0) * (height / 100.0));
+  features[0] = random(5, 8);
+  features[1] = random(0, 12);
+  features[2] = random(0, 2);
+  features[3] = weight;
+  features[4] = height;
+  features[5] = imt;
+  features[6] = random(0, 3);
+  features[7] = random(0, 3);
+  if (imt < 13.0) return "gizi buruk";
+  if (imt < 14.5) return "gizi kurang";
+  if (imt < 18.0) return "gizi baik";
+  if (imt < 21.0) return "overweight";
+  return "obesitas";
+}
+
+template<typename Model>
+float timePredict(Model &model) {
+  uint32_t start = micros();
+  for (int q = 0; q < QUERIES; q++) {
+    KNNResult result;
+    model.predictWithConfidence(queries[q], result);
+  }
+  return (float)(micros() - start) / QUERIES;
+}
+
+void setup() {
+  Serial.begin(115200);
+  randomSeed(42);
+
+  runtimeKNN.setWeightedVoting(true);
+  runtimeKNN.enableNormalization(true);
+  fixedKNN.setWeightedVoting(true);
+  fixedKNN.enableNormalization(true);
+
+  float features[8];
+  for (int i = 0; i < SAMPLES; i++) {
+    const char *label = makeSample(features);
+    runtimeKNN.addTrainingData(label, features);
+    fixedKNN.addTrainingData(label, features);
+  }
+  for (int q = 0; q < QUERIES; q++) {
+    makeSample(queries[q]);
+  }
+
+  float runtimeUs = timePredict(runtimeKNN);
+  runtimeKNN.enableFastSearch(true);
+  float fastUs = timePredict(runtimeKNN);
+  float fixedUs = timePredict(fixedKNN);
+
+  Serial.printf("| KNN: %.1f us | KNN fast search: %.1f us | KNNFixed: %.1f us | per prediction\n",
+                runtimeUs, fastUs, fixedUs);
+}
+
+void loop() {
+}
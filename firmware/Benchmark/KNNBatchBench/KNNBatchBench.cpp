@@ -0,0 +1,96 @@
+/*
+ *  KNNBatchBench.cpp
+ *
+ *  Per-query cost of KNN::predictBatch() against one predictWithConfidence()
+ *  call per query, at batch sizes 1, 8, 64 and 512, on nutrition-shaped
+ *  data (8 features, k=5, weighted, normalized, fast search).
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../host -I../../Libraries KNNBatchBench.cpp ../../Libraries/KNN.cpp -o knn-batch-bench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int QUERY_COUNT = 512;
+
+static double timeSingle(KNN &model, const float *queries, int batch, int repeats) {
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) {
+        for (int q = 0; q < batch; q++) {
+            KNNResult result;
+            model.predictWithConfidence(queries + q * NUTRITION_FEATURES, result);
+            benchKeep(result);
+        }
+    }
+    return timer.elapsedUs() / (repeats * batch);
+}
+
+static double timeBatch(KNN &model, const float *queries, int batch, int repeats,
+                        const char *labels[], float confidences[]) {
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) {
+        model.predictBatch(queries, batch, labels, confidences);
+        benchKeep(labels[0]);
+    }
+    return timer.elapsedUs() / (repeats * batch);
+}
+
+static void runSize(int samples, KNNStorageLayout layout) {
+    BenchRandom rng;
+    float features[NUTRITION_FEATURES];
+
+    KNN model(5, NUTRITION_FEATURES, samples, layout);
+    model.setDistanceMetric(EUCLIDEAN);
+    model.setWeightedVoting(true);
+    model.enableNormalization(true);
+    model.enableFastSearch(true);
+
+    for (int i = 0; i < samples; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.addTrainingData(label, features);
+    }
+
+    auto *queries = new float[QUERY_COUNT * NUTRITION_FEATURES];
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        makeNutritionSample(rng, queries + q * NUTRITION_FEATURES);
+    }
+
+    const char *labels[QUERY_COUNT];
+    float confidences[QUERY_COUNT];
+
+    int agree = 0;
+    model.predictBatch(queries, QUERY_COUNT, labels, confidences);
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        KNNResult result;
+        model.predictWithConfidence(queries + q * NUTRITION_FEATURES, result);
+        if (strcmp(result.label, labels[q]) == 0 && result.confidence == confidences[q]) agree++;
+    }
+
+    const int batches[] = {1, 8, 64, 512};
+    for (int batch: batches) {
+        int repeats = (samples >= 5000 ? 20000 : 400000) / (samples / 100 + 1) / batch + 1;
+        double singleUs = timeSingle(model, queries, batch, repeats);
+        double batchUs = timeBatch(model, queries, batch, repeats, labels, confidences);
+
+        printf("| %6d | batch %3d | single: %8.3f us/query | batch: %8.3f us/query (%.2fx) |\n",
+               samples, batch, singleUs, batchUs, singleUs / batchUs);
+    }
+    printf("  agree with predictWithConfidence: %d/%d\n", agree, QUERY_COUNT);
+
+    delete[] queries;
+}
+
+int main() {
+    const int sizes[] = {100, 1000, 10000};
+
+    printf("KNN batch prediction benchmark, %d features, k=5, euclidean, weighted, normalized\n", NUTRITION_FEATURES);
+    printf("tiles of %d queries against blocks of %d rows\n", KNN_BATCH_TILE, KNN_BATCH_ROWS);
+
+    printf("\nROW_MAJOR\n");
+    for (int samples: sizes) runSize(samples, ROW_MAJOR);
+
+    printf("\nCOLUMN_MAJOR\n");
+    for (int samples: sizes) runSize(samples, COLUMN_MAJOR);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ *  KNNEnsembleBench.cpp
+ *
+ *  Tree-gated KNN against KNN alone with the firmware configuration (k=5,
+ *  euclidean, weighted, normalized, fast search). Each row is scored by
+ *  5-fold cross-validation: both models are trained on four folds and
+ *  classify the fifth. Reports, per tree threshold, how often the tree
+ *  answers alone, accuracy, and mean cost per query. Runs on
+ *  firmware/dataset.csv when its path is given, then on a synthetic set
+ *  of 1k rows.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/KNNEnsembleBench && (cd build && ./KNNEnsembleBench ../../dataset.csv)
+ */
+
+#include "bench-common.h"
+#include "KNNEnsemble.h"
+
+static const int FOLDS = 5;
+static const int MAX_ROWS = 1024;
+static const float THRESHOLDS[] = {0.0f, 0.6f, 0.8f, 0.9f, 1.0f, 1.01f};
+
+struct Score {
+    int correct;
+    int treeOnly;
+    double elapsedUs;
+};
+
+static void runSet(const char *name, float features[][NUTRITION_FEATURES], const char *labels[], int rows) {
+    const int thresholdCount = sizeof(THRESHOLDS) / sizeof(THRESHOLDS[0]);
+    Score scores[thresholdCount] = {};
+    Score knnOnly = {};
+    int treeNodes = 0;
+    int treeDepth = 0;
+
+    for (int fold = 0; fold < FOLDS; fold++) {
+        KNN knn(5, NUTRITION_FEATURES, rows);
+        DecisionTree tree(NUTRITION_FEATURES, rows);
+        knn.setWeightedVoting(true);
+        knn.enableNormalization(true);
+        knn.enableFastSearch(true);
+        for (int i = 0; i < rows; i++) {
+            if (i % FOLDS == fold) continue;
+            knn.addTrainingData(labels[i], features[i]);
+            tree.addTrainingData(labels[i], features[i]);
+        }
+        tree.train(GINI);
+        treeNodes += tree.getNodeCount();
+        treeDepth += tree.getDepth();
+        benchKeep(knn.predict(features[0]));
+
+        BenchTimer timer;
+        for (int i = fold; i < rows; i += FOLDS) {
+            knnOnly.correct += strcmp(knn.predict(features[i]), labels[i]) == 0;
+        }
+        knnOnly.elapsedUs += timer.elapsedUs();
+
+        KNNEnsemble ensemble(knn, tree);
+        for (int t = 0; t < thresholdCount; t++) {
+            ensemble.setTreeThreshold(THRESHOLDS[t]);
+            ensemble.resetStats();
+            timer.reset();
+            for (int i = fold; i < rows; i += FOLDS) {
+                scores[t].correct += strcmp(ensemble.predict(features[i]), labels[i]) == 0;
+            }
+            scores[t].elapsedUs += timer.elapsedUs();
+            scores[t].treeOnly += ensemble.getTreeOnlyCount();
+        }
+    }
+
+    printf("\n%s, %d rows, tree: %.1f nodes, depth %.1f (mean over folds)\n", name, rows,
+           (double) treeNodes / FOLDS, (double) treeDepth / FOLDS);
+    printf("| KNN only            | accuracy %5.1f%% | %8.3f us/query |\n",
+           100.0 * knnOnly.correct / rows, knnOnly.elapsedUs / rows);
+    for (int t = 0; t < thresholdCount; t++) {
+        printf("| tree threshold %.2f | accuracy %5.1f%% | %8.3f us/query | tree only %5.1f%% |\n",
+               THRESHOLDS[t], 100.0 * scores[t].correct / rows, scores[t].elapsedUs / rows,
+               100.0 * scores[t].treeOnly / rows);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    static float features[MAX_ROWS][NUTRITION_FEATURES];
+    static const char *labels[MAX_ROWS];
+
+    printf("KNN ensemble benchmark, %d-fold, k=5, euclidean, weighted, normalized, fast search; "
+           "threshold 0 is tree only, above 1 is KNN only behind the tree\n", FOLDS);
+
+    if (argc > 1) {
+        int rows = loadNutritionDataset(argv[1], features, labels, MAX_ROWS);
+        if (rows == 0) {
+            printf("could not read %s\n", argv[1]);
+        } else {
+            runSet("dataset", features, labels, rows);
+        }
+    }
+
+    BenchRandom rng;
+    for (int i = 0; i < 1000; i++) {
+        labels[i] = makeNutritionSample(rng, features[i]);
+    }
+    runSet("synthetic", features, labels, 1000);
+    return 0;
+}
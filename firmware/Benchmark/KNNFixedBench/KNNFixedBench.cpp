@@ -0,0 +1,81 @@
+/*
+ *  KNNFixedBench.cpp
+ *
+ *  Per-prediction cost of the runtime KNN against KNNFixed<8, 5, Metric>
+ *  on a nutrition-sized model (120 samples, 8 features).
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../host -I../../Libraries KNNFixedBench.cpp ../../Libraries/KNN.cpp -o knn-fixed-bench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int SAMPLES = 120;
+static const int QUERY_COUNT = 500;
+static const int REPEATS = 200;
+
+template<typename Model>
+static double timePredict(Model &model, const float *queries) {
+    BenchTimer timer;
+    for (int r = 0; r < REPEATS; r++) {
+        for (int q = 0; q < QUERY_COUNT; q++) {
+            KNNResult result;
+            model.predictWithConfidence(queries + q * NUTRITION_FEATURES, result);
+            benchKeep(result);
+        }
+    }
+    return timer.elapsedUs() / (REPEATS * QUERY_COUNT);
+}
+
+template<DistanceMetric Metric>
+static void runMetric(const char *name) {
+    BenchRandom rng;
+    float features[NUTRITION_FEATURES];
+
+    KNN runtime(5, NUTRITION_FEATURES, SAMPLES);
+    KNN fast(5, NUTRITION_FEATURES, SAMPLES);
+    static KNNFixed<NUTRITION_FEATURES, 5, Metric, SAMPLES> fixed;
+
+    fast.enableFastSearch(true);
+    for (KNN *model: {&runtime, &fast}) {
+        model->setDistanceMetric(Metric);
+        model->setWeightedVoting(true);
+        model->enableNormalization(true);
+    }
+    fixed.clearTrainingData();
+    fixed.setWeightedVoting(true);
+    fixed.enableNormalization(true);
+
+    for (int i = 0; i < SAMPLES; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        runtime.addTrainingData(label, features);
+        fast.addTrainingData(label, features);
+        fixed.addTrainingData(label, features);
+    }
+
+    auto *queries = new float[QUERY_COUNT * NUTRITION_FEATURES];
+    int agree = 0;
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        float *query = queries + q * NUTRITION_FEATURES;
+        makeNutritionSample(rng, query);
+        if (strcmp(runtime.predict(query), fixed.predict(query)) == 0) agree++;
+    }
+
+    double runtimeUs = timePredict(runtime, queries);
+    double fastUs = timePredict(fast, queries);
+    double fixedUs = timePredict(fixed, queries);
+
+    printf("| %-9s | KNN: %6.3f us | KNN fast search: %6.3f us | KNNFixed: %6.3f us (%.2fx / %.2fx) | agree: %d/%d\n",
+           name, runtimeUs, fastUs, fixedUs, runtimeUs / fixedUs, fastUs / fixedUs, agree, QUERY_COUNT);
+
+    delete[] queries;
+}
+
+int main() {
+    printf("KNNFixed benchmark, %d samples, %d features, k=5, weighted, normalized\n", SAMPLES, NUTRITION_FEATURES);
+    runMetric<EUCLIDEAN>("EUCLIDEAN");
+    runMetric<MANHATTAN>("MANHATTAN");
+    runMetric<COSINE>("COSINE");
+    return 0;
+}
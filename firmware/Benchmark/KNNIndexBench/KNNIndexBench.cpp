@@ -0,0 +1,89 @@
+/*
+ *  KNNIndexBench.cpp
+ *
+ *  Scaling of KNN prediction cost with reference set size: brute-force
+ *  scan, fast search, and fast search with the kd-tree index, on
+ *  nutrition-shaped data (8 features, k=5, weighted, normalized).
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../host -I../../Libraries KNNIndexBench.cpp ../../Libraries/KNN.cpp -o knn-index-bench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int QUERY_COUNT = 500;
+
+static double timePredict(KNN &model, const float *queries, int repeats) {
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) {
+        for (int q = 0; q < QUERY_COUNT; q++) {
+            KNNResult result;
+            model.predictWithConfidence(queries + q * NUTRITION_FEATURES, result);
+            benchKeep(result);
+        }
+    }
+    return timer.elapsedUs() / (repeats * QUERY_COUNT);
+}
+
+static void runSize(int samples, DistanceMetric metric) {
+    BenchRandom rng;
+    float features[NUTRITION_FEATURES];
+
+    KNN brute(5, NUTRITION_FEATURES, samples);
+    KNN fast(5, NUTRITION_FEATURES, samples);
+    KNN indexed(5, NUTRITION_FEATURES, samples);
+
+    fast.enableFastSearch(true);
+    indexed.enableFastSearch(true);
+    indexed.enableIndex(true);
+    for (KNN *model: {&brute, &fast, &indexed}) {
+        model->setDistanceMetric(metric);
+        model->setWeightedVoting(true);
+        model->enableNormalization(true);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        brute.addTrainingData(label, features);
+        fast.addTrainingData(label, features);
+        indexed.addTrainingData(label, features);
+    }
+
+    BenchTimer buildTimer;
+    indexed.buildIndex();
+    double buildUs = buildTimer.elapsedUs();
+
+    auto *queries = new float[QUERY_COUNT * NUTRITION_FEATURES];
+    int agree = 0;
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        float *query = queries + q * NUTRITION_FEATURES;
+        makeNutritionSample(rng, query);
+        if (strcmp(brute.predict(query), indexed.predict(query)) == 0) agree++;
+    }
+
+    int repeats = samples >= 5000 ? 4 : (samples >= 1000 ? 20 : 100);
+    double bruteUs = timePredict(brute, queries, repeats);
+    double fastUs = timePredict(fast, queries, repeats);
+    double indexUs = timePredict(indexed, queries, repeats);
+
+    printf("| %6d | brute: %9.3f us | fast: %9.3f us | index: %8.3f us (%.2fx vs fast) | build: %9.1f us | agree: %d/%d\n",
+           samples, bruteUs, fastUs, indexUs, fastUs / indexUs, buildUs, agree, QUERY_COUNT);
+
+    delete[] queries;
+}
+
+int main() {
+    const int sizes[] = {120, 256, 500, 1000, 2000, 5000, 10000, 20000};
+
+    printf("KNN index benchmark, %d features, k=5, weighted, normalized\n", NUTRITION_FEATURES);
+    printf("index engages from %d samples (Manhattan %d), smaller sets fall back to fast search\n",
+           KNN_INDEX_MIN_DATA, KNN_INDEX_MIN_DATA_MANHATTAN);
+
+    printf("\nEUCLIDEAN\n");
+    for (int samples: sizes) runSize(samples, EUCLIDEAN);
+
+    printf("\nMANHATTAN\n");
+    for (int samples: sizes) runSize(samples, MANHATTAN);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ *  KNNOnlineBench.cpp
+ *
+ *  Cost of the KNN online region on a 1k-row normalized, indexed model:
+ *  learnOnline() while the ring fills and once it evicts (oldest-first
+ *  and class balance), the delta save of a few changed slots against a
+ *  full saveModel(), and the boot-time replay of the journal against
+ *  loading the whole model, all through the host SPIFFS.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/KNNOnlineBench && ./build/KNNOnlineBench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int BASE_ROWS = 1000;
+static const int CAPACITY = 64;
+static const int LEARNED = 2000;
+
+static void fill(KNN &model, BenchRandom &rng) {
+    float features[NUTRITION_FEATURES];
+    for (int i = 0; i < BASE_ROWS; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.addTrainingData(label, features);
+    }
+}
+
+static void configure(KNN &model) {
+    model.setWeightedVoting(true);
+    model.enableNormalization(true);
+    model.enableIndex(true);
+}
+
+static size_t fileSize(const char *path) {
+    File file = SPIFFS.open(path, "r");
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+static void run(const char *name, KNNOnlineEviction eviction) {
+    BenchRandom rng;
+    KNN model(5, NUTRITION_FEATURES, BASE_ROWS);
+    configure(model);
+    fill(model, rng);
+    model.enableOnlineLearning(CAPACITY, eviction);
+
+    float query[NUTRITION_FEATURES];
+    makeNutritionSample(rng, query);
+    benchKeep(model.predict(query));
+
+    float features[NUTRITION_FEATURES];
+    BenchTimer timer;
+    for (int i = 0; i < CAPACITY; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.learnOnline(label, features);
+    }
+    double fillUs = timer.elapsedUs() / CAPACITY;
+
+    timer.reset();
+    for (int i = 0; i < LEARNED; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.learnOnline(label, features);
+    }
+    double evictUs = timer.elapsedUs() / LEARNED;
+
+    timer.reset();
+    for (int i = 0; i < LEARNED; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.learnOnline(label, features);
+        benchKeep(model.predict(query));
+    }
+    double learnPredictUs = timer.elapsedUs() / LEARNED;
+
+    SPIFFS.remove("/knn-online-bench.bin");
+    timer.reset();
+    bool saved = model.saveOnlineSamples("/knn-online-bench.bin");
+    double fullJournalMs = timer.elapsedUs() / 1000.0;
+
+    for (int i = 0; i < 4; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.learnOnline(label, features);
+    }
+    timer.reset();
+    saved = model.saveOnlineSamples("/knn-online-bench.bin") && saved;
+    double deltaMs = timer.elapsedUs() / 1000.0;
+    size_t journalBytes = fileSize("/knn-online-bench.bin");
+
+    timer.reset();
+    saved = model.saveModel("/knn-online-model.bin") && saved;
+    double modelMs = timer.elapsedUs() / 1000.0;
+    size_t modelBytes = fileSize("/knn-online-model.bin");
+
+    BenchRandom baseRng;
+    KNN booted(5, NUTRITION_FEATURES, BASE_ROWS);
+    configure(booted);
+    fill(booted, baseRng);
+    booted.enableOnlineLearning(CAPACITY, eviction);
+    timer.reset();
+    int restored = booted.loadOnlineSamples("/knn-online-bench.bin");
+    double replayMs = timer.elapsedUs() / 1000.0;
+
+    KNN reloaded(5, NUTRITION_FEATURES, BASE_ROWS + CAPACITY);
+    timer.reset();
+    bool loaded = reloaded.loadModel("/knn-online-model.bin");
+    double reloadMs = timer.elapsedUs() / 1000.0;
+
+    int agree = 0;
+    for (int q = 0; q < 256; q++) {
+        makeNutritionSample(rng, query);
+        agree += strcmp(model.predict(query), booted.predict(query)) == 0;
+    }
+
+    SPIFFS.remove("/knn-online-bench.bin");
+    SPIFFS.remove("/knn-online-model.bin");
+
+    printf("| %-13s | learn filling: %7.3f us | learn evicting: %7.3f us | learn+predict: %8.3f us |\n",
+           name, fillUs, evictUs, learnPredictUs);
+    printf("|               | journal: %5zu B, full %.3f ms, 4-slot delta %.3f ms | saveModel: %6zu B, %.3f ms %s |\n",
+           journalBytes, fullJournalMs, deltaMs, modelBytes, modelMs, saved ? "ok" : "FAILED");
+    printf("|               | boot replay: %d rows %.3f ms | loadModel: %.3f ms %s | replay agree: %d/256 |\n",
+           restored, replayMs, reloadMs, loaded ? "ok" : "FAILED", agree);
+}
+
+int main() {
+    SPIFFS.begin(true);
+    printf("KNN online learning benchmark, %d base rows, %d online slots, normalized, indexed\n\n", BASE_ROWS,
+           CAPACITY);
+    run("oldest-first", EVICT_OLDEST);
+    run("class balance", EVICT_CLASS_BALANCE);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ *  KNNPredictBench.cpp
+ *
+ *  End-to-end KNN timings with the firmware configuration (k=5,
+ *  euclidean, weighted, normalized): predict(), predictWithConfidence(),
+ *  crossValidate(5), leaveOneOut() and a saveModel()/loadModel() round
+ *  trip through the host SPIFFS. Runs on firmware/dataset.csv when its
+ *  path is given, then on synthetic sets of 1k and 10k rows.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/KNNPredictBench && (cd build && ./KNNPredictBench ../../dataset.csv)
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int QUERY_COUNT = 256;
+static const int MAX_DATASET_ROWS = 1024;
+
+static void configure(KNN &model) {
+    model.setDistanceMetric(EUCLIDEAN);
+    model.setWeightedVoting(true);
+    model.enableNormalization(true);
+    model.enableFastSearch(true);
+}
+
+static void runModel(const char *name, KNN &model, const float *queries) {
+    int rows = model.getDataCount();
+    int repeats = 200000 / (rows / 10 + 1) + 1;
+
+    for (int q = 0; q < QUERY_COUNT; q++) benchKeep(model.predict(queries + q * NUTRITION_FEATURES));
+
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) {
+        benchKeep(model.predict(queries + (r % QUERY_COUNT) * NUTRITION_FEATURES));
+    }
+    double predictUs = timer.elapsedUs() / repeats;
+
+    timer.reset();
+    for (int r = 0; r < repeats; r++) {
+        KNNResult result;
+        model.predictWithConfidence(queries + (r % QUERY_COUNT) * NUTRITION_FEATURES, result);
+        benchKeep(result);
+    }
+    double confidenceUs = timer.elapsedUs() / repeats;
+
+    timer.reset();
+    float foldAccuracy = model.crossValidate(5);
+    double crossValidateMs = timer.elapsedUs() / 1000.0;
+
+    double looMs = -1;
+    float looAccuracy = -1;
+    if (rows <= 2000) {
+        timer.reset();
+        looAccuracy = model.leaveOneOut();
+        looMs = timer.elapsedUs() / 1000.0;
+    }
+
+    timer.reset();
+    bool saved = model.saveModel("/knn-bench.bin");
+    double saveMs = timer.elapsedUs() / 1000.0;
+
+    KNN loaded(5, NUTRITION_FEATURES, rows);
+    timer.reset();
+    bool restored = loaded.loadModel("/knn-bench.bin");
+    double loadMs = timer.elapsedUs() / 1000.0;
+    SPIFFS.remove("/knn-bench.bin");
+
+    int agree = 0;
+    configure(loaded);
+    for (int q = 0; q < QUERY_COUNT && restored; q++) {
+        const float *query = queries + q * NUTRITION_FEATURES;
+        agree += strcmp(model.predict(query), loaded.predict(query)) == 0;
+    }
+
+    printf("| %-9s | %5d rows | predict: %8.3f us | with confidence: %8.3f us |\n",
+           name, rows, predictUs, confidenceUs);
+    printf("|           |           | crossValidate(5): %9.3f ms (%.3f) |", crossValidateMs, foldAccuracy);
+    if (looMs >= 0) printf(" leaveOneOut: %9.3f ms (%.3f) |", looMs, looAccuracy);
+    printf("\n|           |           | save: %7.3f ms %s | load: %7.3f ms %s | reloaded agree: %d/%d |\n",
+           saveMs, saved ? "ok" : "FAILED", loadMs, restored ? "ok" : "FAILED", agree, QUERY_COUNT);
+}
+
+static void runSynthetic(int samples, const float *queries) {
+    BenchRandom rng(0x5EED0000u + samples);
+    float features[NUTRITION_FEATURES];
+
+    KNN model(5, NUTRITION_FEATURES, samples);
+    configure(model);
+    for (int i = 0; i < samples; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.addTrainingData(label, features);
+    }
+    runModel("synthetic", model, queries);
+}
+
+int main(int argc, char *argv[]) {
+    SPIFFS.begin(true);
+
+    BenchRandom rng;
+    auto *queries = new float[QUERY_COUNT * NUTRITION_FEATURES];
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        makeNutritionSample(rng, queries + q * NUTRITION_FEATURES);
+    }
+
+    printf("KNN predict benchmark, %d features, k=5, euclidean, weighted, normalized, fast search\n",
+           NUTRITION_FEATURES);
+
+    if (argc > 1) {
+        static float features[MAX_DATASET_ROWS][NUTRITION_FEATURES];
+        static const char *labels[MAX_DATASET_ROWS];
+        int rows = loadNutritionDataset(argv[1], features, labels, MAX_DATASET_ROWS);
+        if (rows == 0) {
+            printf("could not read %s\n", argv[1]);
+        } else {
+            KNN model(5, NUTRITION_FEATURES, rows);
+            configure(model);
+            for (int i = 0; i < rows; i++) model.addTrainingData(labels[i], features[i]);
+            runModel("dataset", model, queries);
+        }
+    }
+
+    runSynthetic(1000, queries);
+    runSynthetic(10000, queries);
+
+    delete[] queries;
+    return 0;
+}
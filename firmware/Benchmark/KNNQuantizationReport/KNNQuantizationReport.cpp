@@ -0,0 +1,83 @@
+/*
+ *  KNNQuantizationReport.cpp
+ *
+ *  Accuracy versus footprint of float32, int16 and int8 KNN stores.
+ *  Accuracy is the mean of crossValidate(5) over several shuffles, run on
+ *  firmware/dataset.csv and on a synthetic 2k sample set.
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../host -I../../Libraries KNNQuantizationReport.cpp ../../Libraries/KNN.cpp -o knn-quantization-report
+ *  Run:
+ *    ./knn-quantization-report ../../dataset.csv
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int MAX_ROWS = 2000;
+static const int SHUFFLES = 10;
+static const int QUERY_COUNT = 500;
+
+static float features[MAX_ROWS][NUTRITION_FEATURES];
+static const char *labels[MAX_ROWS];
+
+static void report(const char *name, int rows) {
+    const KNNPrecision precisions[] = {PRECISION_FLOAT32, PRECISION_INT16, PRECISION_INT8};
+    const char *precisionNames[] = {"float32", "int16", "int8"};
+    size_t floatStoreBytes = 0;
+
+    printf("%s, %d samples\n", name, rows);
+
+    for (int p = 0; p < 3; p++) {
+        KNN model(5, NUTRITION_FEATURES, rows);
+        model.setDistanceMetric(EUCLIDEAN);
+        model.setWeightedVoting(true);
+        model.enableNormalization(true);
+
+        for (int i = 0; i < rows; i++) {
+            model.addTrainingData(labels[i], features[i]);
+        }
+        if (precisions[p] != PRECISION_FLOAT32) model.quantize(precisions[p]);
+
+        float accuracy = 0.0f;
+        for (int s = 0; s < SHUFFLES; s++) {
+            randomSeed(1000 + s);
+            accuracy += model.crossValidate(5);
+        }
+        accuracy /= SHUFFLES;
+
+        BenchTimer timer;
+        for (int q = 0; q < QUERY_COUNT; q++) {
+            const char *label = model.predict(features[q % rows]);
+            benchKeep(label);
+        }
+        double predictUs = timer.elapsedUs() / QUERY_COUNT;
+
+        size_t storeBytes = (size_t) rows * NUTRITION_FEATURES *
+                            (precisions[p] == PRECISION_INT8 ? 1 : precisions[p] == PRECISION_INT16 ? 2 : 4);
+        if (p == 0) floatStoreBytes = storeBytes;
+
+        printf("| %-7s | cv accuracy: %6.2f%% | store: %6zu B (%4.1f B/sample) | model: %6zu B "
+               "| samples in float32 RAM: %5d | predict: %6.2f us\n",
+               precisionNames[p], accuracy * 100.0f, storeBytes, (float) storeBytes / rows, model.getMemoryUsage(),
+               (int) (floatStoreBytes / (storeBytes / rows)), predictUs);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = (argc > 1) ? argv[1] : "../../dataset.csv";
+
+    int rows = loadNutritionDataset(path, features, labels, MAX_ROWS);
+    if (rows > 0) {
+        report(path, rows);
+    } else {
+        printf("could not read %s, skipping the dataset report\n", path);
+    }
+
+    BenchRandom rng;
+    for (int i = 0; i < MAX_ROWS; i++) {
+        labels[i] = makeNutritionSample(rng, features[i]);
+    }
+    report("synthetic", MAX_ROWS);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ *  KNNRemoveBench.cpp
+ *
+ *  Cost of KNN::removeTrainingData() followed by the next prediction, with
+ *  the swap-remove and counted extremes against the eager full range
+ *  rescan removals used to trigger (calculateFeatureRanges() after every
+ *  removal), at 1k and 10k rows, normalized with fast search.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/KNNRemoveBench && ./build/KNNRemoveBench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+static const int REMOVALS = 500;
+
+static void fill(KNN &model, int samples, BenchRandom &rng) {
+    float features[NUTRITION_FEATURES];
+    for (int i = 0; i < samples; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        model.addTrainingData(label, features);
+    }
+}
+
+static double timeRemovals(int samples, KNNStorageLayout layout, bool eagerRescan, bool predict) {
+    BenchRandom rng;
+    KNN model(5, NUTRITION_FEATURES, samples, layout);
+    model.enableNormalization(true);
+    model.enableFastSearch(true);
+    fill(model, samples, rng);
+
+    float query[NUTRITION_FEATURES];
+    makeNutritionSample(rng, query);
+    benchKeep(model.predict(query));
+
+    BenchTimer timer;
+    for (int r = 0; r < REMOVALS; r++) {
+        model.removeTrainingData(rng.range(0, model.getDataCount() - 1));
+        if (eagerRescan) model.calculateFeatureRanges();
+        if (predict) benchKeep(model.predict(query));
+    }
+    return timer.elapsedUs() / REMOVALS;
+}
+
+int main() {
+    const int sizes[] = {1000, 10000};
+    const KNNStorageLayout layouts[] = {ROW_MAJOR, COLUMN_MAJOR};
+
+    printf("KNN removal benchmark, %d random removals, normalized, fast search\n", REMOVALS);
+    for (KNNStorageLayout layout: layouts) {
+        printf("\n%s\n", layout == ROW_MAJOR ? "ROW_MAJOR" : "COLUMN_MAJOR");
+        for (int samples: sizes) {
+            double removeUs = timeRemovals(samples, layout, false, false);
+            double lazyUs = timeRemovals(samples, layout, false, true);
+            double eagerUs = timeRemovals(samples, layout, true, true);
+            printf("| %5d rows | remove: %8.3f us | remove+predict: %9.3f us | eager rescan+predict: %9.3f us "
+                   "(%.1fx) |\n", samples, removeUs, lazyUs, eagerUs, eagerUs / lazyUs);
+        }
+    }
+    return 0;
+}
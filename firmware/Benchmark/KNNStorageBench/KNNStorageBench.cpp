@@ -0,0 +1,205 @@
+/*
+ *  KNNStorageBench.cpp
+ *
+ *  Compares the old pointer-per-row KNN store with the contiguous
+ *  row-major and column-major stores at 120, 1k and 10k samples.
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../host -I../../Libraries KNNStorageBench.cpp ../../Libraries/KNN.cpp -o knn-storage-bench
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+
+/*
+ * Faithful copy of the store KNN used before the contiguous block:
+ * one heap row per sample, one 20 byte label buffer per sample and a
+ * full qsort per prediction.
+ */
+class LegacyKNN {
+private:
+    struct DistanceIndex {
+        float distance;
+        int index;
+    };
+
+    int k;
+    int maxFeatures;
+    int maxData;
+    int currentDataSize;
+    float **trainingData;
+    char **trainingLabels;
+    float *featureMin;
+    float *featureMax;
+    DistanceIndex *distanceBuffer;
+    DistanceMetric metric;
+    bool normalizationEnabled;
+
+    static int compareDistances(const void *a, const void *b) {
+        const auto *da = (const DistanceIndex *) a;
+        const auto *db = (const DistanceIndex *) b;
+        if (da->distance < db->distance) return -1;
+        if (da->distance > db->distance) return 1;
+        return 0;
+    }
+
+    float normalizeFeature(float value, int featureIndex) const {
+        if (!normalizationEnabled || featureMin == nullptr || featureMax == nullptr) return value;
+        if (featureIndex < 0 || featureIndex >= maxFeatures) return value;
+
+        float min = featureMin[featureIndex];
+        float max = featureMax[featureIndex];
+        if (max - min < 0.0001f) return 0.5f;
+        return (value - min) / (max - min);
+    }
+
+public:
+    int allocations;
+
+    LegacyKNN(int k, int maxFeatures, int maxData)
+            : k(k), maxFeatures(maxFeatures), maxData(maxData), currentDataSize(0),
+              metric(EUCLIDEAN), normalizationEnabled(true), allocations(0) {
+        trainingData = new float *[maxData];
+        trainingLabels = new char *[maxData];
+        allocations += 2;
+        for (int i = 0; i < maxData; i++) {
+            trainingData[i] = new float[maxFeatures];
+            trainingLabels[i] = new char[20];
+            allocations += 2;
+        }
+        featureMin = new float[maxFeatures];
+        featureMax = new float[maxFeatures];
+        distanceBuffer = new DistanceIndex[maxData];
+        allocations += 4;
+    }
+
+    ~LegacyKNN() {
+        for (int i = 0; i < maxData; i++) {
+            delete[] trainingData[i];
+            delete[] trainingLabels[i];
+        }
+        delete[] trainingData;
+        delete[] trainingLabels;
+        delete[] featureMin;
+        delete[] featureMax;
+        delete[] distanceBuffer;
+    }
+
+    void addTrainingData(const char *label, const float features[]) {
+        for (int i = 0; i < maxFeatures; i++) {
+            trainingData[currentDataSize][i] = features[i];
+            if (currentDataSize == 0 || features[i] < featureMin[i]) featureMin[i] = features[i];
+            if (currentDataSize == 0 || features[i] > featureMax[i]) featureMax[i] = features[i];
+        }
+        strncpy(trainingLabels[currentDataSize], label, 19);
+        trainingLabels[currentDataSize][19] = '\0';
+        currentDataSize++;
+    }
+
+    float calculateEuclideanDistance(const float dataPoint[], const float trainDataPoint[]) const {
+        float sum = 0.0f;
+        for (int i = 0; i < maxFeatures; i++) {
+            float a = dataPoint[i];
+            float b = trainDataPoint[i];
+            if (normalizationEnabled) {
+                a = normalizeFeature(a, i);
+                b = normalizeFeature(b, i);
+            }
+            float diff = a - b;
+            sum += diff * diff;
+        }
+        return sqrt(sum);
+    }
+
+    float calculateDistance(const float dataPoint[], const float trainDataPoint[]) const {
+        switch (metric) {
+            case EUCLIDEAN:
+            default:
+                return calculateEuclideanDistance(dataPoint, trainDataPoint);
+        }
+    }
+
+    const char *predict(const float dataPoint[]) {
+        for (int i = 0; i < currentDataSize; i++) {
+            distanceBuffer[i].distance = calculateDistance(dataPoint, trainingData[i]);
+            distanceBuffer[i].index = i;
+        }
+
+        qsort(distanceBuffer, currentDataSize, sizeof(DistanceIndex), compareDistances);
+
+        auto *weights = new float[currentDataSize];
+        int maxVotedIndex = distanceBuffer[0].index;
+        for (int i = 0; i < currentDataSize; i++) weights[i] = 0.0f;
+        for (int i = 0; i < k && i < currentDataSize; i++) {
+            int idx = distanceBuffer[i].index;
+            weights[idx] += 1.0f / (distanceBuffer[i].distance + 0.0001f);
+            if (weights[idx] > weights[maxVotedIndex]) maxVotedIndex = idx;
+        }
+        delete[] weights;
+
+        return trainingLabels[maxVotedIndex];
+    }
+};
+
+static const int QUERY_COUNT = 200;
+
+template<typename Model>
+static double timePredict(Model &model, const float *queries, int repeats) {
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) {
+        for (int q = 0; q < QUERY_COUNT; q++) {
+            const char *label = model.predict(queries + q * NUTRITION_FEATURES);
+            benchKeep(label);
+        }
+    }
+    return timer.elapsedUs() / (repeats * QUERY_COUNT);
+}
+
+static void runSize(int samples) {
+    BenchRandom rng;
+    float features[NUTRITION_FEATURES];
+
+    LegacyKNN legacy(5, NUTRITION_FEATURES, samples);
+    KNN rowMajor(5, NUTRITION_FEATURES, samples, ROW_MAJOR);
+    KNN columnMajor(5, NUTRITION_FEATURES, samples, COLUMN_MAJOR);
+
+    KNN *models[] = {&rowMajor, &columnMajor};
+    for (KNN *model: models) {
+        model->setDistanceMetric(EUCLIDEAN);
+        model->setWeightedVoting(true);
+        model->enableNormalization(true);
+    }
+
+    for (int i = 0; i < samples; i++) {
+        const char *label = makeNutritionSample(rng, features);
+        legacy.addTrainingData(label, features);
+        rowMajor.addTrainingData(label, features);
+        columnMajor.addTrainingData(label, features);
+    }
+
+    auto *queries = new float[QUERY_COUNT * NUTRITION_FEATURES];
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        makeNutritionSample(rng, queries + q * NUTRITION_FEATURES);
+    }
+
+    int repeats = samples >= 10000 ? 2 : (samples >= 1000 ? 10 : 100);
+
+    double legacyUs = timePredict(legacy, queries, repeats);
+    double rowUs = timePredict(rowMajor, queries, repeats);
+    double columnUs = timePredict(columnMajor, queries, repeats);
+
+    printf("| samples: %6d | legacy: %9.2f us | row-major: %9.2f us (%.2fx) | column-major: %9.2f us (%.2fx) "
+           "| heap blocks legacy: %6d contiguous: 6\n",
+           samples, legacyUs, rowUs, legacyUs / rowUs, columnUs, legacyUs / columnUs, legacy.allocations);
+
+    delete[] queries;
+}
+
+int main() {
+    printf("KNN storage layout benchmark, %d features, k=5, weighted, normalized\n", NUTRITION_FEATURES);
+    const int sizes[] = {120, 1000, 10000};
+    for (int samples: sizes) {
+        runSize(samples);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ *  SH1106RenderBench.cpp
+ *
+ *  Per-frame cost of the SH1106Menu renderers on the host framebuffer:
+ *  the screens IntanFirmwareR1 draws (renderBoxedText, renderStatusScreen,
+ *  showCircleLoading, showMenu) first, then a spread of the other render*
+ *  helpers. The I2C transfer is not modelled, so this is the CPU half of a
+ *  frame only. Time warp is on because some renderers call delay().
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/SH1106RenderBench && ./build/SH1106RenderBench
+ */
+
+#include "bench-common.h"
+#include "sh1106-menu.h"
+
+static SH1106Menu menu(0x3C, 21, 22);
+
+static uint32_t frameChecksum() {
+    uint32_t hash = 2166136261u;
+    const uint8_t *buffer = menu.getBuffer();
+    for (size_t i = 0; i < menu.getBufferSize(); i++) hash = (hash ^ buffer[i]) * 16777619u;
+    return hash;
+}
+
+template<typename Render>
+static void timeFrame(const char *name, Render render) {
+    const int repeats = 20000;
+    uint32_t framesBefore = menu.getFrameCount();
+
+    BenchTimer timer;
+    for (int r = 0; r < repeats; r++) render(r);
+    double frameUs = timer.elapsedUs() / repeats;
+
+    uint32_t frames = menu.getFrameCount() - framesBefore;
+    printf("| %-22s | %8.3f us/call | %5.2f frames/call | checksum %08x |\n",
+           name, frameUs, (double) frames / repeats, frameChecksum());
+}
+
+int main() {
+    hostSetTimeWarp(true);
+    menu.initialize();
+
+    printf("SH1106Menu render benchmark, %dx%d framebuffer\n", menu.width(), menu.height());
+
+    printf("\nfirmware screens\n");
+    const char *startupLines[] = {"SISTEM DIMULAI", "MOHON TUNGGU...", "KONEKSI KE WIFI"};
+    timeFrame("renderBoxedText x3", [&](int) { menu.renderBoxedText(startupLines, 3); });
+
+    const char *weightLines[] = {"MENGUKUR BERAT", "BERAT: 18.45 KG", "KONFIRMASI DI", "APLIKASI ANDA"};
+    timeFrame("renderBoxedText x4", [&](int) { menu.renderBoxedText(weightLines, 4); });
+
+    timeFrame("renderStatusScreen", [](int) { menu.renderStatusScreen("KALIBRASI", "BERHASIL", true); });
+    timeFrame("showCircleLoading", [](int r) { menu.showCircleLoading("MEMUAT", r); });
+
+    MenuCursor cursor = {false, false, false, false, true};
+    menu.onListen(&cursor, []() {});
+    MenuProperties *mainMenu = menu.createMenu(5, "Timbang", "Ukur Cepat", "Pairing RFID", "Kalibrasi", "Admin");
+    timeFrame("showMenu (forced)", [&](int) { menu.showMenu(mainMenu, true); });
+    menu.freeMenu(mainMenu);
+
+    printf("\nother renderers\n");
+    timeFrame("renderInfoScreen", [](int) {
+        menu.renderInfoScreen("INFO", "Berat 18.4 kg", "Tinggi 112 cm", "Gizi baik");
+    });
+    timeFrame("renderMetricScreen", [](int) { menu.renderMetricScreen("BERAT", "18.45", "kg", "stabil"); });
+    timeFrame("renderBatteryStatus", [](int r) { menu.renderBatteryStatus(r % 101, false); });
+    timeFrame("renderClock analog", [](int r) { menu.renderClock(10, r % 60, r % 60, true); });
+    timeFrame("renderPercentageCircle", [](int r) { menu.renderPercentageCircle(r % 101, "PROSES"); });
+
+    int values[32];
+    for (int i = 0; i < 32; i++) values[i] = (i * 37) % 100;
+    timeFrame("renderSensorGraph", [&](int) { menu.renderSensorGraph("BERAT", values, 32, 0, 100, false); });
+    timeFrame("renderGauge", [](int r) { menu.renderGauge("TINGGI", r % 200, 0, 200); });
+    timeFrame("renderHistogram", [&](int) { menu.renderHistogram("SESI", values, 16, 100); });
+
+    const char *options[] = {"Timbang", "Ukur Cepat", "Pairing RFID", "Kalibrasi", "Admin"};
+    timeFrame("renderListMenu", [&](int r) { menu.renderListMenu("MENU", options, 5, r % 5, 0); });
+    timeFrame("renderGridMenu", [&](int r) { menu.renderGridMenu(options, 5, 3, r % 5); });
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ *  SensorPipelineBench.cpp
+ *
+ *  HX711Sens stability locking with the lastWeights window against a
+ *  SensorPipeline chain, on simulated weighings of a child who fidgets.
+ *  Each trial is empty for 1 s, steps on over 1 s, sways and shifts for
+ *  5 s with occasional knocks, then stands still for 8 s. A lock taken
+ *  while the child still moves, or more than 0.2 kg off, is a false lock;
+ *  time to lock is counted from when the child stands still. Also reports
+ *  the cost of one reading through update() for each chain.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/SensorPipelineBench && ./build/SensorPipelineBench
+ */
+
+#include "bench-common.h"
+#include "hx711-sens.h"
+
+#include <cmath>
+
+static const int TRIALS = 200;
+static const float COUNTS_PER_GRAM = 22.5f;
+static const float STILL_FROM_S = 7.0f;
+static const float TRIAL_END_S = 15.0f;
+static const float LOCK_ERROR_KG = 0.2f;
+
+struct Chain {
+    const char *name;
+    float tolerance;
+    uint32_t stabilityTime;
+    void (*declare)(SensorPipeline &pipeline, int samplesPerSecond);
+};
+
+/*
+ * The first row is the firmware's old configuration, the second the chain
+ * IntanFirmwareR1 declares. Stability windows are one second of readings,
+ * clamped to SENSOR_PIPELINE_MAX_STABILITY.
+ */
+static const Chain CHAINS[] = {
+        {"lastWeights window, 0.25 kg, 2 s", 0.25f, 2000, nullptr},
+        {"hampel > stability > ema, 0.06 kg, 1 s", 0.06f, 1000, [](SensorPipeline &pipeline, int sps) {
+            pipeline.hampel(7, 3.0f).stability(sps).ema(3.0f / sps);
+        }},
+        {"hampel > stability, 0.06 kg, 1 s", 0.06f, 1000, [](SensorPipeline &pipeline, int sps) {
+            pipeline.hampel(7, 3.0f).stability(sps);
+        }},
+        {"median > hampel > stability, 0.06 kg, 1 s", 0.06f, 1000, [](SensorPipeline &pipeline, int sps) {
+            pipeline.median(5).hampel(7, 3.0f).stability(sps);
+        }},
+};
+
+/*
+ * One trial's motion. While fidgeting the child shifts between stances,
+ * each held 0.4 to 1.6 s with its own offset (leaning on a parent, a foot
+ * half off) and sway.
+ */
+struct Child {
+    float weight;
+    float swayHz;
+    float stanceEnd;
+    float stanceOffset;
+    float stanceSway;
+};
+
+/*true weight plus stance, jitter and knocks for time t of one trial*/
+static float childWeight(BenchRandom &rng, Child &child, float t) {
+    float kg;
+    if (t < 1.0f) {
+        kg = 0.0f;
+    } else if (t < 2.0f) {
+        kg = child.weight * (t - 1.0f);
+    } else if (t < STILL_FROM_S) {
+        if (t >= child.stanceEnd) {
+            child.stanceEnd = t + rng.uniform(0.4f, 1.6f);
+            child.stanceOffset = rng.uniform(-1.5f, 0.3f);
+            child.stanceSway = rng.uniform(0.05f, 0.4f);
+        }
+        kg = child.weight + child.stanceOffset + child.stanceSway * sinf(2.0f * (float) M_PI * child.swayHz * t);
+    } else {
+        kg = child.weight;
+    }
+
+    kg += rng.uniform(-0.05f, 0.05f);
+    float knockChance = t < STILL_FROM_S ? 0.03f : 0.01f;
+    if (t >= 2.0f && rng.uniform(0.0f, 1.0f) < knockChance) kg += rng.uniform(-3.0f, 3.0f);
+    return kg;
+}
+
+struct Outcome {
+    int locked;
+    int falseLocks;
+    double lockDelayS;
+    double lockErrorKg;
+    double cpuUs;
+    int readings;
+};
+
+static Outcome runChain(const Chain &chain, int samplesPerSecond) {
+    Outcome outcome = {};
+    BenchRandom rng(0x5EED0000u + (uint32_t) samplesPerSecond);
+    unsigned long stepUs = 1000000UL / samplesPerSecond;
+
+    for (int trial = 0; trial < TRIALS; trial++) {
+        HX711Sens loadCell(26, 25, HX711Sens::KG, chain.tolerance, 5, chain.stabilityTime, 0.25);
+        loadCell.init();
+        loadCell.setScale(COUNTS_PER_GRAM);
+        if (chain.declare != nullptr) chain.declare(loadCell.pipeline(), samplesPerSecond);
+        loadCell.beginSampling();
+
+        Child child = {rng.uniform(14.0f, 30.0f), rng.uniform(0.6f, 1.5f), 0.0f, 0.0f, 0.0f};
+        float lockedAt = -1.0f;
+
+        for (float t = 0.0f; t < TRIAL_END_S; t += 1.0f / samplesPerSecond) {
+            hostAdvanceMicros(stepUs);
+            float kg = childWeight(rng, child, t);
+            loadCell.hostSetRaw((long) (kg * 1000.0f * COUNTS_PER_GRAM));
+            loadCell.captureSample();
+
+            BenchTimer timer;
+            loadCell.update();
+            outcome.cpuUs += timer.elapsedUs();
+            outcome.readings++;
+
+            if (lockedAt < 0.0f && loadCell.isValueLocked()) lockedAt = t;
+        }
+
+        if (lockedAt < 0.0f) continue;
+        float error = fabsf(loadCell.getLockedValue() - child.weight);
+        outcome.locked++;
+        if (lockedAt < STILL_FROM_S || error > LOCK_ERROR_KG) {
+            outcome.falseLocks++;
+        } else {
+            outcome.lockDelayS += lockedAt - STILL_FROM_S;
+            outcome.lockErrorKg += error;
+        }
+    }
+    return outcome;
+}
+
+int main() {
+    hostSetTimeWarp(true);
+    Serial.setOutput(nullptr);
+
+    printf("stability locking on fidgeting weighings, %d trials per row\n", TRIALS);
+    for (int samplesPerSecond : {10, 80}) {
+        printf("\n%d SPS\n", samplesPerSecond);
+        for (const Chain &chain : CHAINS) {
+            Outcome outcome = runChain(chain, samplesPerSecond);
+            int goodLocks = outcome.locked - outcome.falseLocks;
+            printf("| %-42s | locked %3d | false %3d | to lock %5.2f s | error %.3f kg | %6.3f us/reading |\n",
+                   chain.name, outcome.locked, outcome.falseLocks,
+                   goodLocks > 0 ? outcome.lockDelayS / goodLocks : 0.0,
+                   goodLocks > 0 ? outcome.lockErrorKg / goodLocks : 0.0,
+                   outcome.cpuUs / outcome.readings);
+        }
+    }
+    return 0;
+}
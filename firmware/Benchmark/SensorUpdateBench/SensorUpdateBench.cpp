@@ -0,0 +1,185 @@
+/*
+ *  SensorUpdateBench.cpp
+ *
+ *  Cost of the sensor update paths IntanFirmwareR1 runs every loop:
+ *  HX711Sens::update() and UltrasonicSens::update() when their interval
+ *  is due and when it is not, HX711Sens draining the ring its sampling
+ *  task fills, UltrasonicSens with the echo timed by interrupts, SensorModule::update() with the firmware's
+ *  callback, and the value and module reads: typed handles from the
+ *  registry and module handles against the by-name lookups they replace. The RFID module needs a real SPI
+ *  bus and is left out.
+ *
+ *  Time warp is on, so the "cpu" column is host time spent in the code and
+ *  the "blocked" column is the bus time the drivers would spend waiting on
+ *  the device (HX711 bit-banging, ultrasonic echo) per call.
+ *
+ *  Build and run (from firmware/Benchmark):
+ *    make build/SensorUpdateBench && ./build/SensorUpdateBench
+ */
+
+#include "bench-common.h"
+#include "hx711-sens.h"
+#include "ultrasonic-sens.h"
+
+static const int REPEATS = 200000;
+
+static SensorModule sensorManager;
+static volatile float currentWeight = 0;
+static volatile float currentHeight = 0;
+static const SensorValue *weightValue = nullptr;
+static const SensorValue *heightValue = nullptr;
+static SensorHandle loadCellSensor = SENSOR_HANDLE_NONE;
+
+/*
+ * What the sampling task does on a DOUT edge. It runs on the other core,
+ * so its bus time is taken back off the loop's clock.
+ */
+static void captureOnTask(HX711Sens *loadCell) {
+    unsigned long long offsetBefore = hostClock.offsetUs;
+    loadCell->captureSample();
+    hostClock.offsetUs = offsetBefore;
+}
+
+/*
+ * The echo pin interrupt's view of a pulse for distanceCm, reported with
+ * the sensor's ~450 us lead-in after the trigger.
+ */
+static void echoByInterrupt(UltrasonicSens *ultrasonic, float distanceCm) {
+    uint32_t riseUs = micros() + 450;
+    ultrasonic->echoEdge(true, riseUs);
+    ultrasonic->echoEdge(false, riseUs + (uint32_t) (distanceCm * US_ROUNDTRIP_CM));
+}
+
+/*
+ * Runs update() REPEATS times, stepping the clock by stepUs before each
+ * call. Returns host us per call and reports modelled blocking time.
+ */
+template<typename Update>
+static void timeUpdate(const char *name, unsigned long stepUs, Update update) {
+    unsigned long long offsetBefore = hostClock.offsetUs;
+    int updated = 0;
+
+    BenchTimer timer;
+    for (int r = 0; r < REPEATS; r++) {
+        hostAdvanceMicros(stepUs);
+        updated += update(r) ? 1 : 0;
+    }
+    double cpuUs = timer.elapsedUs() / REPEATS;
+
+    double blockedUs = (double) (hostClock.offsetUs - offsetBefore - (unsigned long long) stepUs * REPEATS) / REPEATS;
+    printf("| %-36s | cpu: %8.3f us/call | blocked: %9.3f us/call | updated %6d/%d |\n",
+           name, cpuUs, blockedUs, updated, REPEATS);
+}
+
+int main() {
+    hostSetTimeWarp(true);
+    Serial.setOutput(nullptr);
+
+    auto *ultrasonic = new UltrasonicSens(32, 33, 200, 1, 1, 1000, 10);
+    auto *loadCell = new HX711Sens(26, 25, HX711Sens::KG, 0.25, 5, 2000, 0.25);
+    sensorManager.reserve(2);
+    SensorHandle ultrasonicSensor = sensorManager.addModule("ultrasonic", ultrasonic);
+    loadCellSensor = sensorManager.addModule("loadcell", loadCell);
+    weightValue = sensorManager.getValueHandle(loadCellSensor);
+    heightValue = sensorManager.getValueHandle(ultrasonicSensor);
+    sensorManager.init();
+
+    auto *sampledLoadCell = new HX711Sens(26, 25, HX711Sens::KG, 0.25, 5, 2000, 0.25);
+    sampledLoadCell->init();
+    sampledLoadCell->setScale(22.5f);
+    sampledLoadCell->hostSetRaw(415000, 40);
+    sampledLoadCell->beginSampling();
+
+    auto *capturedUltrasonic = new UltrasonicSens(32, 33, 200, 1, 1, 1000, 10);
+    capturedUltrasonic->init();
+    capturedUltrasonic->beginEchoCapture();
+
+    loadCell->setScale(22.5f);
+    loadCell->hostSetRaw(415000, 40);
+    ultrasonic->hostSetDistance(88.0f);
+    Serial.setOutput(stdout);
+
+    printf("sensor update benchmark, %d calls per row\n", REPEATS);
+
+    printf("\ndrivers\n");
+    timeUpdate("HX711Sens::update() due", 500000, [&](int) { return loadCell->update(); });
+    timeUpdate("HX711Sens::update() not due", 10, [&](int) { return loadCell->update(); });
+    timeUpdate("UltrasonicSens::update() due", 50000, [&](int) { return ultrasonic->update(); });
+    timeUpdate("UltrasonicSens::update() not due", 10, [&](int) { return ultrasonic->update(); });
+
+    printf("\nHX711Sens sampling task, 1 ms loop\n");
+    timeUpdate("update() draining 80 SPS", 1000, [&](int r) {
+        if (r % 12 == 0) captureOnTask(sampledLoadCell);
+        return sampledLoadCell->update();
+    });
+    timeUpdate("update() draining 10 SPS", 1000, [&](int r) {
+        if (r % 100 == 0) captureOnTask(sampledLoadCell);
+        return sampledLoadCell->update();
+    });
+    printf("sampled weight %.3f kg, %u samples dropped\n",
+           (double) sampledLoadCell->getValueWeight(), (unsigned) sampledLoadCell->getDroppedSamples());
+
+    printf("\nUltrasonicSens echo capture\n");
+    timeUpdate("update() due, trigger only", 50000, [&](int) {
+        bool updated = capturedUltrasonic->update();
+        echoByInterrupt(capturedUltrasonic, 88.0f);
+        return updated;
+    });
+    timeUpdate("update() not due", 10, [&](int) { return capturedUltrasonic->update(); });
+    printf("captured height %.1f cm\n", (double) capturedUltrasonic->getValueCm());
+
+    printf("\nSensorModule\n");
+    timeUpdate("update(callback), 1 ms loop, by name", 1000, [](int) {
+        sensorManager.update([]() {
+            currentWeight = sensorManager["loadcell"];
+            currentHeight = sensorManager["ultrasonic"];
+        });
+        return true;
+    });
+    timeUpdate("update(callback), 1 ms loop, handles", 1000, [](int) {
+        sensorManager.update([]() {
+            currentWeight = weightValue->getFloat();
+            currentHeight = heightValue->getFloat();
+        });
+        return true;
+    });
+    timeUpdate("update(\"loadcell\") due", 500000, [](int) {
+        sensorManager.update("loadcell");
+        return true;
+    });
+    timeUpdate("update(handle) due", 500000, [](int) {
+        sensorManager.update(loadCellSensor);
+        return true;
+    });
+    timeUpdate("operator[](\"loadcell\") as float", 0, [](int) {
+        float weight = sensorManager["loadcell"];
+        benchKeep(weight);
+        return true;
+    });
+    timeUpdate("operator[](handle) as float", 0, [](int) {
+        float weight = sensorManager[loadCellSensor];
+        benchKeep(weight);
+        return true;
+    });
+    timeUpdate("handle getFloat()", 0, [](int) {
+        benchKeep(weightValue->getFloat());
+        return true;
+    });
+    timeUpdate("toJson() view of all values", 0, [](int) {
+        benchKeep(sensorManager.toJson().size());
+        return true;
+    });
+    timeUpdate("getModule<HX711Sens>(\"loadcell\")", 0, [](int) {
+        benchKeep(sensorManager.getModule<HX711Sens>("loadcell"));
+        return true;
+    });
+    timeUpdate("getModule<HX711Sens>(handle)", 0, [](int) {
+        benchKeep(sensorManager.getModule<HX711Sens>(loadCellSensor));
+        return true;
+    });
+
+    delete sampledLoadCell;
+    delete capturedUltrasonic;
+    printf("\nlast values: weight %.3f kg, height %.1f cm\n", (double) currentWeight, (double) currentHeight);
+    return 0;
+}
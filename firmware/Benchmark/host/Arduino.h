@@ -0,0 +1,156 @@
+/*
+ *  Arduino.h
+ *
+ *  host shim so firmware libraries can be built and benchmarked off-device
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_ARDUINO_SHIM_H
+#define HOST_ARDUINO_SHIM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#include "WString.h"
+
+using std::abs;
+using std::max;
+using std::min;
+using std::sqrt;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#define F(text) (text)
+
+/*tells libraries that SPIFFS.h (local filesystem backed) is available*/
+#define HOST_SPIFFS
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    if (inMax == inMin) return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+/*
+ * Host clock. micros() is real time plus a warp offset; with time warp on,
+ * delay() and delayMicroseconds() advance the offset instead of sleeping,
+ * so time-gated code runs at full speed.
+ */
+struct HostClock {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long long offsetUs = 0;
+    bool warp = false;
+};
+
+inline HostClock hostClock;
+
+inline void hostSetTimeWarp(bool enable) {
+    hostClock.warp = enable;
+}
+
+inline void hostAdvanceMicros(unsigned long long us) {
+    hostClock.offsetUs += us;
+}
+
+inline unsigned long micros() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - hostClock.start).count();
+    return (unsigned long) (elapsed + hostClock.offsetUs);
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+inline void delayMicroseconds(unsigned int us) {
+    if (hostClock.warp) hostAdvanceMicros(us);
+    else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+inline void delay(unsigned long ms) {
+    if (hostClock.warp) hostAdvanceMicros((unsigned long long) ms * 1000);
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+/*pins read back whatever was last written, or what the benchmark sets*/
+const int HOST_PIN_COUNT = 64;
+inline uint8_t hostPinLevel[HOST_PIN_COUNT];
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < HOST_PIN_COUNT) hostPinLevel[pin] = level;
+}
+
+inline int digitalRead(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? hostPinLevel[pin] : LOW;
+}
+
+inline int analogRead(uint8_t) {
+    return 0;
+}
+
+inline void randomSeed(unsigned long seed) {
+    srand((unsigned int) seed);
+}
+
+inline long random(long howBig) {
+    if (howBig <= 0) return 0;
+    return rand() % howBig;
+}
+
+inline long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return random(howBig - howSmall) + howSmall;
+}
+
+/*ESP32 core time helpers (esp32-hal-time), backed by the host clock*/
+inline long hostGmtOffsetSec = 0;
+inline int hostDaylightOffsetSec = 0;
+
+inline void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *, const char * = nullptr,
+                       const char * = nullptr) {
+    hostGmtOffsetSec = gmtOffsetSec;
+    hostDaylightOffsetSec = daylightOffsetSec;
+}
+
+inline bool getLocalTime(struct tm *info, uint32_t = 5000) {
+    time_t now = time(nullptr) + hostGmtOffsetSec + hostDaylightOffsetSec;
+    return gmtime_r(&now, info) != nullptr;
+}
+
+#include "HardwareSerial.h"
+
+#endif  // HOST_ARDUINO_SHIM_H
@@ -0,0 +1,398 @@
+/*
+ *  ArduinoJson.h
+ *
+ *  host stand-in for the subset of ArduinoJson 7 the sensor modules use:
+ *  JsonDocument, JsonVariant, JsonObject/JsonArray iteration and
+ *  serializeJsonPretty(). Members are searched linearly like the real
+ *  library, so lookups by name cost about the same.
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_ARDUINO_JSON_H
+#define HOST_ARDUINO_JSON_H
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "WString.h"
+
+struct JsonNode {
+    enum Type {
+        NUL,
+        INTEGER,
+        REAL,
+        STRING,
+        OBJECT,
+        ARRAY
+    };
+
+    Type type = NUL;
+    long long integer = 0;
+    double real = 0;
+    std::string text;
+    std::vector<std::pair<std::string, std::unique_ptr<JsonNode>>> members;
+    std::vector<std::unique_ptr<JsonNode>> elements;
+
+    void reset(Type newType) {
+        type = newType;
+        text.clear();
+        members.clear();
+        elements.clear();
+    }
+
+    void copyFrom(const JsonNode &other) {
+        reset(other.type);
+        integer = other.integer;
+        real = other.real;
+        text = other.text;
+        for (const auto &member: other.members) {
+            members.emplace_back(member.first, std::unique_ptr<JsonNode>(new JsonNode));
+            members.back().second->copyFrom(*member.second);
+        }
+        for (const auto &element: other.elements) {
+            elements.emplace_back(new JsonNode);
+            elements.back()->copyFrom(*element);
+        }
+    }
+
+    JsonNode *find(const char *key) const {
+        for (const auto &member: members) {
+            if (member.first == key) return member.second.get();
+        }
+        return nullptr;
+    }
+
+    JsonNode *findOrAdd(const char *key) {
+        if (type != OBJECT) reset(OBJECT);
+        JsonNode *node = find(key);
+        if (node != nullptr) return node;
+        members.emplace_back(key, std::unique_ptr<JsonNode>(new JsonNode));
+        return members.back().second.get();
+    }
+};
+
+class JsonVariant;
+class JsonObject;
+class JsonArray;
+
+class JsonString {
+private:
+    const char *value;
+public:
+    explicit JsonString(const char *text = nullptr) : value(text) {}
+    const char *c_str() const { return value; }
+};
+
+class JsonVariant {
+protected:
+    JsonNode *node;
+
+    template<typename T>
+    void setNumber(T value) {
+        node->reset(std::is_floating_point<T>::value ? JsonNode::REAL : JsonNode::INTEGER);
+        node->integer = (long long) value;
+        node->real = (double) value;
+    }
+
+public:
+    explicit JsonVariant(JsonNode *target = nullptr) : node(target) {}
+
+    bool isNull() const { return node == nullptr || node->type == JsonNode::NUL; }
+    JsonNode *getNode() const { return node; }
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, JsonVariant &>::type operator=(T value) {
+        if (node != nullptr) setNumber(value);
+        return *this;
+    }
+    JsonVariant &operator=(const char *value) {
+        if (node == nullptr) return *this;
+        node->reset(value != nullptr ? JsonNode::STRING : JsonNode::NUL);
+        if (value != nullptr) node->text = value;
+        return *this;
+    }
+    JsonVariant &operator=(const String &value) { return operator=(value.c_str()); }
+    JsonVariant &operator=(const JsonVariant &other) {
+        if (node != nullptr && other.node != nullptr && node != other.node) node->copyFrom(*other.node);
+        return *this;
+    }
+
+    template<typename T>
+    bool is() const;
+    template<typename T>
+    T as() const;
+    template<typename T>
+    T to();
+
+    size_t size() const {
+        if (node == nullptr) return 0;
+        return node->type == JsonNode::ARRAY ? node->elements.size() :
+               node->type == JsonNode::OBJECT ? node->members.size() : 0;
+    }
+
+    JsonVariant operator[](const char *key) {
+        return JsonVariant(node != nullptr ? node->findOrAdd(key) : nullptr);
+    }
+    JsonVariant operator[](const char *key) const {
+        return JsonVariant(node != nullptr && node->type == JsonNode::OBJECT ? node->find(key) : nullptr);
+    }
+    JsonVariant operator[](int index) const {
+        if (node == nullptr || node->type != JsonNode::ARRAY || index < 0 || (size_t) index >= node->elements.size()) {
+            return JsonVariant();
+        }
+        return JsonVariant(node->elements[index].get());
+    }
+
+    template<typename T>
+    bool add(T value) {
+        if (node == nullptr) return false;
+        if (node->type != JsonNode::ARRAY) node->reset(JsonNode::ARRAY);
+        node->elements.emplace_back(new JsonNode);
+        JsonVariant(node->elements.back().get()) = value;
+        return true;
+    }
+
+    template<typename T>
+    operator T() const { return as<T>(); }
+};
+
+class JsonPair {
+private:
+    const std::pair<std::string, std::unique_ptr<JsonNode>> *member;
+public:
+    explicit JsonPair(const std::pair<std::string, std::unique_ptr<JsonNode>> *entry) : member(entry) {}
+    JsonString key() const { return JsonString(member->first.c_str()); }
+    JsonVariant value() const { return JsonVariant(member->second.get()); }
+};
+
+class JsonObject : public JsonVariant {
+public:
+    class iterator {
+    private:
+        const std::pair<std::string, std::unique_ptr<JsonNode>> *position;
+    public:
+        explicit iterator(const std::pair<std::string, std::unique_ptr<JsonNode>> *entry) : position(entry) {}
+        JsonPair operator*() const { return JsonPair(position); }
+        iterator &operator++() {
+            position++;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return position != other.position; }
+    };
+
+    explicit JsonObject(JsonNode *target = nullptr) : JsonVariant(target) {}
+
+    iterator begin() const { return iterator(node != nullptr ? node->members.data() : nullptr); }
+    iterator end() const {
+        return iterator(node != nullptr ? node->members.data() + node->members.size() : nullptr);
+    }
+};
+
+class JsonArray : public JsonVariant {
+public:
+    class iterator {
+    private:
+        const std::unique_ptr<JsonNode> *position;
+    public:
+        explicit iterator(const std::unique_ptr<JsonNode> *entry) : position(entry) {}
+        JsonVariant operator*() const { return JsonVariant(position->get()); }
+        iterator &operator++() {
+            position++;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return position != other.position; }
+    };
+
+    explicit JsonArray(JsonNode *target = nullptr) : JsonVariant(target) {}
+
+    iterator begin() const { return iterator(node != nullptr ? node->elements.data() : nullptr); }
+    iterator end() const {
+        return iterator(node != nullptr ? node->elements.data() + node->elements.size() : nullptr);
+    }
+};
+
+template<typename T>
+inline bool JsonVariant::is() const {
+    if (node == nullptr) return false;
+    if (std::is_same<T, JsonObject>::value) return node->type == JsonNode::OBJECT;
+    if (std::is_same<T, JsonArray>::value) return node->type == JsonNode::ARRAY;
+    if (std::is_same<T, const char *>::value || std::is_same<T, String>::value) return node->type == JsonNode::STRING;
+    if (std::is_floating_point<T>::value) return node->type == JsonNode::INTEGER || node->type == JsonNode::REAL;
+    if (std::is_integral<T>::value) return node->type == JsonNode::INTEGER;
+    return false;
+}
+
+namespace HostJson {
+    template<typename T>
+    struct Convert {
+        static T from(const JsonNode *node) {
+            if (node == nullptr) return T();
+            if (node->type == JsonNode::INTEGER) return (T) node->integer;
+            if (node->type == JsonNode::REAL) return (T) node->real;
+            return T();
+        }
+    };
+
+    template<>
+    struct Convert<const char *> {
+        static const char *from(const JsonNode *node) {
+            return (node != nullptr && node->type == JsonNode::STRING) ? node->text.c_str() : nullptr;
+        }
+    };
+
+    template<>
+    struct Convert<String> {
+        static String from(const JsonNode *node) {
+            if (node == nullptr) return String("null");
+            if (node->type == JsonNode::STRING) return String(node->text.c_str());
+            if (node->type == JsonNode::INTEGER) return String((long) node->integer);
+            if (node->type == JsonNode::REAL) return String(node->real, 2U);
+            return String("null");
+        }
+    };
+
+    template<>
+    struct Convert<JsonObject> {
+        static JsonObject from(JsonNode *node) {
+            return JsonObject(node != nullptr && node->type == JsonNode::OBJECT ? node : nullptr);
+        }
+    };
+
+    template<>
+    struct Convert<JsonArray> {
+        static JsonArray from(JsonNode *node) {
+            return JsonArray(node != nullptr && node->type == JsonNode::ARRAY ? node : nullptr);
+        }
+    };
+
+    template<>
+    struct Convert<JsonVariant> {
+        static JsonVariant from(JsonNode *node) { return JsonVariant(node); }
+    };
+}
+
+template<typename T>
+inline T JsonVariant::as() const {
+    return HostJson::Convert<T>::from(node);
+}
+
+template<typename T>
+inline T JsonVariant::to() {
+    if (node != nullptr) {
+        node->reset(std::is_same<T, JsonArray>::value ? JsonNode::ARRAY :
+                    std::is_same<T, JsonObject>::value ? JsonNode::OBJECT : JsonNode::NUL);
+    }
+    return T(node);
+}
+
+class JsonDocument {
+private:
+    std::unique_ptr<JsonNode> root;
+
+public:
+    JsonDocument() : root(new JsonNode) {}
+    explicit JsonDocument(size_t) : root(new JsonNode) {}
+    JsonDocument(const JsonDocument &other) : root(new JsonNode) { root->copyFrom(*other.root); }
+    JsonDocument(JsonDocument &&other) noexcept : root(std::move(other.root)) {
+        other.root.reset(new JsonNode);
+    }
+    JsonDocument &operator=(const JsonDocument &other) {
+        if (this != &other) root->copyFrom(*other.root);
+        return *this;
+    }
+    JsonDocument &operator=(JsonDocument &&other) noexcept {
+        std::swap(root, other.root);
+        return *this;
+    }
+
+    JsonVariant operator[](const char *key) { return JsonVariant(root->findOrAdd(key)); }
+    JsonVariant operator[](const char *key) const {
+        return JsonVariant(root->type == JsonNode::OBJECT ? root->find(key) : nullptr);
+    }
+    JsonVariant operator[](const String &key) { return operator[](key.c_str()); }
+    JsonVariant operator[](int index) const { return JsonVariant(root.get())[index]; }
+
+    template<typename T>
+    bool is() const { return JsonVariant(root.get()).is<T>(); }
+    template<typename T>
+    T as() const { return JsonVariant(root.get()).as<T>(); }
+    template<typename T>
+    T to() { return JsonVariant(root.get()).to<T>(); }
+    template<typename T>
+    bool add(T value) { return JsonVariant(root.get()).add(value); }
+
+    size_t size() const { return JsonVariant(root.get()).size(); }
+    bool isNull() const { return root->type == JsonNode::NUL; }
+    void clear() { root->reset(JsonNode::NUL); }
+    bool containsKey(const char *key) const { return root->type == JsonNode::OBJECT && root->find(key) != nullptr; }
+
+    JsonNode *getNode() const { return root.get(); }
+    operator JsonVariant() const { return JsonVariant(root.get()); }
+};
+
+namespace HostJson {
+    template<typename Output>
+    void writePretty(const JsonNode *node, Output &output, int depth) {
+        char number[32];
+        switch (node->type) {
+            case JsonNode::NUL:
+                output.print("null");
+                break;
+            case JsonNode::INTEGER:
+                snprintf(number, sizeof(number), "%lld", node->integer);
+                output.print(number);
+                break;
+            case JsonNode::REAL:
+                snprintf(number, sizeof(number), "%.9g", node->real);
+                output.print(number);
+                break;
+            case JsonNode::STRING:
+                output.print("\"");
+                output.print(node->text.c_str());
+                output.print("\"");
+                break;
+            case JsonNode::OBJECT:
+            case JsonNode::ARRAY: {
+                bool isObject = node->type == JsonNode::OBJECT;
+                size_t count = isObject ? node->members.size() : node->elements.size();
+                output.print(isObject ? "{" : "[");
+                for (size_t i = 0; i < count; i++) {
+                    output.print(i == 0 ? "\r\n" : ",\r\n");
+                    for (int indent = 0; indent <= depth; indent++) output.print("  ");
+                    if (isObject) {
+                        output.print("\"");
+                        output.print(node->members[i].first.c_str());
+                        output.print("\": ");
+                    }
+                    writePretty(isObject ? node->members[i].second.get() : node->elements[i].get(), output, depth + 1);
+                }
+                if (count > 0) {
+                    output.print("\r\n");
+                    for (int indent = 0; indent < depth; indent++) output.print("  ");
+                }
+                output.print(isObject ? "}" : "]");
+                break;
+            }
+        }
+    }
+}
+
+template<typename Output>
+inline size_t serializeJsonPretty(const JsonDocument &doc, Output &output) {
+    HostJson::writePretty(doc.getNode(), output, 0);
+    return 0;
+}
+
+template<typename Output>
+inline size_t serializeJsonPretty(const JsonVariant &variant, Output &output) {
+    if (variant.getNode() == nullptr) output.print("null");
+    else HostJson::writePretty(variant.getNode(), output, 0);
+    return 0;
+}
+
+#endif  // HOST_ARDUINO_JSON_H
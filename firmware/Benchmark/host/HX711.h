@@ -0,0 +1,65 @@
+/*
+ *  HX711.h
+ *
+ *  host stand-in for the bogde HX711 driver. Raw counts come from
+ *  hostSetRaw() plus optional jitter, and every read() spends the time a
+ *  24-bit bit-banged transfer takes on the ESP32 (through
+ *  delayMicroseconds, so time warp makes it free)
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_HX711_H
+#define HOST_HX711_H
+
+#include "Arduino.h"
+
+class HX711 {
+private:
+    static const unsigned int READ_US = 60;
+
+    long offset;
+    float scale;
+    long raw;
+    long jitter;
+    bool ready;
+
+public:
+    HX711() : offset(0), scale(1.f), raw(0), jitter(0), ready(true) {}
+    virtual ~HX711() = default;
+
+    void begin(byte, byte, byte = 128) {}
+
+    /*host only: the count the load cell reports and how much it wanders*/
+    void hostSetRaw(long counts, long noise = 0) {
+        raw = counts;
+        jitter = noise;
+    }
+    void hostSetReady(bool state) { ready = state; }
+
+    bool is_ready() { return ready; }
+    void wait_ready(unsigned long = 0) {}
+
+    long read() {
+        delayMicroseconds(READ_US);
+        return raw + (jitter > 0 ? random(-jitter, jitter + 1) : 0);
+    }
+    long read_average(byte times = 10) {
+        long sum = 0;
+        for (byte i = 0; i < times; i++) sum += read();
+        return times > 0 ? sum / times : 0;
+    }
+    double get_value(byte times = 1) { return read_average(times) - offset; }
+    float get_units(byte times = 1) { return (float) (get_value(times) / scale); }
+
+    void tare(byte times = 10) { offset = read_average(times); }
+    void set_scale(float newScale = 1.f) { scale = newScale; }
+    float get_scale() { return scale; }
+    void set_offset(long newOffset = 0) { offset = newOffset; }
+    long get_offset() { return offset; }
+    void power_down() {}
+    void power_up() {}
+};
+
+#endif  // HOST_HX711_H
@@ -0,0 +1,112 @@
+/*
+ *  HardwareSerial.h
+ *
+ *  host serial port: output goes to a FILE (nullptr drops it), input is
+ *  whatever the benchmark feeds in
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "WString.h"
+
+class HardwareSerial {
+private:
+    FILE *output;
+    std::string input;
+    size_t inputPosition;
+
+    size_t emit(const char *text, size_t length) {
+        if (output != nullptr) fwrite(text, 1, length, output);
+        return length;
+    }
+
+public:
+    explicit HardwareSerial(FILE *out = stdout) : output(out), inputPosition(0) {}
+
+    void begin(unsigned long) {}
+    void end() {}
+    void flush() {
+        if (output != nullptr) fflush(output);
+    }
+
+    /*host only: where print() goes, and bytes queued for read()*/
+    void setOutput(FILE *out) { output = out; }
+    void feed(const char *data) {
+        if (inputPosition == input.size()) {
+            input.clear();
+            inputPosition = 0;
+        }
+        input += data;
+    }
+
+    int available() const { return (int) (input.size() - inputPosition); }
+    int peek() const { return available() > 0 ? (unsigned char) input[inputPosition] : -1; }
+    int read() { return available() > 0 ? (unsigned char) input[inputPosition++] : -1; }
+
+    String readStringUntil(char terminator) {
+        std::string text;
+        while (available() > 0) {
+            char c = (char) read();
+            if (c == terminator) break;
+            text += c;
+        }
+        return String(text);
+    }
+    String readString() {
+        std::string text = input.substr(inputPosition);
+        inputPosition = input.size();
+        return String(text);
+    }
+
+    size_t write(uint8_t c) { return emit((const char *) &c, 1); }
+    size_t write(const uint8_t *data, size_t length) { return emit((const char *) data, length); }
+
+    size_t print(const char *text) { return text != nullptr ? emit(text, strlen(text)) : 0; }
+    size_t print(const String &text) { return emit(text.c_str(), text.length()); }
+    size_t print(char c) { return emit(&c, 1); }
+    size_t print(unsigned char number, int base = DEC) { return print(String(number, (unsigned char) base)); }
+    size_t print(int number, int base = DEC) { return print(String(number, (unsigned char) base)); }
+    size_t print(unsigned int number, int base = DEC) { return print(String(number, (unsigned char) base)); }
+    size_t print(long number, int base = DEC) { return print(String(number, (unsigned char) base)); }
+    size_t print(unsigned long number, int base = DEC) { return print(String(number, (unsigned char) base)); }
+    size_t print(double number, int digits = 2) { return print(String(number, (unsigned int) digits)); }
+
+    size_t println() { return emit("\n", 1); }
+    template<typename T>
+    size_t println(const T &value) {
+        size_t written = print(value);
+        return written + println();
+    }
+    template<typename T>
+    size_t println(const T &value, int format) {
+        size_t written = print(value, format);
+        return written + println();
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    explicit operator bool() const { return true; }
+};
+
+inline size_t HardwareSerial::printf(const char *format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return emit(buffer, (size_t) length < sizeof(buffer) ? (size_t) length : sizeof(buffer) - 1);
+}
+
+inline HardwareSerial Serial;
+
+#endif  // HOST_HARDWARE_SERIAL_H
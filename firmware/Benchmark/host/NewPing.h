@@ -0,0 +1,53 @@
+/*
+ *  NewPing.h
+ *
+ *  host stand-in for NewPing. The echo distance comes from
+ *  hostSetDistance(), and ping() blocks for the trigger pulse plus the
+ *  echo round trip like the real driver (through delayMicroseconds, so
+ *  time warp makes it free)
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_NEW_PING_H
+#define HOST_NEW_PING_H
+
+#include "Arduino.h"
+
+#define US_ROUNDTRIP_CM 57
+#define US_ROUNDTRIP_IN 146
+#define NO_ECHO 0
+
+class NewPing {
+private:
+    unsigned int maxDistanceCm;
+    float distanceCm;
+
+public:
+    NewPing(uint8_t, uint8_t, unsigned int maxDistance = 500)
+            : maxDistanceCm(maxDistance), distanceCm(0) {}
+    virtual ~NewPing() = default;
+
+    /*host only: what the next echo measures, 0 or past max reads as no echo*/
+    void hostSetDistance(float cm) { distanceCm = cm; }
+
+    unsigned long ping(unsigned int maxDistance = 0) {
+        unsigned int limit = maxDistance > 0 ? maxDistance : maxDistanceCm;
+        bool echo = distanceCm > 0 && distanceCm <= limit;
+        unsigned long echoUs = (unsigned long) ((echo ? distanceCm : limit) * US_ROUNDTRIP_CM);
+        delayMicroseconds(12 + (unsigned int) echoUs);
+        return echo ? echoUs : NO_ECHO;
+    }
+    unsigned long ping_cm(unsigned int maxDistance = 0) { return ping(maxDistance) / US_ROUNDTRIP_CM; }
+    unsigned long ping_in(unsigned int maxDistance = 0) { return ping(maxDistance) / US_ROUNDTRIP_IN; }
+    unsigned long ping_median(uint8_t iterations = 5, unsigned int maxDistance = 0) {
+        unsigned long total = 0;
+        for (uint8_t i = 0; i < iterations; i++) total += ping(maxDistance);
+        return iterations > 0 ? total / iterations : 0;
+    }
+    static unsigned int convert_cm(unsigned int echoTime) { return echoTime / US_ROUNDTRIP_CM; }
+    static unsigned int convert_in(unsigned int echoTime) { return echoTime / US_ROUNDTRIP_IN; }
+};
+
+#endif  // HOST_NEW_PING_H
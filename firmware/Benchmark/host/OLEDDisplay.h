@@ -0,0 +1,385 @@
+/*
+ *  OLEDDisplay.h
+ *
+ *  host stand-in for the ThingPulse OLEDDisplay base class: the same page
+ *  framebuffer (one byte per 8 vertical pixels) and drawing primitives,
+ *  display() counts frames instead of sending them over I2C
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_OLED_DISPLAY_H
+#define HOST_OLED_DISPLAY_H
+
+#include "Arduino.h"
+#include "OLEDDisplayFonts.h"
+
+enum OLEDDISPLAY_COLOR {
+    BLACK = 0,
+    WHITE = 1,
+    INVERSE = 2
+};
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT {
+    TEXT_ALIGN_LEFT = 0,
+    TEXT_ALIGN_RIGHT = 1,
+    TEXT_ALIGN_CENTER = 2,
+    TEXT_ALIGN_CENTER_BOTH = 3
+};
+
+enum OLEDDISPLAY_GEOMETRY {
+    GEOMETRY_128_64 = 0,
+    GEOMETRY_128_32 = 1,
+    GEOMETRY_64_48 = 2,
+    GEOMETRY_64_32 = 3
+};
+
+class OLEDDisplay {
+private:
+    static const int MAX_WIDTH = 128;
+    static const int MAX_HEIGHT = 64;
+
+    uint8_t frame[MAX_WIDTH * MAX_HEIGHT / 8];
+    OLEDDISPLAY_COLOR color;
+    OLEDDISPLAY_TEXT_ALIGNMENT textAlignment;
+    const uint8_t *fontData;
+    uint32_t frameCount;
+
+    /*proportional widths close to ArialMT, scaled from the 10 px face*/
+    uint8_t glyphWidth(char c) const {
+        int base;
+        if (strchr(" .,:;'!|il", c) != nullptr) base = 3;
+        else if (strchr("mwMW@%", c) != nullptr) base = 9;
+        else if (c >= 'A' && c <= 'Z') base = 7;
+        else base = 6;
+        return (uint8_t) (base * fontData[0] / 10);
+    }
+
+    void plotPair(int16_t x0, int16_t y0, int16_t dx1, int16_t dy1, int16_t dx2, int16_t dy2) {
+        setPixel((int16_t) (x0 + dx1), (int16_t) (y0 + dy1));
+        setPixel((int16_t) (x0 + dx2), (int16_t) (y0 + dy2));
+    }
+
+    /*blits a synthesized glyph column by column like OLEDDisplay::drawInternal()*/
+    void drawGlyph(int16_t x, int16_t y, char c) {
+        uint8_t width = glyphWidth(c);
+        uint8_t rows = (uint8_t) ((fontData[1] + 7) / 8);
+        if (c == ' ') return;
+
+        for (uint8_t column = 0; column < width; column++) {
+            int16_t pixelX = x + column;
+            if (pixelX < 0 || pixelX >= displayWidth) continue;
+
+            for (uint8_t row = 0; row < rows; row++) {
+                uint8_t bits = (uint8_t) ((c * 37 + column * 11 + row * 7) | 0x81);
+                int16_t pixelY = (int16_t) (y + row * 8);
+                int page = pixelY >> 3;
+                int shift = pixelY & 7;
+                if (pixelY + 8 <= 0 || page >= displayHeight / 8) continue;
+
+                if (page >= 0) writeByte(pixelX + page * displayWidth, (uint8_t) (bits << shift));
+                if (shift != 0 && page + 1 < displayHeight / 8 && page + 1 >= 0) {
+                    writeByte(pixelX + (page + 1) * displayWidth, (uint8_t) (bits >> (8 - shift)));
+                }
+            }
+        }
+    }
+
+    void writeByte(int index, uint8_t bits) {
+        switch (color) {
+            case WHITE:
+                buffer[index] |= bits;
+                break;
+            case BLACK:
+                buffer[index] &= (uint8_t) ~bits;
+                break;
+            case INVERSE:
+                buffer[index] ^= bits;
+                break;
+        }
+    }
+
+    uint16_t drawTextLine(int16_t x, int16_t y, const char *text, uint16_t length) {
+        uint16_t lineWidth = getStringWidth(text, length);
+        if (textAlignment == TEXT_ALIGN_CENTER || textAlignment == TEXT_ALIGN_CENTER_BOTH) x -= lineWidth / 2;
+        else if (textAlignment == TEXT_ALIGN_RIGHT) x -= lineWidth;
+
+        for (uint16_t i = 0; i < length; i++) {
+            drawGlyph(x, y, text[i]);
+            x += glyphWidth(text[i]);
+        }
+        return lineWidth;
+    }
+
+protected:
+    /*same protected names as the real class, renderers copy the buffer directly*/
+    uint8_t *buffer;
+    uint16_t displayBufferSize;
+    int16_t displayWidth;
+    int16_t displayHeight;
+
+public:
+    explicit OLEDDisplay(OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64)
+            : color(WHITE), textAlignment(TEXT_ALIGN_LEFT), fontData(ArialMT_Plain_10), frameCount(0),
+              buffer(frame),
+              displayWidth((g == GEOMETRY_128_64 || g == GEOMETRY_128_32) ? 128 : 64),
+              displayHeight((g == GEOMETRY_128_64) ? 64 : (g == GEOMETRY_64_48) ? 48 : 32) {
+        displayBufferSize = (uint16_t) (displayWidth * displayHeight / 8);
+        memset(frame, 0, sizeof(frame));
+    }
+    OLEDDisplay(const OLEDDisplay &) = delete;
+    OLEDDisplay &operator=(const OLEDDisplay &) = delete;
+    virtual ~OLEDDisplay() = default;
+
+    bool init() {
+        clear();
+        return true;
+    }
+    void end() {}
+    void resetDisplay() { clear(); }
+    void display() { frameCount++; }
+    void clear() { memset(buffer, 0, displayBufferSize); }
+
+    void displayOn() {}
+    void displayOff() {}
+    void invertDisplay() {}
+    void normalDisplay() {}
+    void setContrast(uint8_t, uint8_t = 241, uint8_t = 64) {}
+    void setBrightness(uint8_t) {}
+    void resetOrientation() {}
+    void flipScreenVertically() {}
+    void mirrorScreen() {}
+
+    int16_t width() const { return displayWidth; }
+    int16_t height() const { return displayHeight; }
+    uint16_t getWidth() const { return (uint16_t) displayWidth; }
+    uint16_t getHeight() const { return (uint16_t) displayHeight; }
+
+    /*host only: frames pushed so far and the framebuffer contents*/
+    uint32_t getFrameCount() const { return frameCount; }
+    const uint8_t *getBuffer() const { return buffer; }
+    size_t getBufferSize() const { return displayBufferSize; }
+
+    void setColor(OLEDDISPLAY_COLOR newColor) { color = newColor; }
+    OLEDDISPLAY_COLOR getColor() const { return color; }
+
+    void setPixel(int16_t x, int16_t y) {
+        if (x < 0 || x >= displayWidth || y < 0 || y >= displayHeight) return;
+        writeByte(x + (y >> 3) * displayWidth, (uint8_t) (1 << (y & 7)));
+    }
+    void setPixelColor(int16_t x, int16_t y, OLEDDISPLAY_COLOR pixelColor) {
+        OLEDDISPLAY_COLOR saved = color;
+        color = pixelColor;
+        setPixel(x, y);
+        color = saved;
+    }
+    void clearPixel(int16_t x, int16_t y) { setPixelColor(x, y, BLACK); }
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+        int16_t dx = (int16_t) abs(x1 - x0);
+        int16_t dy = (int16_t) -abs(y1 - y0);
+        int16_t sx = x0 < x1 ? 1 : -1;
+        int16_t sy = y0 < y1 ? 1 : -1;
+        int16_t error = (int16_t) (dx + dy);
+
+        while (true) {
+            setPixel(x0, y0);
+            if (x0 == x1 && y0 == y1) break;
+            int16_t doubled = (int16_t) (2 * error);
+            if (doubled >= dy) {
+                error = (int16_t) (error + dy);
+                x0 = (int16_t) (x0 + sx);
+            }
+            if (doubled <= dx) {
+                error = (int16_t) (error + dx);
+                y0 = (int16_t) (y0 + sy);
+            }
+        }
+    }
+
+    void drawHorizontalLine(int16_t x, int16_t y, int16_t length) {
+        for (int16_t i = 0; i < length; i++) setPixel((int16_t) (x + i), y);
+    }
+    void drawVerticalLine(int16_t x, int16_t y, int16_t length) {
+        for (int16_t i = 0; i < length; i++) setPixel(x, (int16_t) (y + i));
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t width, int16_t height) {
+        drawHorizontalLine(x, y, width);
+        drawVerticalLine(x, y, height);
+        drawVerticalLine((int16_t) (x + width - 1), y, height);
+        drawHorizontalLine(x, (int16_t) (y + height - 1), width);
+    }
+    void fillRect(int16_t x, int16_t y, int16_t width, int16_t height) {
+        for (int16_t i = 0; i < width; i++) drawVerticalLine((int16_t) (x + i), y, height);
+    }
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t radius) {
+        int16_t x = 0;
+        int16_t y = radius;
+        int16_t decision = (int16_t) (1 - radius);
+        while (x <= y) {
+            setPixel((int16_t) (x0 + x), (int16_t) (y0 + y));
+            setPixel((int16_t) (x0 - x), (int16_t) (y0 + y));
+            setPixel((int16_t) (x0 + x), (int16_t) (y0 - y));
+            setPixel((int16_t) (x0 - x), (int16_t) (y0 - y));
+            setPixel((int16_t) (x0 + y), (int16_t) (y0 + x));
+            setPixel((int16_t) (x0 - y), (int16_t) (y0 + x));
+            setPixel((int16_t) (x0 + y), (int16_t) (y0 - x));
+            setPixel((int16_t) (x0 - y), (int16_t) (y0 - x));
+            x++;
+            if (decision < 0) {
+                decision = (int16_t) (decision + 2 * x + 1);
+            } else {
+                y--;
+                decision = (int16_t) (decision + 2 * (x - y) + 1);
+            }
+        }
+    }
+    /*quads: 1 upper right, 2 upper left, 4 lower left, 8 lower right*/
+    void drawCircleQuads(int16_t x0, int16_t y0, int16_t radius, uint8_t quads) {
+        int16_t x = 0;
+        int16_t y = radius;
+        int16_t decision = (int16_t) (1 - radius);
+        while (x <= y) {
+            if (quads & 0x1) plotPair(x0, y0, x, (int16_t) -y, y, (int16_t) -x);
+            if (quads & 0x2) plotPair(x0, y0, (int16_t) -y, (int16_t) -x, (int16_t) -x, (int16_t) -y);
+            if (quads & 0x4) plotPair(x0, y0, (int16_t) -y, x, (int16_t) -x, y);
+            if (quads & 0x8) plotPair(x0, y0, x, y, y, x);
+            x++;
+            if (decision < 0) {
+                decision = (int16_t) (decision + 2 * x + 1);
+            } else {
+                y--;
+                decision = (int16_t) (decision + 2 * (x - y) + 1);
+            }
+        }
+    }
+    void fillCircle(int16_t x0, int16_t y0, int16_t radius) {
+        for (int16_t y = (int16_t) -radius; y <= radius; y++) {
+            int16_t span = (int16_t) sqrt((float) (radius * radius - y * y));
+            drawHorizontalLine((int16_t) (x0 - span), (int16_t) (y0 + y), (int16_t) (2 * span + 1));
+        }
+    }
+
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+        drawLine(x0, y0, x1, y1);
+        drawLine(x1, y1, x2, y2);
+        drawLine(x2, y2, x0, y0);
+    }
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+        int16_t minY = min(y0, min(y1, y2));
+        int16_t maxY = max(y0, max(y1, y2));
+        const int16_t xs[3] = {x0, x1, x2};
+        const int16_t ys[3] = {y0, y1, y2};
+
+        for (int16_t y = minY; y <= maxY; y++) {
+            int16_t left = INT16_MAX;
+            int16_t right = INT16_MIN;
+            for (int e = 0; e < 3; e++) {
+                int16_t ax = xs[e], ay = ys[e], bx = xs[(e + 1) % 3], by = ys[(e + 1) % 3];
+                if ((y < ay && y < by) || (y > ay && y > by)) continue;
+                int16_t x = (ay == by) ? ax : (int16_t) (ax + (bx - ax) * (y - ay) / (by - ay));
+                left = min(left, (ay == by) ? min(ax, bx) : x);
+                right = max(right, (ay == by) ? max(ax, bx) : x);
+            }
+            if (left <= right) drawHorizontalLine(left, y, (int16_t) (right - left + 1));
+        }
+    }
+
+    void drawProgressBar(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t progress) {
+        drawRect((int16_t) x, (int16_t) y, (int16_t) width, (int16_t) height);
+        int16_t filled = (int16_t) ((width - 4) * progress / 100);
+        fillRect((int16_t) (x + 2), (int16_t) (y + 2), filled, (int16_t) (height - 4));
+    }
+
+    /*image bytes are vertical 8-pixel strips, like the framebuffer*/
+    void drawFastImage(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t *image) {
+        for (int16_t page = 0; page < (height + 7) / 8; page++) {
+            for (int16_t column = 0; column < width; column++) {
+                uint8_t bits = image[page * width + column];
+                for (int bit = 0; bit < 8; bit++) {
+                    if (bits & (1 << bit)) setPixel((int16_t) (x + column), (int16_t) (y + page * 8 + bit));
+                }
+            }
+        }
+    }
+    void drawXbm(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t *xbm) {
+        int16_t rowBytes = (int16_t) ((width + 7) / 8);
+        for (int16_t row = 0; row < height; row++) {
+            for (int16_t column = 0; column < width; column++) {
+                if (xbm[row * rowBytes + column / 8] & (1 << (column & 7))) {
+                    setPixel((int16_t) (x + column), (int16_t) (y + row));
+                }
+            }
+        }
+    }
+
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT alignment) { textAlignment = alignment; }
+    void setFont(const uint8_t *font) { fontData = font; }
+
+    uint16_t getStringWidth(const char *text, uint16_t length, bool = false) {
+        uint16_t width = 0;
+        uint16_t widest = 0;
+        for (uint16_t i = 0; i < length; i++) {
+            if (text[i] == '\n') {
+                widest = max(widest, width);
+                width = 0;
+                continue;
+            }
+            width = (uint16_t) (width + glyphWidth(text[i]));
+        }
+        return max(widest, width);
+    }
+    uint16_t getStringWidth(const String &text) { return getStringWidth(text.c_str(), (uint16_t) text.length()); }
+
+    uint16_t drawString(int16_t x, int16_t y, const String &text) {
+        const char *line = text.c_str();
+        uint16_t lineHeight = fontData[1];
+        if (textAlignment == TEXT_ALIGN_CENTER_BOTH) {
+            uint16_t lines = 1;
+            for (const char *c = line; *c != '\0'; c++) lines += (*c == '\n');
+            y = (int16_t) (y - lines * lineHeight / 2);
+        }
+
+        uint16_t widest = 0;
+        while (true) {
+            const char *end = strchr(line, '\n');
+            uint16_t length = (uint16_t) (end != nullptr ? end - line : strlen(line));
+            widest = max(widest, drawTextLine(x, y, line, length));
+            if (end == nullptr) break;
+            line = end + 1;
+            y = (int16_t) (y + lineHeight);
+        }
+        return widest;
+    }
+
+    /*wraps on spaces once a line would exceed maxLineWidth*/
+    uint16_t drawStringMaxWidth(int16_t x, int16_t y, uint16_t maxLineWidth, const String &text) {
+        const char *line = text.c_str();
+        uint16_t lineHeight = fontData[1];
+        uint16_t lines = 0;
+
+        while (*line != '\0') {
+            uint16_t length = 0;
+            uint16_t lastBreak = 0;
+            uint16_t width = 0;
+            while (line[length] != '\0' && line[length] != '\n') {
+                width = (uint16_t) (width + glyphWidth(line[length]));
+                if (width > maxLineWidth && lastBreak > 0) break;
+                if (line[length] == ' ') lastBreak = length;
+                length++;
+            }
+            if (line[length] != '\0' && line[length] != '\n' && lastBreak > 0) length = lastBreak;
+
+            drawTextLine(x, (int16_t) (y + lines * lineHeight), line, length);
+            lines++;
+            line += length;
+            if (*line == ' ' || *line == '\n') line++;
+        }
+        return (uint16_t) (lines * lineHeight);
+    }
+};
+
+#endif  // HOST_OLED_DISPLAY_H
@@ -0,0 +1,22 @@
+/*
+ *  OLEDDisplayFonts.h
+ *
+ *  host stand-ins for the ThingPulse fonts: only the 4-byte header (max
+ *  width, height, first char, char count) is kept, glyph widths and
+ *  bitmaps are synthesized by OLEDDisplay so text costs about the same
+ *  to draw as with the real tables
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_OLED_DISPLAY_FONTS_H
+#define HOST_OLED_DISPLAY_FONTS_H
+
+#include <cstdint>
+
+const uint8_t ArialMT_Plain_10[] = {0x0A, 0x0D, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_16[] = {0x10, 0x13, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_24[] = {0x18, 0x1C, 0x20, 0xE0};
+
+#endif  // HOST_OLED_DISPLAY_FONTS_H
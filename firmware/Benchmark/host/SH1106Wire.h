@@ -0,0 +1,23 @@
+/*
+ *  SH1106Wire.h
+ *
+ *  host stand-in for the ThingPulse SH1106 I2C driver, all drawing is done
+ *  by the OLEDDisplay framebuffer
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_SH1106_WIRE_H
+#define HOST_SH1106_WIRE_H
+
+#include "OLEDDisplay.h"
+#include "Wire.h"
+
+class SH1106Wire : public OLEDDisplay {
+public:
+    SH1106Wire(uint8_t = 0x3C, int = -1, int = -1, OLEDDISPLAY_GEOMETRY g = GEOMETRY_128_64)
+            : OLEDDisplay(g) {}
+};
+
+#endif  // HOST_SH1106_WIRE_H
@@ -0,0 +1,8 @@
+/*
+ *  SPI.h
+ *
+ *  empty host stand-in, the host build has no SPI bus
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
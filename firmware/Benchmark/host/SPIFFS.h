@@ -0,0 +1,117 @@
+/*
+ *  SPIFFS.h
+ *
+ *  host stand-in for the ESP32 SPIFFS filesystem: paths map into a local
+ *  root directory (./spiffs by default, see setRoot)
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_SPIFFS_H
+#define HOST_SPIFFS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "WString.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+class File {
+private:
+    FILE *handle;
+    std::string name;
+
+public:
+    File() : handle(nullptr) {}
+    File(FILE *file, const std::string &path) : handle(file), name(path) {}
+
+    explicit operator bool() const { return handle != nullptr; }
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t length) {
+        return handle != nullptr ? fwrite(data, 1, length, handle) : 0;
+    }
+    size_t print(const char *text) { return write((const uint8_t *) text, strlen(text)); }
+    size_t print(const String &text) { return write((const uint8_t *) text.c_str(), text.length()); }
+    size_t println(const char *text = "") { return print(text) + print("\n"); }
+
+    size_t read(uint8_t *data, size_t length) {
+        return handle != nullptr ? fread(data, 1, length, handle) : 0;
+    }
+    int read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int available() {
+        if (handle == nullptr) return 0;
+        long position = ftell(handle);
+        return (int) (size() - (size_t) position);
+    }
+
+    bool seek(uint32_t position) {
+        return handle != nullptr && fseek(handle, position, SEEK_SET) == 0;
+    }
+    size_t position() const { return handle != nullptr ? (size_t) ftell(handle) : 0; }
+    size_t size() const {
+        struct stat info;
+        if (handle == nullptr || fstat(fileno(handle), &info) != 0) return 0;
+        return (size_t) info.st_size;
+    }
+    const char *path() const { return name.c_str(); }
+
+    void flush() {
+        if (handle != nullptr) fflush(handle);
+    }
+    void close() {
+        if (handle != nullptr) fclose(handle);
+        handle = nullptr;
+    }
+};
+
+class HostFS {
+private:
+    std::string root;
+
+    std::string resolve(const char *path) const {
+        return root + ((path != nullptr && path[0] == '/') ? "" : "/") + (path != nullptr ? path : "");
+    }
+
+public:
+    HostFS() : root("spiffs") {}
+
+    void setRoot(const char *directory) { root = directory; }
+
+    /*there is nothing to format, a missing root is simply created*/
+    bool begin(bool = false) {
+        struct stat info;
+        if (stat(root.c_str(), &info) == 0) return S_ISDIR(info.st_mode);
+        return mkdir(root.c_str(), 0755) == 0;
+    }
+    void end() {}
+
+    File open(const char *path, const char *mode = FILE_READ) {
+        bool update = mode[1] == '+';
+        const char *hostMode = (mode[0] == 'w') ? (update ? "wb+" : "wb") : (mode[0] == 'a') ? (update ? "ab+" : "ab")
+                                                                                            : (update ? "rb+" : "rb");
+        FILE *file = fopen(resolve(path).c_str(), hostMode);
+        return file != nullptr ? File(file, path) : File();
+    }
+    File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+
+    bool exists(const char *path) const { return access(resolve(path).c_str(), F_OK) == 0; }
+    bool remove(const char *path) { return unlink(resolve(path).c_str()) == 0; }
+    bool rename(const char *from, const char *to) {
+        return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+    }
+};
+
+inline HostFS SPIFFS;
+
+#endif  // HOST_SPIFFS_H
@@ -0,0 +1,199 @@
+/*
+ *  WString.h
+ *
+ *  host stand-in for the Arduino String class, backed by std::string
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifndef DEC
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+#endif
+
+class String {
+private:
+    std::string value;
+
+    static std::string fromInteger(unsigned long long magnitude, bool negative, unsigned char base) {
+        if (base < 2 || base > 36) base = 10;
+        char digits[72];
+        int length = 0;
+        do {
+            int digit = (int) (magnitude % base);
+            digits[length++] = (char) (digit < 10 ? '0' + digit : 'a' + digit - 10);
+            magnitude /= base;
+        } while (magnitude > 0);
+        std::string text = negative ? "-" : "";
+        while (length > 0) text += digits[--length];
+        return text;
+    }
+
+    static std::string fromDouble(double number, unsigned int decimals) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int) decimals, number);
+        return buffer;
+    }
+
+public:
+    String(const char *text = "") : value(text != nullptr ? text : "") {}
+    String(const std::string &text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(unsigned char number, unsigned char base = DEC) : value(fromInteger(number, false, base)) {}
+    explicit String(int number, unsigned char base = DEC)
+            : value(base == DEC ? fromInteger(number < 0 ? -(long long) number : number, number < 0, base)
+                                : fromInteger((unsigned int) number, false, base)) {}
+    explicit String(unsigned int number, unsigned char base = DEC) : value(fromInteger(number, false, base)) {}
+    explicit String(long number, unsigned char base = DEC)
+            : value(base == DEC ? fromInteger(number < 0 ? -(long long) number : number, number < 0, base)
+                                : fromInteger((unsigned long) number, false, base)) {}
+    explicit String(unsigned long number, unsigned char base = DEC) : value(fromInteger(number, false, base)) {}
+    explicit String(float number, unsigned int decimals = 2) : value(fromDouble(number, decimals)) {}
+    explicit String(double number, unsigned int decimals = 2) : value(fromDouble(number, decimals)) {}
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return (unsigned int) value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) {
+        value.reserve(size);
+        return true;
+    }
+
+    char charAt(unsigned int index) const { return index < value.length() ? value[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index) { return value[index]; }
+    void setCharAt(unsigned int index, char c) {
+        if (index < value.length()) value[index] = c;
+    }
+
+    String &operator=(const char *text) {
+        value = text != nullptr ? text : "";
+        return *this;
+    }
+
+    template<typename T>
+    bool concat(const T &other) {
+        *this += other;
+        return true;
+    }
+
+    String &operator+=(const String &other) {
+        value += other.value;
+        return *this;
+    }
+    String &operator+=(const char *text) {
+        if (text != nullptr) value += text;
+        return *this;
+    }
+    String &operator+=(char c) {
+        value += c;
+        return *this;
+    }
+    template<typename T>
+    String &operator+=(T number) {
+        value += String(number).value;
+        return *this;
+    }
+
+    friend String operator+(const String &a, const String &b) { return String(a.value + b.value); }
+    friend String operator+(const String &a, const char *b) { return String(a.value + (b != nullptr ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String((a != nullptr ? a : "") + b.value); }
+    friend String operator+(const String &a, char b) { return String(a.value + b); }
+    template<typename T>
+    friend String operator+(const String &a, T number) { return String(a.value + String(number).value); }
+
+    bool operator==(const String &other) const { return value == other.value; }
+    bool operator==(const char *text) const { return value == (text != nullptr ? text : ""); }
+    bool operator!=(const String &other) const { return value != other.value; }
+    bool operator!=(const char *text) const { return !(*this == text); }
+    bool operator<(const String &other) const { return value < other.value; }
+    bool equals(const String &other) const { return value == other.value; }
+    bool equalsIgnoreCase(const String &other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    int compareTo(const String &other) const { return value.compare(other.value); }
+    bool startsWith(const String &prefix) const { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool endsWith(const String &suffix) const {
+        return value.length() >= suffix.value.length() &&
+               value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t found = value.find(c, from);
+        return found == std::string::npos ? -1 : (int) found;
+    }
+    int indexOf(const String &text, unsigned int from = 0) const {
+        size_t found = value.find(text.value, from);
+        return found == std::string::npos ? -1 : (int) found;
+    }
+    int lastIndexOf(char c) const {
+        size_t found = value.rfind(c);
+        return found == std::string::npos ? -1 : (int) found;
+    }
+    int lastIndexOf(const String &text) const {
+        size_t found = value.rfind(text.value);
+        return found == std::string::npos ? -1 : (int) found;
+    }
+
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            unsigned int swap = from;
+            from = to;
+            to = swap;
+        }
+        if (from >= value.length()) return String();
+        if (to > value.length()) to = length();
+        return String(value.substr(from, to - from));
+    }
+
+    void replace(char find, char with) {
+        for (char &c: value) {
+            if (c == find) c = with;
+        }
+    }
+    void replace(const String &find, const String &with) {
+        if (find.value.empty()) return;
+        size_t position = 0;
+        while ((position = value.find(find.value, position)) != std::string::npos) {
+            value.replace(position, find.value.length(), with.value);
+            position += with.value.length();
+        }
+    }
+    void remove(unsigned int index) { remove(index, length()); }
+    void remove(unsigned int index, unsigned int count) {
+        if (index < value.length()) value.erase(index, count);
+    }
+
+    void toLowerCase() {
+        for (char &c: value) c = (char) tolower((unsigned char) c);
+    }
+    void toUpperCase() {
+        for (char &c: value) c = (char) toupper((unsigned char) c);
+    }
+    void trim() {
+        size_t first = value.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            value.clear();
+            return;
+        }
+        size_t last = value.find_last_not_of(" \t\r\n");
+        value = value.substr(first, last - first + 1);
+    }
+
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float) atof(value.c_str()); }
+    double toDouble() const { return atof(value.c_str()); }
+};
+
+#endif  // HOST_WSTRING_H
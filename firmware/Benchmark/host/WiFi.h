@@ -0,0 +1,61 @@
+/*
+ *  WiFi.h
+ *
+ *  host stand-in for the ESP32 WiFi object, the link is whatever the
+ *  benchmark sets with hostSetStatus()
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class IPAddress {
+private:
+    uint8_t octets[4];
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(text);
+    }
+};
+
+class HostWiFi {
+private:
+    wl_status_t linkStatus;
+    String ssid;
+public:
+    HostWiFi() : linkStatus(WL_CONNECTED), ssid("host") {}
+
+    void hostSetStatus(wl_status_t status) { linkStatus = status; }
+
+    wl_status_t begin(const char *network, const char * = nullptr) {
+        ssid = network;
+        return linkStatus;
+    }
+    bool disconnect(bool = false) { return true; }
+    wl_status_t status() const { return linkStatus; }
+    String SSID() const { return ssid; }
+    IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+    int32_t RSSI() const { return -50; }
+};
+
+inline HostWiFi WiFi;
+
+#endif  // HOST_WIFI_H
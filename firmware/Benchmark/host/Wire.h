@@ -0,0 +1,8 @@
+/*
+ *  Wire.h
+ *
+ *  empty host stand-in, the host build has no Wire bus
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
@@ -0,0 +1,136 @@
+/*
+ *  bench-common.h
+ *
+ *  shared helpers for the host benchmarks
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef HOST_BENCH_COMMON_H
+#define HOST_BENCH_COMMON_H
+
+#include "Arduino.h"
+
+#include <initializer_list>
+
+const int NUTRITION_FEATURES = 8;
+
+const char *const NUTRITION_LABELS[] = {
+        "gizi buruk", "gizi kurang", "gizi baik", "overweight", "obesitas"
+};
+
+/*deterministic generator, every run sees the same dataset*/
+class BenchRandom {
+private:
+    uint32_t state;
+public:
+    explicit BenchRandom(uint32_t seed = 0x1A2B3C4D) : state(seed) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float uniform(float min, float max) {
+        return min + (max - min) * (float) (next() & 0xFFFFFF) / (float) 0xFFFFFF;
+    }
+
+    int range(int min, int max) {
+        return min + (int) (next() % (uint32_t) (max - min + 1));
+    }
+};
+
+/*same feature order as addTrainingDataPoint() in IntanFirmwareR1/KNN.ino*/
+inline const char *makeNutritionSample(BenchRandom &rng, float features[]) {
+    float weight = rng.uniform(14.0f, 35.0f);
+    float height = rng.uniform(100.0f, 130.0f);
+    float imt = weight / ((height / 100.0f) * (height / 100.0f));
+
+    features[0] = (float) rng.range(5, 7);
+    features[1] = (float) rng.range(0, 11);
+    features[2] = (float) rng.range(0, 1);
+    features[3] = weight;
+    features[4] = height;
+    features[5] = imt;
+    features[6] = (float) rng.range(0, 2);
+    features[7] = (float) rng.range(0, 2);
+
+    float noisyImt = imt + rng.uniform(-1.0f, 1.0f);
+    if (noisyImt < 13.0f) return NUTRITION_LABELS[0];
+    if (noisyImt < 14.5f) return NUTRITION_LABELS[1];
+    if (noisyImt < 18.0f) return NUTRITION_LABELS[2];
+    if (noisyImt < 21.0f) return NUTRITION_LABELS[3];
+    return NUTRITION_LABELS[4];
+}
+
+/*
+ * Loads firmware/dataset.csv with the encoding initKNNMethods() uses:
+ * gender, eating pattern and child response as enum indices and IMT
+ * recomputed from weight and height. Returns the number of rows read.
+ */
+inline int loadNutritionDataset(const char *path, float features[][NUTRITION_FEATURES], const char *labels[],
+                                int maxRows) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) return 0;
+
+    char line[256];
+    int rows = 0;
+    fgets(line, sizeof(line), file);
+
+    while (rows < maxRows && fgets(line, sizeof(line), file) != nullptr) {
+        char gender[32], eating[32], response[32], status[32];
+        float ageYears, ageMonths, weight, height, imt;
+        if (sscanf(line, "%f,%f,%31[^,],%f,%f,%f,%31[^,],%31[^,],%31[^\r\n]",
+                   &ageYears, &ageMonths, gender, &weight, &height, &imt, eating, response, status) != 9) {
+            continue;
+        }
+
+        float *row = features[rows];
+        row[0] = ageYears;
+        row[1] = ageMonths;
+        row[2] = (strcmp(gender, "Laki-laki") == 0) ? 1.0f : 0.0f;
+        row[3] = weight;
+        row[4] = height;
+        row[5] = weight / ((height / 100.0f) * (height / 100.0f));
+        row[6] = (strcmp(eating, "Cukup") == 0) ? 1.0f : (strcmp(eating, "Berlebih") == 0) ? 2.0f : 0.0f;
+        row[7] = (strcmp(response, "Sedang") == 0) ? 1.0f : (strcmp(response, "Aktif") == 0) ? 2.0f : 0.0f;
+
+        for (char *c = status; *c != '\0'; c++) {
+            if (*c >= 'A' && *c <= 'Z') *c = (char) (*c - 'A' + 'a');
+        }
+        labels[rows] = nullptr;
+        for (const char *label: NUTRITION_LABELS) {
+            if (strcmp(status, label) == 0) labels[rows] = label;
+        }
+        if (labels[rows] != nullptr) rows++;
+    }
+
+    fclose(file);
+    return rows;
+}
+
+class BenchTimer {
+private:
+    std::chrono::steady_clock::time_point start;
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void reset() {
+        start = std::chrono::steady_clock::now();
+    }
+
+    double elapsedUs() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+/*keeps the optimizer from discarding benchmarked results*/
+template<typename T>
+inline void benchKeep(T const &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif  // HOST_BENCH_COMMON_H
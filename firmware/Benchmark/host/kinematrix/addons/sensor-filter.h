@@ -0,0 +1,9 @@
+/*
+ *  sensor-filter.h
+ *
+ *  the Kinematrix filter addon is not part of this tree and nothing in
+ *  firmware/Libraries uses it yet, this keeps sensor-module.h buildable
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
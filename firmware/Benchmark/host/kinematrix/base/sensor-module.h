@@ -0,0 +1,11 @@
+/*
+ *  sensor-module.h
+ *
+ *  forwards the Kinematrix "base/sensor-module.h" include used by the
+ *  sensor drivers to the flattened copy in firmware/Libraries
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#include "../../../../Libraries/sensor-module.h"
@@ -8,6 +8,8 @@
 #define ENABLE_MODULE_FIREBASE_FIRESTORE_V2
 #define ENABLE_MODULE_SH1106_MENU
 #define ENABLE_MODULE_KNN
+#define ENABLE_MODULE_DECISION_TREE
+#define ENABLE_MODULE_KNN_ENSEMBLE
 
 #define ENABLE_SENSOR_MODULE
 #define ENABLE_SENSOR_MODULE_UTILITY
@@ -20,6 +22,7 @@
 #include "WiFi.h"
 #include "WiFiClientSecure.h"
 #include "HTTPClient.h"
+#include "NutritionModel.h"
 
 #define KG_TO_G(x) x * 1000.f
 #define G_TO_KG(x) x / 1000.f
@@ -38,7 +41,12 @@ WiFiClientSecure wifiSecureClient;
 
 ////////// Sensor Management //////////
 SensorModule sensorManager;
-MovingAverageFilter weightFilter(10);
+SensorHandle rfidSensor = SENSOR_HANDLE_NONE;
+SensorHandle ultrasonicSensor = SENSOR_HANDLE_NONE;
+SensorHandle loadCellSensor = SENSOR_HANDLE_NONE;
+const SensorValue *rfidValue = nullptr;
+const SensorValue *weightValue = nullptr;
+const SensorValue *heightValue = nullptr;
 
 ////////// Communication //////////
 HardSerial serialCommunication;
@@ -93,6 +101,7 @@ enum WeighingFlowState {
   FLOW_WEIGHING,         // Mengirim data berat real-time
   FLOW_HEIGHT,           // Mengirim data tinggi real-time  
   FLOW_CALCULATING,      // Menghitung KNN dan IMT
+  FLOW_SENDING,          // Mengirim hasil akhir ke aplikasi
   FLOW_COMPLETE,         // Selesai, data terkirim
   FLOW_ERROR             // Error state
 };
@@ -188,7 +197,17 @@ enum StatusGizi {
   GIZI_KURANG = 1,
   GIZI_BAIK = 2,
   OVERWEIGHT = 3,
-  OBESITAS = 4
+  OBESITAS = 4,
+  GIZI_ERROR = 5  // the model gave no usable label, never a result to show or store
+};
+
+// Session inputs of the nutrition model, encoded once when the session loads
+struct NutritionProfile {
+  int ageYears;
+  int ageMonths;
+  Gender gender;
+  PolaMakan eatingPattern;
+  ResponAnak childResponse;
 };
 
 ////////// Function Declarations //////////
@@ -205,6 +224,7 @@ volatile bool newSensorData = false;
 ////////// State Machine Variables //////////
 extern WeighingFlowState currentFlowState;
 extern String flowEvent;
+extern String flowConfirmedStatus;
 extern uint32_t lastSensorUpdate;
 extern uint32_t lastEventCheck;
 extern bool flowDataReady;
@@ -219,13 +239,14 @@ struct FlowUserData {
   String gender;
   int ageYears;
   int ageMonths;
+  NutritionProfile nutrition;
 };
 
 struct FlowMeasurementData {
   float weight;
   float height;
   float imt;
-  String nutritionStatus;
+  StatusGizi nutritionStatus;
   bool dataComplete;
 };
 
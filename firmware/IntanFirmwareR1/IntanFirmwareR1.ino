@@ -26,16 +26,25 @@ void loop() {
 }
 
 void initializeSensorModules() {
-  sensorManager.addModule("rfid", new RFID_Mfrc522(5, 27));
-  sensorManager.addModule("ultrasonic", new UltrasonicSens(32, 33, 200, 1, 1, 1000, 10));
-  sensorManager.addModule("loadcell", new HX711Sens(26, 25, HX711Sens::KG, 0.25, 5, 2000, 0.25));
+  sensorManager.reserve(3);
+  rfidSensor = sensorManager.addModule("rfid", new RFID_Mfrc522(5, 27));
+  ultrasonicSensor = sensorManager.addModule("ultrasonic", new UltrasonicSens(32, 33, 200, 1, 1, 1000, 10));
+  loadCellSensor = sensorManager.addModule("loadcell", new HX711Sens(26, 25, HX711Sens::KG, 0.06, 5, 1000, 0.25));
+  rfidValue = sensorManager.getValueHandle(rfidSensor);
+  weightValue = sensorManager.getValueHandle(loadCellSensor);
+  heightValue = sensorManager.getValueHandle(ultrasonicSensor);
+  // windows are in readings: the HX711 at 10 SPS, the ultrasonic every 50 ms
+  sensorManager.getModule<HX711Sens>(loadCellSensor)->pipeline().hampel(7, 3.0).stability(10).ema(0.3);
+  sensorManager.getModule<UltrasonicSens>(ultrasonicSensor)->pipeline().median(5).stability(10);
   sensorManager.init([]() {
-    auto loadCell = sensorManager.getModule<HX711Sens>("loadcell");
+    auto loadCell = sensorManager.getModule<HX711Sens>(loadCellSensor);
     devicePreferences.begin("intan", false);
     float calibrationFactor = devicePreferences.getFloat("calibration", -22.5);
     devicePreferences.end();
     loadCell->setScale(calibrationFactor);
     loadCell->tare();
+    if (!loadCell->beginSampling()) Serial.println("Load cell sampling task failed, polling instead");
+    sensorManager.getModule<UltrasonicSens>(ultrasonicSensor)->beginEchoCapture();
     Serial.printf("Load cell calibration: %.2f\n", calibrationFactor);
   });
 }
@@ -48,13 +57,13 @@ void updateSensorData() {
     newSensorData = true;
   } else {
     sensorManager.update([]() {
-      String newRfidTag = sensorManager["rfid"].as<String>();
-      float rawWeight = sensorManager["loadcell"];
-      float rawHeight = sensorManager["ultrasonic"];
+      char newRfidTag[SENSOR_VALUE_TEXT_CHAR];
+      rfidValue->getText(newRfidTag, sizeof(newRfidTag));
+      float rawWeight = weightValue->getFloat();
+      float rawHeight = heightValue->getFloat();
       rawHeight = SENSOR_HEIGHT_POLE - rawHeight;
       rawHeight = constrain(rawHeight, 0, SENSOR_HEIGHT_POLE);
-      weightFilter.addMeasurement(rawWeight);
-      rawWeight = abs(weightFilter.getFilteredValue());
+      rawWeight = abs(rawWeight);
       rawWeight = rawWeight < 1.0 ? 0.0 : rawWeight;
       currentRfidTag = newRfidTag;
       currentWeight = rawWeight;
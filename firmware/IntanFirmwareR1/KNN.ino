@@ -1,158 +1,223 @@
-KNN nutritionKNN(5, 8, 120);
+const int KNN_TUNE_K_VALUES[] = { 1, 3, 5, 7, 9, 11, 13, 15 };
+const int KNN_TUNE_K_COUNT = sizeof(KNN_TUNE_K_VALUES) / sizeof(KNN_TUNE_K_VALUES[0]);
+const unsigned long KNN_TUNE_DEFAULT_BUDGET_MS = 2000;
+const int KNN_FEATURE_COUNT = 8;
+const int KNN_ONLINE_CAPACITY = 64;
+const int KNN_ONLINE_SAVE_BATCH = 4;
+const unsigned long KNN_ONLINE_SAVE_INTERVAL_MS = 15UL * 60UL * 1000UL;
+const char *KNN_ONLINE_PATH = "/knn-online.bin";
+
+KNN nutritionKNN(5, NUTRITION_MODEL);
+// the tree holds every KNN row, flash and online, so it is sized for a full ring
+DecisionTree nutritionTree(NUTRITION_MODEL.featureCount, NUTRITION_MODEL.dataCount + KNN_ONLINE_CAPACITY);
+KNNEnsemble nutritionEnsemble(nutritionKNN, nutritionTree, KNN_ENSEMBLE_DEFAULT_THRESHOLD);
+
+// last finished weighing, learned once a health worker confirms its status
+float pendingOnlineFeatures[KNN_FEATURE_COUNT];
+bool pendingOnlineSample = false;
+unsigned long lastOnlineSave = 0;
 
 void initKNNMethods() {
   Serial.println("Initializing KNN Nutrition Status Model...");
-  nutritionKNN.setDistanceMetric(EUCLIDEAN);
-  nutritionKNN.setWeightedVoting(true);
+  devicePreferences.begin("intan", false);
+  int k = devicePreferences.getInt("knnK", 5);
+  int metric = devicePreferences.getInt("knnMetric", EUCLIDEAN);
+  bool weighted = devicePreferences.getBool("knnWeighted", true);
+  float featureWeights[KNN_FEATURE_COUNT];
+  bool hasWeights = devicePreferences.getBytesLength("knnWeights") == sizeof(featureWeights)
+                    && devicePreferences.getBytes("knnWeights", featureWeights, sizeof(featureWeights)) == sizeof(featureWeights);
+  devicePreferences.end();
+  if (!nutritionKNN.setK(k)) nutritionKNN.setK(5);
+  nutritionKNN.setDistanceMetric((metric >= 0 && metric < KNN_METRIC_COUNT) ? (DistanceMetric)metric : EUCLIDEAN);
+  nutritionKNN.setWeightedVoting(weighted);
+  if (hasWeights) nutritionKNN.setFeatureWeights(featureWeights);
   nutritionKNN.enableNormalization(true);
-  addNutritionTrainingData();
-  Serial.println("KNN Model initialized with training data");
+  // the index is refused while the flash model holds fewer than KNN_INDEX_MIN_DATA rows
+  if (!nutritionKNN.enableIndex(true)) nutritionKNN.enableFastSearch(true);
+  initOnlineLearning();
+  nutritionKNN.buildIndex();
+  Serial.print("KNN Model initialized from flash, training data: ");
+  Serial.println(nutritionKNN.getDataCount());
+  Serial.printf("KNN config: k=%d, metric=%s, weighted=%s\n", nutritionKNN.getK(),
+                distanceMetricName(nutritionKNN.getDistanceMetric()), nutritionKNN.getWeightedVoting() ? "Yes" : "No");
+  printFeatureWeights();
+  trainDecisionTree();
+}
+
+// The tree answers confident leaves alone, KNN only runs for the mixed ones. It is trained on the KNN's rows,
+// replayed online samples included, and retrained after every learned sample so corrections reach it too.
+void trainDecisionTree() {
+  float features[KNN_FEATURE_COUNT];
+  nutritionTree.clearTrainingData();
+  for (int i = 0; i < nutritionKNN.getDataCount(); i++) {
+    nutritionKNN.getTrainingData(i, features);
+    nutritionTree.addTrainingData(nutritionKNN.getLabel(i), features);
+  }
+  if (!nutritionTree.train(GINI)) {
+    Serial.printf("Decision tree disabled: %s\n", nutritionTree.getErrorMessage());
+    nutritionTree.clearError();
+    return;
+  }
+  Serial.printf("Decision tree trained: %d nodes, depth %d, KNN fallback below %.2f confidence\n",
+                nutritionTree.getNodeCount(), nutritionTree.getDepth(), nutritionEnsemble.getTreeThreshold());
+}
+
+// Confirmed field samples live in a bounded ring after the flash rows, replayed from the journal on boot
+void initOnlineLearning() {
+  if (!SPIFFS.begin(true) || !nutritionKNN.enableOnlineLearning(KNN_ONLINE_CAPACITY, EVICT_CLASS_BALANCE)) {
+    Serial.printf("KNN online learning disabled: %s\n", nutritionKNN.getErrorMessage());
+    nutritionKNN.clearError();
+    return;
+  }
+  if (SPIFFS.exists(KNN_ONLINE_PATH)) {
+    int restored = nutritionKNN.loadOnlineSamples(KNN_ONLINE_PATH);
+    if (restored < 0) {
+      Serial.printf("KNN online samples dropped: %s\n", nutritionKNN.getErrorMessage());
+      nutritionKNN.clearError();
+    } else {
+      Serial.printf("KNN online samples restored: %d/%d\n", restored, KNN_ONLINE_CAPACITY);
+    }
+  }
+  lastOnlineSave = millis();
+}
+
+void stageOnlineSample(const NutritionProfile &profile, float weight, float height) {
+  encodeNutritionFeatures(profile, weight, height, pendingOnlineFeatures);
+  pendingOnlineSample = true;
+}
+
+// Learns the staged weighing under the confirmed status; the journal is delta-saved every few samples.
+// Only the five model labels are accepted as written: a missing, empty or misspelled status would
+// otherwise be learned under some default and replayed from the journal on every boot.
+bool confirmOnlineSample(const String &status) {
+  if (!pendingOnlineSample) {
+    Serial.println("KNN online: no weighing waiting for confirmation");
+    return false;
+  }
+  StatusGizi confirmed = nutritionStatusFromLabel(status.c_str());
+  if (confirmed == GIZI_ERROR) {
+    Serial.printf("KNN online: rejected status \"%s\", weighing still waiting\n", status.c_str());
+    return false;
+  }
+  const char *label = nutritionStatusLabel(confirmed);
+  if (!nutritionKNN.learnOnline(label, pendingOnlineFeatures)) {
+    Serial.printf("KNN online learning failed: %s\n", nutritionKNN.getErrorMessage());
+    nutritionKNN.clearError();
+    return false;
+  }
+  pendingOnlineSample = false;
+  Serial.printf("KNN online: learned %s, %d/%d samples\n", label, nutritionKNN.getOnlineCount(), KNN_ONLINE_CAPACITY);
+  trainDecisionTree();
+  int unsaved = nutritionKNN.getUnsavedOnlineCount();
+  if (unsaved >= KNN_ONLINE_SAVE_BATCH || millis() - lastOnlineSave >= KNN_ONLINE_SAVE_INTERVAL_MS) {
+    saveOnlineSamples();
+  }
+  return true;
+}
+
+void saveOnlineSamples() {
+  int unsaved = nutritionKNN.getUnsavedOnlineCount();
+  if (nutritionKNN.getOnlineCapacity() == 0 || unsaved == 0) return;
+  if (nutritionKNN.saveOnlineSamples(KNN_ONLINE_PATH)) {
+    Serial.printf("KNN online: saved %d changed samples\n", unsaved);
+  } else {
+    Serial.printf("KNN online save failed: %s\n", nutritionKNN.getErrorMessage());
+    nutritionKNN.clearError();
+  }
+  lastOnlineSave = millis();
+}
+
+void printFeatureWeights() {
+  Serial.print("KNN feature weights:");
+  for (int i = 0; i < KNN_FEATURE_COUNT; i++) {
+    Serial.printf(" %.2f", nutritionKNN.getFeatureWeight(i));
+  }
+  Serial.println();
+}
+
+// Leave-one-out search over k, metric, voting and feature weights; the winner is applied and saved to Preferences
+void tuneKNNMethods(unsigned long budgetMs) {
+  KNNLooScore scores[KNN_TUNE_K_COUNT * KNN_METRIC_COUNT * 2];
+  KNNLooScore best;
+  unsigned long startTime = millis();
+  int scoreCount = nutritionKNN.autoTune(KNN_TUNE_K_VALUES, KNN_TUNE_K_COUNT, budgetMs, scores, best);
+  unsigned long elapsed = millis() - startTime;
+  if (scoreCount == 0) {
+    Serial.printf("KNN tuning failed: %s\n", nutritionKNN.getErrorMessage());
+    return;
+  }
+  Serial.println("=== KNN TUNING (leave-one-out) ===");
+  for (int i = 0; i < scoreCount; i++) {
+    Serial.printf("  k=%2d  %-9s  %-10s  %.1f%%\n", scores[i].k, distanceMetricName(scores[i].metric),
+                  scores[i].weightedVoting ? "weighted" : "unweighted", scores[i].accuracy * 100.0);
+  }
+  Serial.printf("Best: k=%d, metric=%s, weighted=%s, accuracy=%.1f%%\n", best.k, distanceMetricName(best.metric),
+                best.weightedVoting ? "Yes" : "No", best.accuracy * 100.0);
+  printFeatureWeights();
+  Serial.printf("Evaluated %d configurations in %lu ms\n", scoreCount, elapsed);
+  Serial.println("==================================");
+  float featureWeights[KNN_FEATURE_COUNT];
+  for (int i = 0; i < KNN_FEATURE_COUNT; i++) {
+    featureWeights[i] = nutritionKNN.getFeatureWeight(i);
+  }
+  devicePreferences.begin("intan", false);
+  devicePreferences.putInt("knnK", nutritionKNN.getK());
+  devicePreferences.putInt("knnMetric", nutritionKNN.getDistanceMetric());
+  devicePreferences.putBool("knnWeighted", nutritionKNN.getWeightedVoting());
+  devicePreferences.putBytes("knnWeights", featureWeights, sizeof(featureWeights));
+  devicePreferences.end();
+}
+
+const char *distanceMetricName(DistanceMetric metric) {
+  switch (metric) {
+    case MANHATTAN:
+      return "MANHATTAN";
+    case COSINE:
+      return "COSINE";
+    case EUCLIDEAN:
+    default:
+      return "EUCLIDEAN";
+  }
 }
 
 String getNutritionStatus(float weight, float height, int ageYears, int ageMonths, String gender, String eatingPattern, String childResponse) {
-  Gender genderEnum = encodeGender(gender);
-  PolaMakan eatingPatternEnum = encodeEatingPattern(eatingPattern);
-  ResponAnak childResponseEnum = encodeChildResponse(childResponse);
-  float imt = calculateIMT(weight, height);
-  float features[] = {
-    (float)ageYears,
-    (float)ageMonths,
-    (float)genderEnum,
-    weight,
-    height,
-    imt,
-    (float)eatingPatternEnum,
-    (float)childResponseEnum
-  };
-  const char *prediction = nutritionKNN.predict(features);
-  float confidence = nutritionKNN.getPredictionConfidence(features);
-  Serial.print("KNN Prediction: ");
-  Serial.print(prediction);
+  NutritionProfile profile = encodeNutritionProfile(ageYears, ageMonths, gender, eatingPattern, childResponse);
+  return nutritionStatusToString(classifyNutritionStatus(profile, weight, height));
+}
+
+// Allocation-free path for the weighing flow: stack features, ensemble vote, label mapped back to the enum
+StatusGizi classifyNutritionStatus(const NutritionProfile &profile, float weight, float height) {
+  float features[KNN_FEATURE_COUNT];
+  encodeNutritionFeatures(profile, weight, height, features);
+  KNNEnsembleResult result;
+  nutritionEnsemble.classify(features, result);
+  Serial.print(result.usedKNN ? "KNN Prediction: " : "Tree Prediction: ");
+  Serial.print(result.label);
   Serial.print(" (confidence: ");
-  Serial.print(confidence * 100.0);
-  Serial.println("%)");
-  return String(prediction);
-}
-
-void addNutritionTrainingData() {
-  Serial.println("Adding nutrition training data from dataset.csv in exact row order...");
-  addTrainingDataPoint(6, 5, PEREMPUAN, 29.6, 110.1, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(5, 0, PEREMPUAN, 20.2, 113.9, KURANG, PASIF, "gizi baik");
-  addTrainingDataPoint(7, 0, PEREMPUAN, 25.8, 110.4, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(6, 6, PEREMPUAN, 28.8, 113.9, KURANG, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 9, PEREMPUAN, 26.8, 109.9, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 3, PEREMPUAN, 23.2, 120.8, CUKUP, PASIF, "gizi baik");
-  addTrainingDataPoint(6, 9, PEREMPUAN, 26.1, 113.9, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(5, 8, PEREMPUAN, 27.2, 129.7, KURANG, AKTIF, "gizi baik");
-  addTrainingDataPoint(5, 11, PEREMPUAN, 32.4, 126.5, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(6, 7, LAKI_LAKI, 15.5, 111.5, KURANG, SEDANG, "gizi buruk");
-  addTrainingDataPoint(6, 3, LAKI_LAKI, 15.0, 108.1, CUKUP, PASIF, "gizi buruk");
-  addTrainingDataPoint(6, 4, LAKI_LAKI, 30.1, 117.8, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 0, PEREMPUAN, 25.2, 129.5, BERLEBIH, PASIF, "gizi baik");
-  addTrainingDataPoint(6, 1, LAKI_LAKI, 23.7, 105.5, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(5, 10, PEREMPUAN, 32.7, 112.2, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(7, 9, LAKI_LAKI, 21.1, 117.0, CUKUP, SEDANG, "gizi baik");
-  addTrainingDataPoint(6, 5, LAKI_LAKI, 17.1, 105.9, KURANG, SEDANG, "gizi baik");
-  addTrainingDataPoint(6, 11, PEREMPUAN, 16.9, 120.6, BERLEBIH, PASIF, "gizi buruk");
-  addTrainingDataPoint(5, 8, LAKI_LAKI, 23.5, 100.8, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 9, PEREMPUAN, 17.1, 121.2, KURANG, PASIF, "gizi buruk");
-  addTrainingDataPoint(6, 10, PEREMPUAN, 30.7, 104.7, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(5, 5, LAKI_LAKI, 31.7, 111.2, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 5, PEREMPUAN, 14.3, 127.5, BERLEBIH, SEDANG, "gizi buruk");
-  addTrainingDataPoint(5, 10, PEREMPUAN, 26.5, 107.4, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(7, 0, LAKI_LAKI, 32.0, 109.0, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 4, PEREMPUAN, 30.5, 125.9, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(7, 6, LAKI_LAKI, 21.1, 103.4, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(5, 11, PEREMPUAN, 16.9, 129.8, BERLEBIH, PASIF, "gizi buruk");
-  addTrainingDataPoint(6, 1, LAKI_LAKI, 20.5, 124.4, BERLEBIH, SEDANG, "gizi kurang");
-  addTrainingDataPoint(6, 9, PEREMPUAN, 25.7, 104.0, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 4, LAKI_LAKI, 20.4, 127.6, KURANG, AKTIF, "gizi buruk");
-  addTrainingDataPoint(5, 6, PEREMPUAN, 32.0, 111.9, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(7, 4, LAKI_LAKI, 31.5, 107.1, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(7, 4, LAKI_LAKI, 29.0, 129.0, KURANG, PASIF, "overweight");
-  addTrainingDataPoint(6, 11, LAKI_LAKI, 26.3, 102.9, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 4, PEREMPUAN, 14.8, 110.7, BERLEBIH, SEDANG, "gizi buruk");
-  addTrainingDataPoint(7, 3, PEREMPUAN, 27.9, 100.9, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 4, PEREMPUAN, 33.1, 101.7, KURANG, SEDANG, "obesitas");
-  addTrainingDataPoint(7, 4, LAKI_LAKI, 23.7, 118.0, BERLEBIH, AKTIF, "overweight");
-  addTrainingDataPoint(6, 3, PEREMPUAN, 26.2, 128.2, BERLEBIH, AKTIF, "gizi baik");
-  addTrainingDataPoint(5, 5, LAKI_LAKI, 32.0, 118.3, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 11, LAKI_LAKI, 30.0, 112.4, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(7, 9, PEREMPUAN, 30.5, 106.7, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(5, 10, LAKI_LAKI, 34.6, 111.7, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(6, 3, PEREMPUAN, 20.2, 116.1, KURANG, AKTIF, "gizi baik");
-  addTrainingDataPoint(6, 4, PEREMPUAN, 30.4, 108.9, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(5, 2, LAKI_LAKI, 21.8, 127.3, KURANG, PASIF, "gizi kurang");
-  addTrainingDataPoint(6, 6, LAKI_LAKI, 26.2, 118.5, CUKUP, PASIF, "overweight");
-  addTrainingDataPoint(7, 2, PEREMPUAN, 33.2, 124.7, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 11, LAKI_LAKI, 32.4, 114.2, BERLEBIH, AKTIF, "obesitas");
-  addTrainingDataPoint(7, 2, PEREMPUAN, 25.1, 123.3, BERLEBIH, SEDANG, "gizi baik");
-  addTrainingDataPoint(7, 11, LAKI_LAKI, 15.5, 122.1, BERLEBIH, PASIF, "gizi buruk");
-  addTrainingDataPoint(5, 4, PEREMPUAN, 19.2, 129.0, KURANG, SEDANG, "gizi buruk");
-  addTrainingDataPoint(7, 3, PEREMPUAN, 27.9, 102.6, KURANG, PASIF, "obesitas");
-  addTrainingDataPoint(6, 0, LAKI_LAKI, 31.0, 100.8, CUKUP, AKTIF, "obesitas");
-  addTrainingDataPoint(7, 2, LAKI_LAKI, 30.9, 103.4, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(5, 5, LAKI_LAKI, 29.1, 127.3, BERLEBIH, AKTIF, "overweight");
-  addTrainingDataPoint(7, 0, PEREMPUAN, 22.6, 108.5, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(7, 7, LAKI_LAKI, 29.3, 105.2, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(5, 3, PEREMPUAN, 21.7, 125.6, BERLEBIH, AKTIF, "gizi kurang");
-  addTrainingDataPoint(6, 3, PEREMPUAN, 33.7, 107.8, BERLEBIH, SEDANG, "obesitas");
-  addTrainingDataPoint(5, 9, PEREMPUAN, 17.2, 109.4, BERLEBIH, SEDANG, "gizi kurang");
-  addTrainingDataPoint(7, 5, LAKI_LAKI, 22.7, 121.5, BERLEBIH, PASIF, "gizi baik");
-  addTrainingDataPoint(6, 6, PEREMPUAN, 15.1, 122.0, CUKUP, PASIF, "gizi buruk");
-  addTrainingDataPoint(5, 10, LAKI_LAKI, 19.9, 106.7, KURANG, SEDANG, "overweight");
-  addTrainingDataPoint(5, 11, LAKI_LAKI, 27.5, 123.6, CUKUP, SEDANG, "overweight");
-  addTrainingDataPoint(5, 0, LAKI_LAKI, 21.4, 119.7, KURANG, AKTIF, "gizi baik");
-  addTrainingDataPoint(6, 6, LAKI_LAKI, 31.6, 124.4, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(7, 5, PEREMPUAN, 34.5, 113.3, KURANG, AKTIF, "obesitas");
-  addTrainingDataPoint(6, 7, PEREMPUAN, 27.4, 121.0, BERLEBIH, AKTIF, "overweight");
-  addTrainingDataPoint(6, 10, PEREMPUAN, 19.6, 129.3, CUKUP, AKTIF, "gizi buruk");
-  addTrainingDataPoint(6, 10, LAKI_LAKI, 32.9, 108.0, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(7, 5, PEREMPUAN, 24.8, 127.3, CUKUP, AKTIF, "gizi baik");
-  addTrainingDataPoint(5, 2, PEREMPUAN, 25.8, 117.9, CUKUP, SEDANG, "overweight");
-  addTrainingDataPoint(7, 2, LAKI_LAKI, 15.5, 116.9, KURANG, PASIF, "gizi buruk");
-  addTrainingDataPoint(5, 1, LAKI_LAKI, 33.5, 106.5, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(7, 0, LAKI_LAKI, 15.5, 127.0, KURANG, AKTIF, "gizi buruk");
-  addTrainingDataPoint(5, 0, LAKI_LAKI, 14.2, 107.0, KURANG, PASIF, "gizi buruk");
-  addTrainingDataPoint(7, 9, PEREMPUAN, 33.2, 127.8, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(5, 3, LAKI_LAKI, 25.2, 116.0, KURANG, PASIF, "overweight");
-  addTrainingDataPoint(6, 0, LAKI_LAKI, 19.2, 109.0, KURANG, SEDANG, "gizi baik");
-  addTrainingDataPoint(6, 4, LAKI_LAKI, 18.8, 120.2, KURANG, SEDANG, "gizi kurang");
-  addTrainingDataPoint(7, 0, LAKI_LAKI, 19.4, 109.3, KURANG, SEDANG, "gizi baik");
-  addTrainingDataPoint(6, 6, LAKI_LAKI, 29.2, 121.1, CUKUP, SEDANG, "obesitas");
-  addTrainingDataPoint(7, 9, LAKI_LAKI, 33.1, 103.9, CUKUP, PASIF, "obesitas");
-  addTrainingDataPoint(5, 3, LAKI_LAKI, 19.9, 108.2, KURANG, SEDANG, "overweight");
-  addTrainingDataPoint(5, 9, PEREMPUAN, 26.5, 123.6, BERLEBIH, PASIF, "overweight");
-  addTrainingDataPoint(6, 11, LAKI_LAKI, 20.0, 124.1, CUKUP, PASIF, "gizi kurang");
-  addTrainingDataPoint(6, 7, LAKI_LAKI, 19.9, 103.2, CUKUP, PASIF, "overweight");
-  addTrainingDataPoint(5, 8, PEREMPUAN, 26.4, 126.4, BERLEBIH, PASIF, "gizi baik");
-  addTrainingDataPoint(7, 8, LAKI_LAKI, 28.5, 108.1, BERLEBIH, PASIF, "obesitas");
-  addTrainingDataPoint(7, 8, LAKI_LAKI, 15.0, 101.2, BERLEBIH, PASIF, "gizi baik");
-  addTrainingDataPoint(7, 11, LAKI_LAKI, 26.2, 119.9, KURANG, SEDANG, "overweight");
-  addTrainingDataPoint(6, 9, LAKI_LAKI, 21.0, 123.2, CUKUP, AKTIF, "gizi kurang");
-  addTrainingDataPoint(5, 7, LAKI_LAKI, 25.2, 115.3, KURANG, SEDANG, "obesitas");
-  addTrainingDataPoint(7, 8, LAKI_LAKI, 17.9, 123.3, CUKUP, AKTIF, "gizi buruk");
-  addTrainingDataPoint(6, 4, PEREMPUAN, 21.0, 126.5, BERLEBIH, SEDANG, "gizi buruk");
-  addTrainingDataPoint(6, 7, LAKI_LAKI, 25.4, 120.4, KURANG, SEDANG, "overweight");
-  addTrainingDataPoint(5, 10, PEREMPUAN, 30.2, 125.6, KURANG, SEDANG, "obesitas");
-  addTrainingDataPoint(6, 6, LAKI_LAKI, 16.3, 106.5, CUKUP, PASIF, "gizi kurang");
-  Serial.print("Total training data added: ");
-  Serial.println(nutritionKNN.getDataCount());
+  Serial.print(result.confidence * 100.0);
+  Serial.printf("%%, %lu us)\n", result.latencyUs);
+  return nutritionStatusFromLabel(result.label);
+}
+
+NutritionProfile encodeNutritionProfile(int ageYears, int ageMonths, const String &gender, const String &eatingPattern, const String &childResponse) {
+  NutritionProfile profile;
+  profile.ageYears = ageYears;
+  profile.ageMonths = ageMonths;
+  profile.gender = encodeGender(gender);
+  profile.eatingPattern = encodeEatingPattern(eatingPattern);
+  profile.childResponse = encodeChildResponse(childResponse);
+  return profile;
 }
 
-void addTrainingDataPoint(int ageYears, int ageMonths, Gender gender, float weight, float height, PolaMakan eatingPattern, ResponAnak childResponse, const char *statusGizi) {
-  float imt = calculateIMT(weight, height);
-  float features[] = {
-    (float)ageYears,
-    (float)ageMonths,
-    (float)gender,
-    weight,
-    height,
-    imt,
-    (float)eatingPattern,
-    (float)childResponse
-  };
-  nutritionKNN.addTrainingData(statusGizi, features);
+void encodeNutritionFeatures(const NutritionProfile &profile, float weight, float height, float features[]) {
+  features[0] = (float)profile.ageYears;
+  features[1] = (float)profile.ageMonths;
+  features[2] = (float)profile.gender;
+  features[3] = weight;
+  features[4] = height;
+  features[5] = calculateIMT(weight, height);
+  features[6] = (float)profile.eatingPattern;
+  features[7] = (float)profile.childResponse;
 }
 
 float calculateIMT(float weight, float height) {
@@ -161,21 +226,21 @@ float calculateIMT(float weight, float height) {
   return weight / (heightInMeters * heightInMeters);
 }
 
-Gender encodeGender(String gender) {
+Gender encodeGender(const String &gender) {
   if (gender.equals("male") || gender.equals("laki-laki") || gender.equals("Laki-laki") || gender.equals("L")) {
     return LAKI_LAKI;
   }
   return PEREMPUAN;
 }
 
-PolaMakan encodeEatingPattern(String pattern) {
+PolaMakan encodeEatingPattern(const String &pattern) {
   if (pattern.equals("kurang") || pattern.equals("Kurang")) return KURANG;
   if (pattern.equals("cukup") || pattern.equals("Cukup")) return CUKUP;
   if (pattern.equals("berlebih") || pattern.equals("Berlebih")) return BERLEBIH;
   return CUKUP;
 }
 
-ResponAnak encodeChildResponse(String response) {
+ResponAnak encodeChildResponse(const String &response) {
   if (response.equals("pasif") || response.equals("Pasif")) return PASIF;
   if (response.equals("sedang") || response.equals("Sedang")) return SEDANG;
   if (response.equals("aktif") || response.equals("Aktif")) return AKTIF;
@@ -191,19 +256,23 @@ StatusGizi encodeNutritionStatus(String status) {
   return GIZI_BAIK;
 }
 
-String nutritionStatusToString(StatusGizi status) {
-  switch (status) {
-    case GIZI_BURUK:
-      return "gizi buruk";
-    case GIZI_KURANG:
-      return "gizi kurang";
-    case GIZI_BAIK:
-      return "gizi baik";
-    case OVERWEIGHT:
-      return "overweight";
-    case OBESITAS:
-      return "obesitas";
-    default:
-      return "gizi baik";
+// Indexed by StatusGizi, spelled like the model labels
+const char *const NUTRITION_STATUS_LABELS[] = { "gizi buruk", "gizi kurang", "gizi baik", "overweight", "obesitas" };
+const int NUTRITION_STATUS_COUNT = sizeof(NUTRITION_STATUS_LABELS) / sizeof(NUTRITION_STATUS_LABELS[0]);
+
+// GIZI_ERROR reads as "ERROR", the label the model reports when it fails
+const char *nutritionStatusLabel(StatusGizi status) {
+  if (status < 0 || status >= NUTRITION_STATUS_COUNT) return "ERROR";
+  return NUTRITION_STATUS_LABELS[status];
+}
+
+StatusGizi nutritionStatusFromLabel(const char *label) {
+  for (int i = 0; i < NUTRITION_STATUS_COUNT; i++) {
+    if (strcmp(label, NUTRITION_STATUS_LABELS[i]) == 0) return (StatusGizi)i;
   }
-}
\ No newline at end of file
+  return GIZI_ERROR;
+}
+
+String nutritionStatusToString(StatusGizi status) {
+  return String(nutritionStatusLabel(status));
+}
@@ -262,7 +262,7 @@ void displayAdminScreen() {
 }
 
 void performLoadCellCalibration() {
-  auto loadCell = sensorManager.getModule<HX711Sens>("loadcell");
+  auto loadCell = sensorManager.getModule<HX711Sens>(loadCellSensor);
   const char *step1Lines[] = { "KALIBRASI", "LEPAS SEMUA OBJEK", "DARI TIMBANGAN" };
   displayMenu.renderBoxedText(step1Lines, 3);
   loadCell->setScaleDelay(5000);
@@ -282,7 +282,7 @@ void performLoadCellCalibration() {
 }
 
 void performLoadCellTare() {
-  auto loadCell = sensorManager.getModule<HX711Sens>("loadcell");
+  auto loadCell = sensorManager.getModule<HX711Sens>(loadCellSensor);
   loadCell->tare();
   displayMenu.renderStatusScreen("TARE", "BERHASIL", true);
   delay(2000);
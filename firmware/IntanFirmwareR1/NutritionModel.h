@@ -0,0 +1,246 @@
+/*
+ *  NutritionModel.h
+ *
+ *  KNN model generated by KNNModelTool from dataset.csv, do not edit
+ *  100 rows, 8 features, 5 classes
+ */
+
+#pragma once
+
+#ifndef NUTRITION_MODEL_H
+#define NUTRITION_MODEL_H
+
+#include "KNN.h"
+
+alignas(KNN_STORE_ALIGNMENT) const float NUTRITION_MODEL_FEATURES[100 * 8] PROGMEM = {
+        6.0f, 5.0f, 0.0f, 29.6000004f, 110.099998f, 24.418396f, 1.0f, 0.0f,
+        5.0f, 0.0f, 0.0f, 20.2000008f, 113.900002f, 15.5705481f, 0.0f, 0.0f,
+        7.0f, 0.0f, 0.0f, 25.7999992f, 110.400002f, 21.1680851f, 2.0f, 0.0f,
+        6.0f, 6.0f, 0.0f, 28.7999992f, 113.900002f, 22.1995926f, 0.0f, 1.0f,
+        6.0f, 9.0f, 0.0f, 26.7999992f, 109.900002f, 22.189085f, 1.0f, 1.0f,
+        6.0f, 3.0f, 0.0f, 23.2000008f, 120.800003f, 15.8984241f, 1.0f, 0.0f,
+        6.0f, 9.0f, 0.0f, 26.1000004f, 113.900002f, 20.1183815f, 2.0f, 1.0f,
+        5.0f, 8.0f, 0.0f, 27.2000008f, 129.699997f, 16.1692181f, 0.0f, 2.0f,
+        5.0f, 11.0f, 0.0f, 32.4000015f, 126.5f, 20.2471542f, 2.0f, 0.0f,
+        6.0f, 7.0f, 1.0f, 15.5f, 111.5f, 12.4675741f, 0.0f, 1.0f,
+        6.0f, 3.0f, 1.0f, 15.0f, 108.099998f, 12.8363008f, 1.0f, 0.0f,
+        6.0f, 4.0f, 1.0f, 30.1000004f, 117.800003f, 21.6908169f, 2.0f, 1.0f,
+        6.0f, 0.0f, 0.0f, 25.2000008f, 129.5f, 15.0266113f, 2.0f, 0.0f,
+        6.0f, 1.0f, 1.0f, 23.7000008f, 105.5f, 21.2933254f, 0.0f, 2.0f,
+        5.0f, 10.0f, 0.0f, 32.7000008f, 112.199997f, 25.9753895f, 1.0f, 0.0f,
+        7.0f, 9.0f, 1.0f, 21.1000004f, 117.0f, 15.4138365f, 1.0f, 1.0f,
+        6.0f, 5.0f, 1.0f, 17.1000004f, 105.900002f, 15.247694f, 0.0f, 1.0f,
+        6.0f, 11.0f, 0.0f, 16.8999996f, 120.599998f, 11.6196241f, 2.0f, 0.0f,
+        5.0f, 8.0f, 1.0f, 23.5f, 100.800003f, 23.1284637f, 2.0f, 2.0f,
+        6.0f, 9.0f, 0.0f, 17.1000004f, 121.199997f, 11.6410151f, 0.0f, 0.0f,
+        6.0f, 10.0f, 0.0f, 30.7000008f, 104.699997f, 28.0056133f, 2.0f, 2.0f,
+        5.0f, 5.0f, 1.0f, 31.7000008f, 111.199997f, 25.6359673f, 0.0f, 2.0f,
+        6.0f, 5.0f, 0.0f, 14.3000002f, 127.5f, 8.79661751f, 2.0f, 1.0f,
+        5.0f, 10.0f, 0.0f, 26.5f, 107.400002f, 22.9740372f, 0.0f, 2.0f,
+        7.0f, 0.0f, 1.0f, 32.0f, 109.0f, 26.9337578f, 2.0f, 1.0f,
+        6.0f, 4.0f, 0.0f, 30.5f, 125.900002f, 19.2419186f, 0.0f, 2.0f,
+        7.0f, 6.0f, 1.0f, 21.1000004f, 103.400002f, 19.7351933f, 1.0f, 0.0f,
+        5.0f, 11.0f, 0.0f, 16.8999996f, 129.800003f, 10.0308399f, 2.0f, 0.0f,
+        6.0f, 1.0f, 1.0f, 20.5f, 124.400002f, 13.2468653f, 2.0f, 1.0f,
+        6.0f, 9.0f, 0.0f, 25.7000008f, 104.0f, 23.761097f, 2.0f, 2.0f,
+        6.0f, 4.0f, 1.0f, 20.3999996f, 127.599998f, 12.529357f, 0.0f, 2.0f,
+        5.0f, 6.0f, 0.0f, 32.0f, 111.900002f, 25.5558205f, 1.0f, 0.0f,
+        7.0f, 4.0f, 1.0f, 31.5f, 107.099998f, 27.4619656f, 2.0f, 1.0f,
+        7.0f, 4.0f, 1.0f, 29.0f, 129.0f, 17.4268379f, 0.0f, 0.0f,
+        6.0f, 11.0f, 1.0f, 26.2999992f, 102.900002f, 24.8384762f, 2.0f, 1.0f,
+        6.0f, 4.0f, 0.0f, 14.8000002f, 110.699997f, 12.0772066f, 2.0f, 1.0f,
+        7.0f, 3.0f, 0.0f, 27.8999996f, 100.900002f, 27.4044971f, 0.0f, 2.0f,
+        6.0f, 4.0f, 0.0f, 33.0999985f, 101.699997f, 32.0026627f, 0.0f, 1.0f,
+        7.0f, 4.0f, 1.0f, 23.7000008f, 118.0f, 17.0209732f, 2.0f, 2.0f,
+        6.0f, 3.0f, 0.0f, 26.2000008f, 128.199997f, 15.9413576f, 2.0f, 2.0f,
+        5.0f, 5.0f, 1.0f, 32.0f, 118.300003f, 22.8654861f, 2.0f, 2.0f,
+        6.0f, 11.0f, 1.0f, 30.0f, 112.400002f, 23.7458973f, 2.0f, 2.0f,
+        7.0f, 9.0f, 0.0f, 30.5f, 106.699997f, 26.7898998f, 1.0f, 0.0f,
+        5.0f, 10.0f, 1.0f, 34.5999985f, 111.699997f, 27.7312679f, 2.0f, 0.0f,
+        6.0f, 3.0f, 0.0f, 20.2000008f, 116.099998f, 14.986042f, 0.0f, 2.0f,
+        6.0f, 4.0f, 0.0f, 30.3999996f, 108.900002f, 25.6340866f, 2.0f, 1.0f,
+        5.0f, 2.0f, 1.0f, 21.7999992f, 127.300003f, 13.4523964f, 0.0f, 0.0f,
+        6.0f, 6.0f, 1.0f, 26.2000008f, 118.5f, 18.65798f, 1.0f, 0.0f,
+        7.0f, 2.0f, 0.0f, 33.2000008f, 124.699997f, 21.3503609f, 1.0f, 1.0f,
+        6.0f, 11.0f, 1.0f, 32.4000015f, 114.199997f, 24.843504f, 2.0f, 2.0f,
+        7.0f, 2.0f, 0.0f, 25.1000004f, 123.300003f, 16.5100193f, 2.0f, 1.0f,
+        7.0f, 11.0f, 1.0f, 15.5f, 122.099998f, 10.3968172f, 2.0f, 0.0f,
+        5.0f, 4.0f, 0.0f, 19.2000008f, 129.0f, 11.5377693f, 0.0f, 1.0f,
+        7.0f, 3.0f, 0.0f, 27.8999996f, 102.599998f, 26.5038795f, 0.0f, 0.0f,
+        6.0f, 0.0f, 1.0f, 31.0f, 100.800003f, 30.5098877f, 1.0f, 2.0f,
+        7.0f, 2.0f, 1.0f, 30.8999996f, 103.400002f, 28.9013004f, 1.0f, 1.0f,
+        5.0f, 5.0f, 1.0f, 29.1000004f, 127.300003f, 17.957098f, 2.0f, 2.0f,
+        7.0f, 0.0f, 0.0f, 22.6000004f, 108.5f, 19.1976871f, 2.0f, 0.0f,
+        7.0f, 7.0f, 1.0f, 29.2999992f, 105.199997f, 26.4750118f, 1.0f, 1.0f,
+        5.0f, 3.0f, 0.0f, 21.7000008f, 125.599998f, 13.7556286f, 2.0f, 2.0f,
+        6.0f, 3.0f, 0.0f, 33.7000008f, 107.800003f, 28.9996223f, 2.0f, 1.0f,
+        5.0f, 9.0f, 0.0f, 17.2000008f, 109.400002f, 14.3712263f, 2.0f, 1.0f,
+        7.0f, 5.0f, 1.0f, 22.7000008f, 121.5f, 15.377059f, 2.0f, 0.0f,
+        6.0f, 6.0f, 0.0f, 15.1000004f, 122.0f, 10.1451216f, 1.0f, 0.0f,
+        5.0f, 10.0f, 1.0f, 19.8999996f, 106.699997f, 17.479311f, 0.0f, 1.0f,
+        5.0f, 11.0f, 1.0f, 27.5f, 123.599998f, 18.0009651f, 1.0f, 1.0f,
+        5.0f, 0.0f, 1.0f, 21.3999996f, 119.699997f, 14.9356947f, 0.0f, 2.0f,
+        6.0f, 6.0f, 1.0f, 31.6000004f, 124.400002f, 20.4195595f, 1.0f, 1.0f,
+        7.0f, 5.0f, 0.0f, 34.5f, 113.300003f, 26.8756676f, 0.0f, 2.0f,
+        6.0f, 7.0f, 0.0f, 27.3999996f, 121.0f, 18.7145672f, 2.0f, 2.0f,
+        6.0f, 10.0f, 0.0f, 19.6000004f, 129.300003f, 11.723547f, 1.0f, 2.0f,
+        6.0f, 10.0f, 1.0f, 32.9000015f, 108.0f, 28.2064476f, 2.0f, 0.0f,
+        7.0f, 5.0f, 0.0f, 24.7999992f, 127.300003f, 15.3036432f, 1.0f, 2.0f,
+        5.0f, 2.0f, 0.0f, 25.7999992f, 117.900002f, 18.5606041f, 1.0f, 1.0f,
+        7.0f, 2.0f, 1.0f, 15.5f, 116.900002f, 11.3423395f, 0.0f, 0.0f,
+        5.0f, 1.0f, 1.0f, 33.5f, 106.5f, 29.5355835f, 2.0f, 0.0f,
+        7.0f, 0.0f, 1.0f, 15.5f, 127.0f, 9.61001968f, 0.0f, 2.0f,
+        5.0f, 0.0f, 1.0f, 14.1999998f, 107.0f, 12.4028292f, 0.0f, 0.0f,
+        7.0f, 9.0f, 0.0f, 33.2000008f, 127.800003f, 20.3271446f, 1.0f, 0.0f,
+        5.0f, 3.0f, 1.0f, 25.2000008f, 116.0f, 18.7277069f, 0.0f, 0.0f,
+        6.0f, 0.0f, 1.0f, 19.2000008f, 109.0f, 16.1602554f, 0.0f, 1.0f,
+        6.0f, 4.0f, 1.0f, 18.7999992f, 120.199997f, 13.0121441f, 0.0f, 1.0f,
+        7.0f, 0.0f, 1.0f, 19.3999996f, 109.300003f, 16.2390785f, 0.0f, 1.0f,
+        6.0f, 6.0f, 1.0f, 29.2000008f, 121.099998f, 19.9110699f, 1.0f, 1.0f,
+        7.0f, 9.0f, 1.0f, 33.0999985f, 103.900002f, 30.6617432f, 1.0f, 0.0f,
+        5.0f, 3.0f, 1.0f, 19.8999996f, 108.199997f, 16.9980278f, 0.0f, 1.0f,
+        5.0f, 9.0f, 0.0f, 26.5f, 123.599998f, 17.346384f, 2.0f, 0.0f,
+        6.0f, 11.0f, 1.0f, 20.0f, 124.099998f, 12.9863319f, 1.0f, 0.0f,
+        6.0f, 7.0f, 1.0f, 19.8999996f, 103.199997f, 18.6850262f, 1.0f, 0.0f,
+        5.0f, 8.0f, 0.0f, 26.3999996f, 126.400002f, 16.5237923f, 2.0f, 0.0f,
+        7.0f, 8.0f, 1.0f, 28.5f, 108.099998f, 24.3889713f, 2.0f, 0.0f,
+        7.0f, 8.0f, 1.0f, 15.0f, 101.199997f, 14.6463785f, 2.0f, 0.0f,
+        7.0f, 11.0f, 1.0f, 26.2000008f, 119.900002f, 18.2248077f, 0.0f, 1.0f,
+        6.0f, 9.0f, 1.0f, 21.0f, 123.199997f, 13.835597f, 1.0f, 2.0f,
+        5.0f, 7.0f, 1.0f, 25.2000008f, 115.300003f, 18.9557915f, 0.0f, 1.0f,
+        7.0f, 8.0f, 1.0f, 17.8999996f, 123.300003f, 11.7740765f, 1.0f, 2.0f,
+        6.0f, 4.0f, 0.0f, 21.0f, 126.5f, 13.1231546f, 2.0f, 1.0f,
+        6.0f, 7.0f, 1.0f, 25.3999996f, 120.400002f, 17.5218811f, 0.0f, 1.0f,
+        5.0f, 10.0f, 0.0f, 30.2000008f, 125.599998f, 19.1437778f, 0.0f, 1.0f,
+        6.0f, 6.0f, 1.0f, 16.2999992f, 106.5f, 14.3710442f, 1.0f, 0.0f,
+};
+
+alignas(KNN_STORE_ALIGNMENT) const float NUTRITION_MODEL_PREPARED[100 * 8] PROGMEM = {
+        0.5f, 0.454545468f, 0.0f, 0.754902065f, 0.320689499f, 0.673177123f, 0.5f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.294117719f, 0.451724082f, 0.291903704f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 0.568627477f, 0.331034422f, 0.533114016f, 1.0f, 0.0f,
+        0.5f, 0.545454562f, 0.0f, 0.715686321f, 0.451724082f, 0.577563941f, 0.0f, 0.5f,
+        0.5f, 0.818181872f, 0.0f, 0.617647111f, 0.313793063f, 0.577111185f, 0.5f, 0.5f,
+        0.5f, 0.272727281f, 0.0f, 0.441176564f, 0.689655185f, 0.306032628f, 0.5f, 0.0f,
+        0.5f, 0.818181872f, 0.0f, 0.583333433f, 0.451724082f, 0.487879962f, 1.0f, 0.5f,
+        0.0f, 0.727272749f, 0.0f, 0.637255013f, 0.996551514f, 0.317701727f, 0.0f, 1.0f,
+        0.0f, 1.0f, 0.0f, 0.892156959f, 0.886206806f, 0.493429065f, 1.0f, 0.0f,
+        0.5f, 0.636363626f, 1.0f, 0.0637255087f, 0.368965417f, 0.158189669f, 0.0f, 0.5f,
+        0.5f, 0.272727281f, 1.0f, 0.0392156988f, 0.251723975f, 0.174078926f, 0.5f, 0.0f,
+        0.5f, 0.363636374f, 1.0f, 0.779411852f, 0.586206913f, 0.555639684f, 1.0f, 0.5f,
+        0.5f, 0.0f, 0.0f, 0.539215803f, 0.989655077f, 0.268464267f, 1.0f, 0.0f,
+        0.5f, 0.0909090936f, 1.0f, 0.465686351f, 0.162068859f, 0.538510919f, 0.0f, 1.0f,
+        0.0f, 0.909090936f, 0.0f, 0.906862855f, 0.393103242f, 0.740271449f, 0.5f, 0.0f,
+        1.0f, 0.818181872f, 1.0f, 0.338235348f, 0.558620572f, 0.285150677f, 0.5f, 0.5f,
+        0.5f, 0.454545468f, 1.0f, 0.142156899f, 0.175862014f, 0.277991205f, 0.0f, 0.5f,
+        0.5f, 1.0f, 0.0f, 0.132352948f, 0.682758451f, 0.121649623f, 1.0f, 0.0f,
+        0.0f, 0.727272749f, 1.0f, 0.4558824f, 0.0f, 0.617591083f, 1.0f, 1.0f,
+        0.5f, 0.818181872f, 0.0f, 0.142156899f, 0.703448057f, 0.122571409f, 0.0f, 0.0f,
+        0.5f, 0.909090936f, 0.0f, 0.808823586f, 0.134482548f, 0.827758312f, 1.0f, 1.0f,
+        0.0f, 0.454545468f, 1.0f, 0.85784322f, 0.358620465f, 0.725645006f, 0.0f, 1.0f,
+        0.5f, 0.454545468f, 0.0f, 0.00490198005f, 0.920689523f, 0.0f, 1.0f, 0.5f,
+        0.0f, 0.909090936f, 0.0f, 0.602941215f, 0.22758615f, 0.610936522f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.872549057f, 0.282758504f, 0.78156966f, 1.0f, 0.5f,
+        0.5f, 0.363636374f, 0.0f, 0.799019635f, 0.865517199f, 0.45011121f, 0.0f, 1.0f,
+        1.0f, 0.545454562f, 1.0f, 0.338235348f, 0.0896551162f, 0.471367538f, 0.5f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.132352948f, 1.0f, 0.0531853847f, 1.0f, 0.0f,
+        0.5f, 0.0909090936f, 1.0f, 0.308823556f, 0.813793063f, 0.19177106f, 1.0f, 0.5f,
+        0.5f, 0.818181872f, 0.0f, 0.563725591f, 0.110344723f, 0.644852638f, 1.0f, 1.0f,
+        0.5f, 0.363636374f, 1.0f, 0.30392158f, 0.924137771f, 0.16085203f, 0.0f, 1.0f,
+        0.0f, 0.545454562f, 0.0f, 0.872549057f, 0.382758558f, 0.722191274f, 0.5f, 0.0f,
+        1.0f, 0.363636374f, 1.0f, 0.848039269f, 0.217241228f, 0.804331303f, 1.0f, 0.5f,
+        1.0f, 0.363636374f, 1.0f, 0.725490272f, 0.972413659f, 0.371895373f, 0.0f, 0.0f,
+        0.5f, 1.0f, 1.0f, 0.593137264f, 0.0724137425f, 0.691279292f, 1.0f, 0.5f,
+        0.5f, 0.363636374f, 0.0f, 0.0294117853f, 0.341379106f, 0.141367868f, 1.0f, 0.5f,
+        1.0f, 0.272727281f, 0.0f, 0.671568692f, 0.00344822323f, 0.801854849f, 0.0f, 1.0f,
+        0.5f, 0.363636374f, 0.0f, 0.926470578f, 0.0310342722f, 1.0f, 0.0f, 0.5f,
+        1.0f, 0.363636374f, 1.0f, 0.465686351f, 0.593103349f, 0.354405761f, 1.0f, 1.0f,
+        0.5f, 0.272727281f, 0.0f, 0.588235378f, 0.944827378f, 0.307882726f, 1.0f, 1.0f,
+        0.0f, 0.454545468f, 1.0f, 0.872549057f, 0.603448272f, 0.60625881f, 1.0f, 1.0f,
+        0.5f, 1.0f, 1.0f, 0.774509907f, 0.399999946f, 0.644197643f, 1.0f, 1.0f,
+        1.0f, 0.818181872f, 0.0f, 0.799019635f, 0.203448072f, 0.775370479f, 0.5f, 0.0f,
+        0.0f, 0.909090936f, 1.0f, 1.0f, 0.375861853f, 0.815936148f, 1.0f, 0.0f,
+        0.5f, 0.272727281f, 0.0f, 0.294117719f, 0.527586043f, 0.266716063f, 0.0f, 1.0f,
+        0.5f, 0.363636374f, 0.0f, 0.794117749f, 0.279310286f, 0.725563943f, 1.0f, 0.5f,
+        0.0f, 0.181818187f, 1.0f, 0.372549027f, 0.913793087f, 0.200627849f, 0.0f, 0.0f,
+        0.5f, 0.545454562f, 1.0f, 0.588235378f, 0.610344708f, 0.424948007f, 0.5f, 0.0f,
+        1.0f, 0.181818187f, 0.0f, 0.931372643f, 0.824137747f, 0.540968657f, 0.5f, 0.5f,
+        0.5f, 1.0f, 1.0f, 0.892156959f, 0.462068766f, 0.691495955f, 1.0f, 1.0f,
+        1.0f, 0.181818187f, 0.0f, 0.534313798f, 0.775862038f, 0.332387626f, 1.0f, 0.5f,
+        1.0f, 1.0f, 1.0f, 0.0637255087f, 0.734482586f, 0.0689561591f, 1.0f, 0.0f,
+        0.0f, 0.363636374f, 0.0f, 0.245098114f, 0.972413659f, 0.118122317f, 0.0f, 0.5f,
+        1.0f, 0.272727281f, 0.0f, 0.671568692f, 0.0620688088f, 0.763045251f, 0.0f, 0.0f,
+        0.5f, 0.0f, 1.0f, 0.823529422f, 0.0f, 0.935673058f, 0.5f, 1.0f,
+        1.0f, 0.181818187f, 1.0f, 0.818627536f, 0.0896551162f, 0.866355419f, 0.5f, 0.5f,
+        0.0f, 0.454545468f, 1.0f, 0.730392277f, 0.913793087f, 0.394745439f, 1.0f, 1.0f,
+        1.0f, 0.0f, 0.0f, 0.411764771f, 0.265517145f, 0.448205203f, 1.0f, 0.0f,
+        1.0f, 0.636363626f, 1.0f, 0.740196109f, 0.151723921f, 0.761801302f, 0.5f, 0.5f,
+        0.0f, 0.272727281f, 0.0f, 0.367647141f, 0.855172276f, 0.213694796f, 1.0f, 1.0f,
+        0.5f, 0.272727281f, 0.0f, 0.95588243f, 0.241379306f, 0.870592356f, 1.0f, 0.5f,
+        0.0f, 0.818181872f, 0.0f, 0.147058889f, 0.296551675f, 0.240222275f, 1.0f, 0.5f,
+        1.0f, 0.454545468f, 1.0f, 0.416666746f, 0.71379298f, 0.283565849f, 1.0f, 0.0f,
+        0.5f, 0.545454562f, 0.0f, 0.044117678f, 0.731034398f, 0.058110036f, 0.5f, 0.0f,
+        0.0f, 0.909090936f, 1.0f, 0.279411793f, 0.203448072f, 0.374156535f, 0.0f, 0.5f,
+        0.0f, 1.0f, 1.0f, 0.65196085f, 0.786206722f, 0.396635771f, 0.5f, 0.5f,
+        0.0f, 0.0f, 1.0f, 0.352941185f, 0.651723921f, 0.264546484f, 0.0f, 1.0f,
+        0.5f, 0.545454562f, 1.0f, 0.852941334f, 0.813793063f, 0.500858366f, 0.5f, 0.5f,
+        1.0f, 0.454545468f, 0.0f, 0.995098114f, 0.431034476f, 0.779066443f, 0.0f, 1.0f,
+        0.5f, 0.636363626f, 0.0f, 0.647058845f, 0.696551621f, 0.427386492f, 1.0f, 1.0f,
+        0.5f, 0.909090936f, 0.0f, 0.264705926f, 0.982758641f, 0.126127899f, 0.5f, 1.0f,
+        0.5f, 0.909090936f, 1.0f, 0.916666806f, 0.248275757f, 0.836412668f, 1.0f, 0.0f,
+        1.0f, 0.454545468f, 0.0f, 0.519607842f, 0.913793087f, 0.280402184f, 0.5f, 1.0f,
+        0.0f, 0.181818187f, 0.0f, 0.568627477f, 0.589655101f, 0.42075187f, 0.5f, 0.5f,
+        1.0f, 0.181818187f, 1.0f, 0.0637255087f, 0.555172384f, 0.109700814f, 0.0f, 0.0f,
+        0.0f, 0.0909090936f, 1.0f, 0.946078479f, 0.196551621f, 0.893688083f, 1.0f, 0.0f,
+        1.0f, 0.0f, 1.0f, 0.0637255087f, 0.903448164f, 0.0350513048f, 0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f, 0.0f, 0.213792995f, 0.155399665f, 0.0f, 0.0f,
+        1.0f, 0.818181872f, 0.0f, 0.931372643f, 0.931034505f, 0.496876031f, 0.5f, 0.0f,
+        0.0f, 0.272727281f, 1.0f, 0.539215803f, 0.524137795f, 0.427952707f, 0.0f, 0.0f,
+        0.5f, 0.0f, 1.0f, 0.245098114f, 0.282758504f, 0.317315519f, 0.0f, 0.5f,
+        0.5f, 0.363636374f, 1.0f, 0.225490183f, 0.66896528f, 0.181656405f, 0.0f, 0.5f,
+        1.0f, 0.0f, 1.0f, 0.254901975f, 0.293103456f, 0.320712179f, 0.0f, 0.5f,
+        0.5f, 0.545454562f, 1.0f, 0.735294223f, 0.699999869f, 0.478946447f, 0.5f, 0.5f,
+        1.0f, 0.818181872f, 1.0f, 0.926470578f, 0.106896497f, 0.942216814f, 0.5f, 0.0f,
+        0.0f, 0.272727281f, 1.0f, 0.279411793f, 0.255172193f, 0.353416979f, 0.0f, 0.5f,
+        0.0f, 0.818181872f, 0.0f, 0.602941215f, 0.786206722f, 0.368428439f, 1.0f, 0.0f,
+        0.5f, 1.0f, 1.0f, 0.284313768f, 0.803448141f, 0.180544093f, 0.5f, 0.0f,
+        0.5f, 0.636363626f, 1.0f, 0.279411793f, 0.0827584118f, 0.426113486f, 0.5f, 0.0f,
+        0.0f, 0.727272749f, 0.0f, 0.598039269f, 0.882758558f, 0.33298111f, 1.0f, 0.0f,
+        1.0f, 0.727272749f, 1.0f, 0.700980484f, 0.251723975f, 0.671909153f, 1.0f, 0.0f,
+        1.0f, 0.727272749f, 1.0f, 0.0392156988f, 0.0137928929f, 0.252079189f, 1.0f, 0.0f,
+        1.0f, 1.0f, 1.0f, 0.588235378f, 0.658620656f, 0.40628165f, 0.0f, 0.5f,
+        0.5f, 0.818181872f, 1.0f, 0.333333373f, 0.772413552f, 0.217140824f, 0.5f, 1.0f,
+        0.0f, 0.636363626f, 1.0f, 0.539215803f, 0.5f, 0.437781364f, 0.0f, 0.5f,
+        1.0f, 0.727272749f, 1.0f, 0.181372553f, 0.775862038f, 0.128305316f, 0.5f, 1.0f,
+        0.5f, 0.363636374f, 0.0f, 0.333333373f, 0.886206806f, 0.186440095f, 1.0f, 0.5f,
+        0.5f, 0.636363626f, 1.0f, 0.549019635f, 0.675862014f, 0.375990987f, 0.0f, 0.5f,
+        0.0f, 0.909090936f, 0.0f, 0.784313798f, 0.855172276f, 0.445882112f, 0.0f, 0.5f,
+        0.5f, 0.545454562f, 1.0f, 0.102941155f, 0.196551621f, 0.240214422f, 0.5f, 0.0f,
+};
+
+const uint8_t NUTRITION_MODEL_CLASSES[100] PROGMEM = {
+        0, 1, 0, 0, 0, 1, 0, 1, 0, 2, 2, 0, 1, 0, 0, 1, 1, 2, 0, 2,
+        0, 0, 2, 0, 0, 0, 0, 2, 3, 0, 2, 0, 0, 4, 0, 2, 0, 0, 4, 1,
+        0, 0, 0, 0, 1, 0, 3, 4, 0, 0, 1, 2, 2, 0, 0, 0, 4, 0, 0, 3,
+        0, 3, 1, 2, 4, 4, 1, 0, 0, 4, 2, 0, 1, 4, 2, 0, 2, 2, 0, 4,
+        1, 3, 1, 0, 0, 4, 4, 3, 4, 1, 0, 1, 4, 3, 0, 2, 2, 4, 0, 3,
+};
+
+const char NUTRITION_MODEL_LABELS[5][KNN_MAX_LABEL_CHAR] PROGMEM = {
+        "obesitas",
+        "gizi baik",
+        "gizi buruk",
+        "gizi kurang",
+        "overweight",
+};
+
+const float NUTRITION_MODEL_MIN[8] PROGMEM = {5.0f, 0.0f, 0.0f, 14.1999998f, 100.800003f, 8.79661751f, 0.0f, 0.0f};
+const float NUTRITION_MODEL_MAX[8] PROGMEM = {7.0f, 11.0f, 1.0f, 34.5999985f, 129.800003f, 32.0026627f, 2.0f, 2.0f};
+
+const KNNFlashModel NUTRITION_MODEL = {
+        8, 100, 5, ROW_MAJOR,
+        NUTRITION_MODEL_FEATURES, NUTRITION_MODEL_PREPARED, NUTRITION_MODEL_CLASSES, NUTRITION_MODEL_LABELS,
+        NUTRITION_MODEL_MIN, NUTRITION_MODEL_MAX, nullptr
+};
+
+#endif
@@ -171,6 +171,25 @@ void handleUSBCommand(const String &receivedData) {
       Serial.println("Respon Anak: PASIF, SEDANG, or AKTIF");
     }
   }
+  if (commandHeader == "KNN_TUNE") {
+    unsigned long budgetMs = commandValue.length() > 0 ? (unsigned long)commandValue.toInt() : KNN_TUNE_DEFAULT_BUDGET_MS;
+    Serial.printf("KNN tuning, time budget %lu ms...\n", budgetMs);
+    tuneKNNMethods(budgetMs);
+  }
+  if (commandHeader == "KNN_CONFIRM") {
+    confirmOnlineSample(commandValue);
+  }
+  if (commandHeader == "KNN_SAVE") {
+    saveOnlineSamples();
+  }
+  if (commandHeader == "KNN_ONLINE") {
+    Serial.printf("KNN online samples: %d/%d, unsaved: %d, pending confirmation: %s\n", nutritionKNN.getOnlineCount(),
+                  nutritionKNN.getOnlineCapacity(), nutritionKNN.getUnsavedOnlineCount(), pendingOnlineSample ? "Yes" : "No");
+  }
+  if (commandHeader == "KNN_STATS") {
+    nutritionEnsemble.printStats();
+    if (commandValue == "RESET") nutritionEnsemble.resetStats();
+  }
   if (commandHeader == "HELP" || commandHeader == "?") {
     Serial.println("=== Available USB Commands ===");
     Serial.println("Basic Commands:");
@@ -191,6 +210,11 @@ void handleUSBCommand(const String &receivedData) {
     Serial.println("KNN Testing:");
     Serial.println("  KNN#<ageYears, ageMonths, gender, weight, height, eatingPattern, childResponse>");
     Serial.println("  Example: KNN#6, 6, LAKI_LAKI, 16.3, 106.5, CUKUP, PASIF");
+    Serial.println("  KNN_TUNE#<budget_ms> - Tune k, metric, voting and weights, save the best (default 2000 ms)");
+    Serial.println("  KNN_CONFIRM#<status> - Learn the last weighing with the confirmed nutrition status");
+    Serial.println("  KNN_SAVE - Save changed online samples now");
+    Serial.println("  KNN_ONLINE - Show online learning state");
+    Serial.println("  KNN_STATS#<RESET> - Show tree/KNN path counts and latency histogram, optionally reset them");
     Serial.println("================================");
   }
 }
\ No newline at end of file
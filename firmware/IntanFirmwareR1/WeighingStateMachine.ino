@@ -4,6 +4,7 @@
 // Global state variables definitions - declared as extern in Header.h
 WeighingFlowState currentFlowState = FLOW_IDLE;
 String flowEvent = "";
+String flowConfirmedStatus = "";
 uint32_t lastSensorUpdate = 0;
 uint32_t lastEventCheck = 0;
 bool flowDataReady = false;
@@ -42,6 +43,10 @@ void handleWeighingStateMachine() {
       handleCalculatingState();
       break;
 
+    case FLOW_SENDING:
+      handleSendingState();
+      break;
+
     case FLOW_COMPLETE:
       handleCompleteState();
       break;
@@ -73,6 +78,9 @@ void checkAppEvents() {
     if (newEvent != flowEvent && !newEvent.isEmpty()) {
       flowEvent = newEvent;
       Serial.printf("| Event received: %s\n", flowEvent.c_str());
+      if (flowEvent == "confirm_status") {
+        flowConfirmedStatus = sessionDoc["fields"]["confirmedStatus"]["stringValue"].as<String>();
+      }
       processEvent(flowEvent);
     }
   }
@@ -102,6 +110,12 @@ void processEvent(String event) {
   } else if (event == "cancel") {
     Serial.println("| Cancel event - resetting to idle");
     resetToIdle();
+  } else if (event == "confirm_status") {
+    // Health worker confirmed (or corrected) the status of the last weighing from the timbang tab
+    Serial.printf("| Status confirmed: %s\n", flowConfirmedStatus.c_str());
+    confirmOnlineSample(flowConfirmedStatus);
+    // forget it so a corrected status sent right after is not taken for the same event
+    flowEvent = "";
   }
 
   // Clear event after processing
@@ -157,17 +171,29 @@ void handleCalculatingState() {
   // Calculate IMT first
   flowMeasurement.imt = calculateIMT(flowMeasurement.weight, flowMeasurement.height);
 
-  // Calculate nutrition status using KNN with current measurement data
+  // Calculate nutrition status from the profile encoded at session load, no heap allocation here
   currentMeasurement.weight = flowMeasurement.weight;
   currentMeasurement.height = flowMeasurement.height;
-  currentMeasurement.eatingPatternIndex = getEatingPatternIndex(flowUser.eatingPattern);
-  currentMeasurement.childResponseIndex = getChildResponseIndex(flowUser.childResponse);
+  currentMeasurement.eatingPatternIndex = flowUser.nutrition.eatingPattern;
+  currentMeasurement.childResponseIndex = flowUser.nutrition.childResponse;
+
+  flowMeasurement.nutritionStatus = classifyNutritionStatus(flowUser.nutrition, flowMeasurement.weight, flowMeasurement.height);
 
-  String nutritionStatus = getNutritionStatusFromSession();
-  flowMeasurement.nutritionStatus = nutritionStatus;
+  if (flowMeasurement.nutritionStatus == GIZI_ERROR) {
+    Serial.println("| Nutrition classification failed - resetting to idle");
+    systemBuzzer.toggleInit(200, 3);
+    sendAppUpdate("classification_failed", "idle");
+    changeFlowState(FLOW_ERROR);
+    return;
+  }
 
   Serial.printf("| Calculation complete: IMT=%.2f, Status=%s\n",
-                flowMeasurement.imt, nutritionStatus.c_str());
+                flowMeasurement.imt, nutritionStatusLabel(flowMeasurement.nutritionStatus));
+  changeFlowState(FLOW_SENDING);
+}
+
+void handleSendingState() {
+  displayCalculatingScreen();
 
   // Send final data to app
   sendFinalMeasurementData();
@@ -210,6 +236,7 @@ void changeFlowState(WeighingFlowState newState) {
       currentWeighingState = WEIGHING_GET_HEIGHT;
       break;
     case FLOW_CALCULATING:
+    case FLOW_SENDING:
       currentWeighingState = WEIGHING_SEND_DATA;
       break;
     case FLOW_COMPLETE:
@@ -253,6 +280,8 @@ void loadUserDataFromFirestore() {
     flowUser.gender = sessionDoc["fields"]["gender"]["stringValue"].as<String>();
     flowUser.ageYears = sessionDoc["fields"]["ageYears"]["integerValue"].as<int>();
     flowUser.ageMonths = sessionDoc["fields"]["ageMonths"]["integerValue"].as<int>();
+    flowUser.nutrition = encodeNutritionProfile(flowUser.ageYears, flowUser.ageMonths, flowUser.gender,
+                                                flowUser.eatingPattern, flowUser.childResponse);
 
     Serial.printf("| User data loaded: %s (%s)\n", flowUser.userName.c_str(), flowUser.userRfid.c_str());
 
@@ -327,7 +356,7 @@ void updateRealTimeSensors() {
 void sendFinalMeasurementData() {
   Serial.println("| ===== SENDING FINAL MEASUREMENT DATA =====");
   Serial.printf("| Weight: %.1f kg, Height: %.1f cm\n", flowMeasurement.weight, flowMeasurement.height);
-  Serial.printf("| IMT: %.2f, Status: %s\n", flowMeasurement.imt, flowMeasurement.nutritionStatus.c_str());
+  Serial.printf("| IMT: %.2f, Status: %s\n", flowMeasurement.imt, nutritionStatusLabel(flowMeasurement.nutritionStatus));
   Serial.printf("| Eating: %s, Response: %s\n", flowUser.eatingPattern.c_str(), flowUser.childResponse.c_str());
 
   // BLOCKING APPROACH for critical final data
@@ -349,7 +378,7 @@ void sendFinalMeasurementData() {
     imtField["doubleValue"] = flowMeasurement.imt;
 
     JsonObject nutritionField = fields.createNestedObject("nutritionStatus");
-    nutritionField["stringValue"] = flowMeasurement.nutritionStatus;
+    nutritionField["stringValue"] = nutritionStatusLabel(flowMeasurement.nutritionStatus);
 
     JsonObject eatingField = fields.createNestedObject("eatingPattern");
     eatingField["stringValue"] = flowUser.eatingPattern;
@@ -394,6 +423,8 @@ void sendFinalMeasurementData() {
       yield();
     }
     Serial.println("| ===== FINAL MEASUREMENT DATA SENT SUCCESSFULLY =====");
+    // Kept until the app sends confirm_status, then learned by the KNN online region
+    stageOnlineSample(flowUser.nutrition, flowMeasurement.weight, flowMeasurement.height);
   } else {
     Serial.println("| ===== FAILED TO SEND FINAL MEASUREMENT DATA =====");
   }
@@ -0,0 +1,441 @@
+/*
+ *  DecisionTree.cpp
+ *
+ *  CART decision tree classifier with leaf confidences
+ *  Created on: 2026. 10. 17
+ */
+
+#include "DecisionTree.h"
+#include <math.h>
+
+DecisionTree::DecisionTree(int maxFeatures, int maxData) :
+        maxFeatures(maxFeatures), maxData(maxData), currentDataSize(0),
+        trainingData(nullptr), trainingClass(nullptr), classCount(0),
+        nodes(nullptr), nodeCount(0), maxNodes(0), treeDepth(0), trained(false),
+        criterion(GINI), maxDepth(DT_DEFAULT_MAX_DEPTH), minSamplesLeaf(DT_DEFAULT_MIN_SAMPLES_LEAF),
+        rowOrder(nullptr), sortBuffer(nullptr), errorState(false) {
+
+    errorMessage[0] = '\0';
+
+    if (maxFeatures <= 0 || maxData <= 0) {
+        errorState = true;
+        strncpy(errorMessage, "Invalid parameters", 49);
+        errorMessage[49] = '\0';
+        return;
+    }
+
+    /*a binary tree with at most maxData leaves has fewer than 2 * maxData nodes*/
+    maxNodes = 2 * maxData;
+    trainingData = new float[(size_t) maxData * maxFeatures];
+    trainingClass = new uint8_t[maxData];
+    nodes = new Node[maxNodes];
+    rowOrder = new int[maxData];
+    sortBuffer = new SortEntry[maxData];
+
+    if (trainingData == nullptr || trainingClass == nullptr || nodes == nullptr || rowOrder == nullptr ||
+        sortBuffer == nullptr) {
+        releaseBuffers();
+
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+    }
+}
+
+DecisionTree::~DecisionTree() {
+    releaseBuffers();
+}
+
+void DecisionTree::releaseBuffers() {
+    delete[] trainingData;
+    delete[] trainingClass;
+    delete[] nodes;
+    delete[] rowOrder;
+    delete[] sortBuffer;
+
+    trainingData = nullptr;
+    trainingClass = nullptr;
+    nodes = nullptr;
+    rowOrder = nullptr;
+    sortBuffer = nullptr;
+}
+
+int DecisionTree::findClass(const char *label) const {
+    for (int i = 0; i < classCount; i++) {
+        if (strncmp(classLabels[i], label, DT_MAX_LABEL_CHAR - 1) == 0) return i;
+    }
+    return -1;
+}
+
+bool DecisionTree::addTrainingData(const char *label, const float features[]) {
+    if (errorState) return false;
+
+    if (currentDataSize >= maxData) {
+        errorState = true;
+        strncpy(errorMessage, "Training data full", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (label == nullptr || features == nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Null pointer provided", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    int classId = findClass(label);
+    if (classId < 0) {
+        if (classCount >= DT_MAX_CLASSES) {
+            errorState = true;
+            strncpy(errorMessage, "Too many classes", 49);
+            errorMessage[49] = '\0';
+            return false;
+        }
+        strncpy(classLabels[classCount], label, DT_MAX_LABEL_CHAR - 1);
+        classLabels[classCount][DT_MAX_LABEL_CHAR - 1] = '\0';
+        classId = classCount++;
+    }
+
+    float *row = trainingData + (size_t) currentDataSize * maxFeatures;
+    for (int j = 0; j < maxFeatures; j++) {
+        row[j] = features[j];
+    }
+    trainingClass[currentDataSize] = (uint8_t) classId;
+    currentDataSize++;
+
+    /*the tree keeps answering from the old rows until train() runs again*/
+    return true;
+}
+
+bool DecisionTree::train(SplitCriterion splitCriterion) {
+    if (errorState) return false;
+
+    if (currentDataSize == 0) {
+        errorState = true;
+        strncpy(errorMessage, "No training data available", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    criterion = splitCriterion;
+    for (int i = 0; i < currentDataSize; i++) {
+        rowOrder[i] = i;
+    }
+    return buildTree(currentDataSize);
+}
+
+/*grows a fresh tree over the first rows entries of rowOrder*/
+bool DecisionTree::buildTree(int rows) {
+    nodeCount = 0;
+    treeDepth = 0;
+    trained = buildNode(0, rows, 0) >= 0;
+    return trained;
+}
+
+/*
+ * Makes a leaf when the slice is pure, too small to split into two
+ * minSamplesLeaf halves, at maxDepth, or has no split that lowers the
+ * impurity; otherwise partitions the slice in place and recurses.
+ * Returns the node index.
+ */
+int DecisionTree::buildNode(int start, int count, int depth) {
+    if (nodeCount >= maxNodes) return -1;
+
+    int counts[DT_MAX_CLASSES] = {0};
+    for (int i = start; i < start + count; i++) {
+        counts[trainingClass[rowOrder[i]]]++;
+    }
+    int majority = 0;
+    for (int c = 1; c < classCount; c++) {
+        if (counts[c] > counts[majority]) majority = c;
+    }
+
+    int index = nodeCount++;
+    Node &node = nodes[index];
+    node.feature = -1;
+    node.left = -1;
+    node.right = -1;
+    node.classId = majority;
+    node.samples = count;
+    node.threshold = 0.0f;
+    node.confidence = (count > 0) ? (float) counts[majority] / count : 0.0f;
+    if (depth > treeDepth) treeDepth = depth;
+
+    int feature = -1;
+    float threshold = 0.0f;
+    if (counts[majority] == count || depth >= maxDepth || count < 2 * minSamplesLeaf ||
+        !findSplit(start, count, feature, threshold)) {
+        return index;
+    }
+
+    int split = start;
+    for (int i = start; i < start + count; i++) {
+        if (trainingData[(size_t) rowOrder[i] * maxFeatures + feature] <= threshold) {
+            int row = rowOrder[i];
+            rowOrder[i] = rowOrder[split];
+            rowOrder[split] = row;
+            split++;
+        }
+    }
+
+    int left = buildNode(start, split - start, depth + 1);
+    int right = (left >= 0) ? buildNode(split, start + count - split, depth + 1) : -1;
+    if (left < 0 || right < 0) return -1;
+
+    node.feature = feature;
+    node.threshold = threshold;
+    node.left = left;
+    node.right = right;
+    return index;
+}
+
+/*
+ * Tries every midpoint between distinct sorted values of every feature and
+ * keeps the split with the lowest weighted child impurity, as long as it
+ * beats the parent and leaves minSamplesLeaf rows on each side.
+ */
+bool DecisionTree::findSplit(int start, int count, int &feature, float &threshold) const {
+    int totalCounts[DT_MAX_CLASSES] = {0};
+    for (int i = start; i < start + count; i++) {
+        totalCounts[trainingClass[rowOrder[i]]]++;
+    }
+
+    float bestScore = impurity(totalCounts, count) * count;
+    bool found = false;
+
+    for (int j = 0; j < maxFeatures; j++) {
+        for (int i = 0; i < count; i++) {
+            int row = rowOrder[start + i];
+            sortBuffer[i].value = trainingData[(size_t) row * maxFeatures + j];
+            sortBuffer[i].classId = trainingClass[row];
+        }
+        sortEntries(sortBuffer, count);
+
+        int leftCounts[DT_MAX_CLASSES] = {0};
+        int rightCounts[DT_MAX_CLASSES];
+        for (int c = 0; c < classCount; c++) {
+            rightCounts[c] = totalCounts[c];
+        }
+
+        for (int i = 0; i < count - 1; i++) {
+            leftCounts[sortBuffer[i].classId]++;
+            rightCounts[sortBuffer[i].classId]--;
+
+            int leftSize = i + 1;
+            int rightSize = count - leftSize;
+            if (sortBuffer[i].value == sortBuffer[i + 1].value) continue;
+            if (leftSize < minSamplesLeaf || rightSize < minSamplesLeaf) continue;
+
+            float score = impurity(leftCounts, leftSize) * leftSize + impurity(rightCounts, rightSize) * rightSize;
+            if (score < bestScore - 1e-6f) {
+                bestScore = score;
+                feature = j;
+                threshold = 0.5f * (sortBuffer[i].value + sortBuffer[i + 1].value);
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+float DecisionTree::impurity(const int counts[], int total) const {
+    if (total == 0) return 0.0f;
+
+    float value = (criterion == GINI) ? 1.0f : 0.0f;
+    for (int c = 0; c < classCount; c++) {
+        if (counts[c] == 0) continue;
+        float p = (float) counts[c] / total;
+        if (criterion == GINI) {
+            value -= p * p;
+        } else {
+            value -= p * log2f(p);
+        }
+    }
+    return value;
+}
+
+/*heap sort by value, in place and without recursion*/
+void DecisionTree::sortEntries(SortEntry *entries, int count) {
+    for (int root = count / 2 - 1; root >= 0; root--) {
+        siftDown(entries, root, count);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        SortEntry top = entries[0];
+        entries[0] = entries[end];
+        entries[end] = top;
+        siftDown(entries, 0, end);
+    }
+}
+
+void DecisionTree::siftDown(SortEntry *entries, int root, int size) {
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) return;
+        if (child + 1 < size && entries[child + 1].value > entries[child].value) child++;
+        if (entries[child].value <= entries[root].value) return;
+
+        SortEntry temp = entries[root];
+        entries[root] = entries[child];
+        entries[child] = temp;
+        root = child;
+    }
+}
+
+int DecisionTree::findLeaf(const float features[]) const {
+    int index = 0;
+    while (nodes[index].feature >= 0) {
+        const Node &node = nodes[index];
+        index = (features[node.feature] <= node.threshold) ? node.left : node.right;
+    }
+    return index;
+}
+
+const char *DecisionTree::predict(const float features[]) const {
+    DecisionTreeResult result;
+    predictWithConfidence(features, result);
+    return result.label;
+}
+
+/*
+ * Walks to a leaf; confidence is the share of that leaf's training rows in
+ * its majority class, depth the number of splits taken to get there.
+ */
+bool DecisionTree::predictWithConfidence(const float features[], DecisionTreeResult &result) const {
+    result.label = "ERROR";
+    result.classId = -1;
+    result.confidence = 0.0f;
+    result.leafSamples = 0;
+    result.depth = 0;
+
+    if (errorState || !trained || features == nullptr) return false;
+
+    int index = 0;
+    while (nodes[index].feature >= 0) {
+        const Node &node = nodes[index];
+        index = (features[node.feature] <= node.threshold) ? node.left : node.right;
+        result.depth++;
+    }
+
+    const Node &leaf = nodes[index];
+    result.label = classLabels[leaf.classId];
+    result.classId = leaf.classId;
+    result.confidence = leaf.confidence;
+    result.leafSamples = leaf.samples;
+    return true;
+}
+
+/*
+ * Shuffled k-fold estimate: each fold is scored on a tree grown from the
+ * other folds. The tree is grown again from every row afterwards if it
+ * had been trained before.
+ */
+float DecisionTree::crossValidate(int folds) {
+    if (errorState || currentDataSize < folds || folds < 2) return 0.0f;
+
+    int *foldOf = new int[currentDataSize];
+    if (foldOf == nullptr) return 0.0f;
+
+    for (int i = 0; i < currentDataSize; i++) {
+        rowOrder[i] = i;
+    }
+    for (int i = 0; i < currentDataSize; i++) {
+        int j = random(currentDataSize);
+        int temp = rowOrder[i];
+        rowOrder[i] = rowOrder[j];
+        rowOrder[j] = temp;
+    }
+
+    int foldSize = currentDataSize / folds;
+    for (int i = 0; i < currentDataSize; i++) {
+        int fold = i / foldSize;
+        foldOf[rowOrder[i]] = (fold < folds) ? fold : folds - 1;
+    }
+
+    bool wasTrained = trained;
+    float totalAccuracy = 0.0f;
+    for (int fold = 0; fold < folds; fold++) {
+        int rows = 0;
+        for (int i = 0; i < currentDataSize; i++) {
+            if (foldOf[i] != fold) rowOrder[rows++] = i;
+        }
+        if (!buildTree(rows)) break;
+
+        int tested = 0;
+        int correct = 0;
+        for (int i = 0; i < currentDataSize; i++) {
+            if (foldOf[i] != fold) continue;
+            tested++;
+            if (nodes[findLeaf(trainingData + (size_t) i * maxFeatures)].classId == trainingClass[i]) correct++;
+        }
+        totalAccuracy += (tested > 0) ? (float) correct / tested : 0.0f;
+    }
+    delete[] foldOf;
+
+    trained = false;
+    if (wasTrained) train(criterion);
+    return totalAccuracy / folds;
+}
+
+void DecisionTree::setMaxDepth(int depth) {
+    if (depth > 0) maxDepth = depth;
+}
+
+void DecisionTree::setMinSamplesLeaf(int samples) {
+    if (samples > 0) minSamplesLeaf = samples;
+}
+
+void DecisionTree::clearTrainingData() {
+    currentDataSize = 0;
+    classCount = 0;
+    nodeCount = 0;
+    treeDepth = 0;
+    trained = false;
+    clearError();
+}
+
+int DecisionTree::getDataCount() const {
+    return currentDataSize;
+}
+
+int DecisionTree::getClassCount() const {
+    return classCount;
+}
+
+const char *DecisionTree::getClassLabel(int classId) const {
+    if (classId < 0 || classId >= classCount) return nullptr;
+    return classLabels[classId];
+}
+
+int DecisionTree::getNodeCount() const {
+    return nodeCount;
+}
+
+int DecisionTree::getDepth() const {
+    return treeDepth;
+}
+
+bool DecisionTree::isTrained() const {
+    return trained;
+}
+
+size_t DecisionTree::getMemoryUsage() const {
+    size_t usage = sizeof(DecisionTree);
+    usage += (size_t) maxData * maxFeatures * sizeof(float);
+    usage += (size_t) maxData * (sizeof(uint8_t) + sizeof(int) + sizeof(SortEntry));
+    usage += (size_t) maxNodes * sizeof(Node);
+    return usage;
+}
+
+bool DecisionTree::hasError() const {
+    return errorState;
+}
+
+const char *DecisionTree::getErrorMessage() const {
+    return errorState ? errorMessage : "No error";
+}
+
+void DecisionTree::clearError() {
+    errorState = false;
+    errorMessage[0] = '\0';
+}
@@ -0,0 +1,122 @@
+/*
+ *  DecisionTree.h
+ *
+ *  CART decision tree classifier with leaf confidences
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef DECISION_TREE_LIB_H
+#define DECISION_TREE_LIB_H
+
+#pragma message("[COMPILED]: DecisionTree.h")
+
+#include "Arduino.h"
+
+enum SplitCriterion {
+    GINI,
+    ENTROPY
+};
+
+const int DT_MAX_LABEL_CHAR = 20;
+const int DT_MAX_CLASSES = 16;
+const int DT_DEFAULT_MAX_DEPTH = 8;
+const int DT_DEFAULT_MIN_SAMPLES_LEAF = 2;
+
+/*what a prediction walked to, filled by DecisionTree::predictWithConfidence()*/
+struct DecisionTreeResult {
+    const char *label;
+    int classId;
+    float confidence;
+    int leafSamples;
+    int depth;
+};
+
+/*
+ * Binary tree over float features, grown greedily on the Gini or entropy
+ * gain of threshold splits. A leaf stores its majority class and the
+ * share of its training rows in that class, which is what makes the tree
+ * usable as a cheap first opinion: a pure, well-populated leaf is a
+ * confident answer, a mixed one is not.
+ */
+class DecisionTree {
+private:
+    int maxFeatures;
+    int maxData;
+    int currentDataSize;
+
+    float *trainingData;
+    uint8_t *trainingClass;
+    char classLabels[DT_MAX_CLASSES][DT_MAX_LABEL_CHAR];
+    int classCount;
+
+    /*internal nodes split on feature <= threshold; leaves have feature -1*/
+    struct Node {
+        int feature;
+        int left;
+        int right;
+        int classId;
+        int samples;
+        float threshold;
+        float confidence;
+    };
+    Node *nodes;
+    int nodeCount;
+    int maxNodes;
+    int treeDepth;
+    bool trained;
+
+    SplitCriterion criterion;
+    int maxDepth;
+    int minSamplesLeaf;
+
+    /*one row of the candidate sort while searching a split*/
+    struct SortEntry {
+        float value;
+        uint8_t classId;
+    };
+    int *rowOrder;
+    SortEntry *sortBuffer;
+
+    bool errorState;
+    char errorMessage[50];
+
+    int buildNode(int start, int count, int depth);
+    bool findSplit(int start, int count, int &feature, float &threshold) const;
+    float impurity(const int counts[], int total) const;
+    static void sortEntries(SortEntry *entries, int count);
+    static void siftDown(SortEntry *entries, int root, int size);
+    int findLeaf(const float features[]) const;
+    bool buildTree(int rows);
+    int findClass(const char *label) const;
+    void releaseBuffers();
+
+public:
+    DecisionTree(int maxFeatures, int maxData);
+    ~DecisionTree();
+
+    bool addTrainingData(const char *label, const float features[]);
+    bool train(SplitCriterion splitCriterion = GINI);
+    const char *predict(const float features[]) const;
+    bool predictWithConfidence(const float features[], DecisionTreeResult &result) const;
+    float crossValidate(int folds);
+
+    void setMaxDepth(int depth);
+    void setMinSamplesLeaf(int samples);
+    void clearTrainingData();
+
+    int getDataCount() const;
+    int getClassCount() const;
+    const char *getClassLabel(int classId) const;
+    int getNodeCount() const;
+    int getDepth() const;
+    bool isTrained() const;
+    size_t getMemoryUsage() const;
+
+    bool hasError() const;
+    const char *getErrorMessage() const;
+    void clearError();
+};
+
+#endif
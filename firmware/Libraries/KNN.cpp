@@ -6,21 +6,98 @@
  */
 
 #include "KNN.h"
+#include "KNNModelFormat.h"
+#include "KNNSimd.h"
+#include <float.h>
+
+#if defined(ESP32)
+#include "Task.h"
+#include <atomic>
+typedef std::atomic<int> FoldCounter;
+#elif !defined(ARDUINO)
+#include <atomic>
+#include <thread>
+typedef std::atomic<int> FoldCounter;
+#else
+typedef int FoldCounter;
+#endif
+
+#if defined(ESP32)
+static const uint32_t KNN_FOLD_TASK_STACK = 4096;
+#endif
+
+/*esp-dsp pays a call per chunk, so batch tiles keep their feature-major loops instead of one call per pair*/
+#if defined(KNN_SIMD_ESP_DSP)
+static const bool KNN_PAIR_KERNELS = false;
+#else
+static const bool KNN_PAIR_KERNELS = true;
+#endif
+
+/*
+ * One crossValidate() worker. Folds are claimed from a shared counter and
+ * scored with private buffers, so workers only share read-only model data.
+ */
+struct KNN::FoldWorker {
+    const int *foldOf;
+    float *foldAccuracy;
+    int folds;
+    FoldCounter *nextFold;
+    DistanceIndex *neighbors;
+    float *query;
+    float *row;
+    float *rangeMin;
+    float *rangeScale;
+    const KNN *model;
+#if defined(ESP32)
+    SemaphoreHandle_t done;
+#endif
+};
+
+static int foldWorkerCount(int folds) {
+#if defined(ESP32)
+    int workers = portNUM_PROCESSORS;
+#elif !defined(ARDUINO)
+    int workers = (int) std::thread::hardware_concurrency();
+#else
+    int workers = 1;
+#endif
+    if (workers > KNN_MAX_FOLD_WORKERS) workers = KNN_MAX_FOLD_WORKERS;
+    if (workers > folds) workers = folds;
+    return (workers < 1) ? 1 : workers;
+}
 
-int KNN::compareDistances(const void *a, const void *b) {
-    const auto *da = (const DistanceIndex *) a;
-    const auto *db = (const DistanceIndex *) b;
+static float *alignStore(uint8_t *block) {
+    uintptr_t address = (uintptr_t) block;
+    address = (address + KNN_STORE_ALIGNMENT - 1) & ~((uintptr_t) KNN_STORE_ALIGNMENT - 1);
+    return (float *) address;
+}
 
-    if (da->distance < db->distance) return -1;
-    if (da->distance > db->distance) return 1;
-    return 0;
+bool KNN::isFarther(const DistanceIndex &a, const DistanceIndex &b) {
+    if (a.distance != b.distance) return a.distance > b.distance;
+    return a.index > b.index;
 }
 
-KNN::KNN(int k, int maxFeatures, int maxData) :
+KNN::KNN(int k, int maxFeatures, int maxData, KNNStorageLayout storageLayout, KNNPrecision storagePrecision) :
         k(k), maxFeatures(maxFeatures), maxData(maxData), currentDataSize(0),
+        trainingBlock(nullptr), trainingData(nullptr), layout(storageLayout), flashModel(nullptr),
+        precision(storagePrecision), codeData(nullptr), quantLevels(0), quantRangeSet(false), queryCodes(nullptr),
+        trainingClass(nullptr), classCount(0),
         metric(EUCLIDEAN), useWeightedVoting(false), normalizationEnabled(false),
         lowMemoryMode(false), debugMode(false), featureMin(nullptr), featureMax(nullptr),
-        voteBuffer(nullptr), distanceBuffer(nullptr), errorState(false) {
+        featureMinCount(nullptr), featureMaxCount(nullptr), rangesDirty(false),
+        featureWeight(nullptr), featureWeightSq(nullptr), featureCoef(nullptr), featureCoefSq(nullptr),
+        featureOffset(nullptr), featureWeighted(false),
+        fastSearchEnabled(false), preparedDirty(true), preparedBlock(nullptr), preparedData(nullptr),
+        featureScale(nullptr), queryBuffer(nullptr),
+        distanceBuffer(nullptr), rowBuffer(nullptr),
+        batchNeighbors(nullptr), batchQueries(nullptr), batchDistances(nullptr),
+        indexEnabled(false), indexDirty(true), indexNodes(nullptr), indexOrder(nullptr),
+        indexNodeCount(0), indexMaxNodes(0), baseDataCount(0), onlineCapacity(0), onlineCount(0), onlineHead(0),
+        onlineEviction(EVICT_OLDEST), onlineClock(1), onlineSequence(nullptr), onlineSaved(nullptr),
+        onlineRewrite(false), onlineBlock(nullptr), onlineData(nullptr), onlinePrepared(nullptr),
+        errorState(false) {
+
+    errorMessage[0] = '\0';
 
     if (k <= 0 || k > maxData || maxFeatures <= 0 || maxData <= 0) {
         errorState = true;
@@ -29,139 +106,306 @@ KNN::KNN(int k, int maxFeatures, int maxData) :
         return;
     }
 
-    trainingData = new float *[maxData];
-    if (trainingData == nullptr) {
+    size_t storeSize = (size_t) maxData * maxFeatures * elementSize();
+    trainingBlock = new uint8_t[storeSize + KNN_STORE_ALIGNMENT];
+    trainingClass = new uint8_t[maxData];
+    distanceBuffer = new DistanceIndex[maxData];
+    rowBuffer = new float[maxFeatures];
+    /*zeroed, an empty model saves defined ranges*/
+    featureMin = new float[maxFeatures]();
+    featureMax = new float[maxFeatures]();
+    featureMinCount = new int32_t[2 * maxFeatures];
+    featureScale = new float[maxFeatures];
+    featureWeight = new float[5 * maxFeatures];
+    queryBuffer = new float[maxFeatures];
+    queryCodes = new int32_t[maxFeatures + (maxFeatures + 1) / 2];
+
+    if (trainingBlock == nullptr || trainingClass == nullptr || distanceBuffer == nullptr ||
+        rowBuffer == nullptr || featureMin == nullptr || featureMax == nullptr || featureMinCount == nullptr ||
+        featureScale == nullptr || featureWeight == nullptr || queryBuffer == nullptr || queryCodes == nullptr) {
+        releaseBuffers();
+
         errorState = true;
         strncpy(errorMessage, "Memory allocation failed", 49);
         errorMessage[49] = '\0';
         return;
     }
 
-    for (int i = 0; i < maxData; ++i) {
-        trainingData[i] = new float[maxFeatures];
-        if (trainingData[i] == nullptr) {
-            for (int j = 0; j < i; ++j) {
-                delete[] trainingData[j];
-            }
-            delete[] trainingData;
-            trainingData = nullptr;
+    featureMaxCount = featureMinCount + maxFeatures;
+    setFeatureWeights(nullptr);
 
-            errorState = true;
-            strncpy(errorMessage, "Memory allocation failed", 49);
-            errorMessage[49] = '\0';
-            return;
-        }
+    if (precision == PRECISION_FLOAT32) {
+        trainingData = alignStore(trainingBlock);
+    } else {
+        codeData = (uint8_t *) alignStore(trainingBlock);
+        quantLevels = (precision == PRECISION_INT8) ? 255 : 65535;
     }
+}
 
-    trainingLabels = new char *[maxData];
-    if (trainingLabels == nullptr) {
-        for (int i = 0; i < maxData; ++i) {
-            delete[] trainingData[i];
-        }
-        delete[] trainingData;
-        trainingData = nullptr;
+/*
+ * Borrows the rows, class ids and prepared rows of a flash model. Only the
+ * per-feature buffers and the distance buffer are allocated, the model
+ * itself is never copied and stays read-only.
+ */
+KNN::KNN(int k, const KNNFlashModel &model) :
+        k(k), maxFeatures(model.featureCount), maxData(model.dataCount), currentDataSize(model.dataCount),
+        trainingBlock(nullptr), trainingData(nullptr), layout(model.layout), flashModel(&model),
+        precision(PRECISION_FLOAT32), codeData(nullptr), quantLevels(0), quantRangeSet(false), queryCodes(nullptr),
+        trainingClass(nullptr), classCount(0),
+        metric(EUCLIDEAN), useWeightedVoting(false), normalizationEnabled(false),
+        lowMemoryMode(false), debugMode(false), featureMin(nullptr), featureMax(nullptr),
+        featureMinCount(nullptr), featureMaxCount(nullptr), rangesDirty(false),
+        featureWeight(nullptr), featureWeightSq(nullptr), featureCoef(nullptr), featureCoefSq(nullptr),
+        featureOffset(nullptr), featureWeighted(false),
+        fastSearchEnabled(false), preparedDirty(true), preparedBlock(nullptr), preparedData(nullptr),
+        featureScale(nullptr), queryBuffer(nullptr),
+        distanceBuffer(nullptr), rowBuffer(nullptr),
+        batchNeighbors(nullptr), batchQueries(nullptr), batchDistances(nullptr),
+        indexEnabled(false), indexDirty(true), indexNodes(nullptr), indexOrder(nullptr),
+        indexNodeCount(0), indexMaxNodes(0), baseDataCount(0), onlineCapacity(0), onlineCount(0), onlineHead(0),
+        onlineEviction(EVICT_OLDEST), onlineClock(1), onlineSequence(nullptr), onlineSaved(nullptr),
+        onlineRewrite(false), onlineBlock(nullptr), onlineData(nullptr), onlinePrepared(nullptr),
+        errorState(false) {
 
+    errorMessage[0] = '\0';
+
+    if (k <= 0 || k > maxData || maxFeatures <= 0 || model.features == nullptr || model.classes == nullptr ||
+        model.labels == nullptr || model.featureMin == nullptr || model.featureMax == nullptr ||
+        model.classCount <= 0 || model.classCount > KNN_MAX_CLASSES) {
+        currentDataSize = 0;
         errorState = true;
-        strncpy(errorMessage, "Memory allocation failed", 49);
+        strncpy(errorMessage, "Invalid flash model", 49);
         errorMessage[49] = '\0';
         return;
     }
 
-    for (int i = 0; i < maxData; ++i) {
-        trainingLabels[i] = new char[20];
-        if (trainingLabels[i] == nullptr) {
-            for (int j = 0; j < i; ++j) {
-                delete[] trainingLabels[j];
-            }
-            delete[] trainingLabels;
-            trainingLabels = nullptr;
+    distanceBuffer = new DistanceIndex[maxData];
+    rowBuffer = new float[maxFeatures];
+    featureMin = new float[maxFeatures];
+    featureMax = new float[maxFeatures];
+    featureMinCount = new int32_t[2 * maxFeatures];
+    featureScale = new float[maxFeatures];
+    featureWeight = new float[5 * maxFeatures];
+    queryBuffer = new float[maxFeatures];
+    queryCodes = new int32_t[maxFeatures + (maxFeatures + 1) / 2];
+
+    if (distanceBuffer == nullptr || rowBuffer == nullptr || featureMin == nullptr || featureMax == nullptr ||
+        featureMinCount == nullptr || featureScale == nullptr || featureWeight == nullptr ||
+        queryBuffer == nullptr || queryCodes == nullptr) {
+        releaseBuffers();
+
+        currentDataSize = 0;
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return;
+    }
 
-            for (int j = 0; j < maxData; ++j) {
-                delete[] trainingData[j];
-            }
-            delete[] trainingData;
-            trainingData = nullptr;
+    trainingData = const_cast<float *>(model.features);
+    trainingClass = const_cast<uint8_t *>(model.classes);
 
-            errorState = true;
-            strncpy(errorMessage, "Memory allocation failed", 49);
-            errorMessage[49] = '\0';
-            return;
-        }
-        trainingLabels[i][0] = '\0';
+    for (int i = 0; i < model.classCount; i++) {
+        strncpy(classLabels[i], model.labels[i], KNN_MAX_LABEL_CHAR - 1);
+        classLabels[i][KNN_MAX_LABEL_CHAR - 1] = '\0';
+    }
+    classCount = model.classCount;
+
+    featureMaxCount = featureMinCount + maxFeatures;
+    for (int j = 0; j < maxFeatures; j++) {
+        featureMin[j] = model.featureMin[j];
+        featureMax[j] = model.featureMax[j];
+        featureMinCount[j] = -1;
+        featureMaxCount[j] = -1;
     }
+    setFeatureWeights(model.featureWeights);
+}
 
-    voteBuffer = new int[maxData];
-    distanceBuffer = new DistanceIndex[maxData];
+KNN::~KNN() {
+    releaseBuffers();
+}
 
-    if (voteBuffer == nullptr || distanceBuffer == nullptr) {
-        delete[] voteBuffer;
-        delete[] distanceBuffer;
-        voteBuffer = nullptr;
-        distanceBuffer = nullptr;
+void KNN::releaseBuffers() {
+    delete[] trainingBlock;
+    if (flashModel == nullptr || trainingClass != flashModel->classes) delete[] trainingClass;
+    delete[] distanceBuffer;
+    delete[] rowBuffer;
+    delete[] featureMin;
+    delete[] featureMax;
+    delete[] featureMinCount;
+    delete[] featureScale;
+    delete[] featureWeight;
+    delete[] queryBuffer;
+    delete[] queryCodes;
+    delete[] preparedBlock;
+    delete[] indexNodes;
+    delete[] indexOrder;
+    delete[] batchNeighbors;
+    delete[] batchQueries;
+    delete[] batchDistances;
+    delete[] onlineSequence;
+    delete[] onlineBlock;
+
+    trainingBlock = nullptr;
+    trainingData = nullptr;
+    trainingClass = nullptr;
+    distanceBuffer = nullptr;
+    rowBuffer = nullptr;
+    featureMin = nullptr;
+    featureMax = nullptr;
+    featureMinCount = nullptr;
+    featureMaxCount = nullptr;
+    featureScale = nullptr;
+    featureWeight = nullptr;
+    featureWeightSq = nullptr;
+    featureCoef = nullptr;
+    featureCoefSq = nullptr;
+    featureOffset = nullptr;
+    queryBuffer = nullptr;
+    queryCodes = nullptr;
+    codeData = nullptr;
+    preparedBlock = nullptr;
+    preparedData = nullptr;
+    indexNodes = nullptr;
+    indexOrder = nullptr;
+    batchNeighbors = nullptr;
+    batchQueries = nullptr;
+    batchDistances = nullptr;
+    onlineSequence = nullptr;
+    onlineSaved = nullptr;
+    onlineBlock = nullptr;
+    onlineData = nullptr;
+    onlinePrepared = nullptr;
+}
 
-        for (int i = 0; i < maxData; ++i) {
-            delete[] trainingLabels[i];
-            delete[] trainingData[i];
-        }
-        delete[] trainingLabels;
-        delete[] trainingData;
-        trainingLabels = nullptr;
-        trainingData = nullptr;
+const float *KNN::rowPointer(int index) const {
+    if (onlineData != nullptr && index >= baseDataCount) return onlineData + (size_t) (index - baseDataCount) * maxFeatures;
+    if (layout == COLUMN_MAJOR) return trainingData + index;
+    return trainingData + (size_t) index * maxFeatures;
+}
 
-        errorState = true;
-        strncpy(errorMessage, "Memory allocation failed", 49);
-        errorMessage[49] = '\0';
-    }
+/*feature step of the row rowPointer() returns, online block rows are contiguous*/
+int KNN::rowStride(int index) const {
+    return (onlineData != nullptr && index >= baseDataCount) ? 1 : featureStride();
+}
 
-    featureMin = new float[maxFeatures];
-    featureMax = new float[maxFeatures];
+int KNN::featureStride() const {
+    return layout == COLUMN_MAJOR ? maxData : 1;
+}
 
-    if (featureMin == nullptr || featureMax == nullptr) {
-        delete[] featureMin;
-        delete[] featureMax;
-        featureMin = nullptr;
-        featureMax = nullptr;
+/*rows held in trainingData, the rest of a flash model's rows are in onlineBlock*/
+int KNN::storeRows() const {
+    return (onlineData != nullptr) ? baseDataCount : currentDataSize;
+}
 
-        delete[] voteBuffer;
-        delete[] distanceBuffer;
+void KNN::copyRow(int index, float output[]) const {
+    size_t offset = (layout == COLUMN_MAJOR) ? index : (size_t) index * maxFeatures;
+    int stride = featureStride();
 
-        for (int i = 0; i < maxData; ++i) {
-            delete[] trainingLabels[i];
-            delete[] trainingData[i];
+    if (onlineData != nullptr && index >= baseDataCount) {
+        memcpy(output, rowPointer(index), maxFeatures * sizeof(float));
+    } else if (precision == PRECISION_INT8) {
+        const uint8_t *row = codeData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            output[i] = decodeFeature(row[i * stride], i);
+        }
+    } else if (precision == PRECISION_INT16) {
+        const uint16_t *row = (const uint16_t *) codeData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            output[i] = decodeFeature(row[i * stride], i);
+        }
+    } else {
+        const float *row = trainingData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            output[i] = row[i * stride];
         }
-        delete[] trainingLabels;
-        delete[] trainingData;
-
-        errorState = true;
-        strncpy(errorMessage, "Memory allocation failed", 49);
-        errorMessage[49] = '\0';
     }
 }
 
-KNN::~KNN() {
-    if (trainingData != nullptr) {
-        for (int i = 0; i < maxData; ++i) {
-            if (trainingData[i] != nullptr) delete[] trainingData[i];
+void KNN::storeRow(int index, const float features[]) {
+    size_t offset = (layout == COLUMN_MAJOR) ? index : (size_t) index * maxFeatures;
+    int stride = featureStride();
+
+    if (onlineData != nullptr && index >= baseDataCount) {
+        memcpy(onlineData + (size_t) (index - baseDataCount) * maxFeatures, features, maxFeatures * sizeof(float));
+    } else if (precision == PRECISION_INT8) {
+        uint8_t *row = codeData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            row[i * stride] = (uint8_t) encodeFeature(features[i], i);
+        }
+    } else if (precision == PRECISION_INT16) {
+        uint16_t *row = (uint16_t *) codeData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            row[i * stride] = (uint16_t) encodeFeature(features[i], i);
+        }
+    } else {
+        float *row = trainingData + offset;
+        for (int i = 0; i < maxFeatures; i++) {
+            row[i * stride] = features[i];
         }
-        delete[] trainingData;
     }
+}
 
-    if (trainingLabels != nullptr) {
-        for (int i = 0; i < maxData; ++i) {
-            if (trainingLabels[i] != nullptr) delete[] trainingLabels[i];
-        }
-        delete[] trainingLabels;
+size_t KNN::elementSize() const {
+    if (precision == PRECISION_INT8) return sizeof(uint8_t);
+    if (precision == PRECISION_INT16) return sizeof(uint16_t);
+    return sizeof(float);
+}
+
+/*
+ * Codes span [0, quantLevels] over the feature range, so a code is the
+ * normalized value times quantLevels. Stored rows clamp to the range,
+ * queries may fall outside it.
+ */
+int32_t KNN::encodeFeature(float value, int featureIndex) const {
+    float range = featureMax[featureIndex] - featureMin[featureIndex];
+    if (range < 0.0001f) return quantLevels / 2;
+
+    float code = (value - featureMin[featureIndex]) * quantLevels / range;
+    if (code < 0.0f) return 0;
+    if (code > quantLevels) return quantLevels;
+    return (int32_t) (code + 0.5f);
+}
+
+float KNN::decodeFeature(int32_t code, int featureIndex) const {
+    float range = featureMax[featureIndex] - featureMin[featureIndex];
+    if (range < 0.0001f) return featureMin[featureIndex];
+    return featureMin[featureIndex] + (float) code * range / quantLevels;
+}
+
+int KNN::findClass(const char *label) const {
+    for (int i = 0; i < classCount; i++) {
+        if (strncmp(classLabels[i], label, KNN_MAX_LABEL_CHAR - 1) == 0) return i;
     }
+    return -1;
+}
 
-    delete[] voteBuffer;
-    delete[] distanceBuffer;
-    delete[] featureMin;
-    delete[] featureMax;
+int KNN::internLabel(const char *label) {
+    int classId = findClass(label);
+    if (classId >= 0) return classId;
+    if (classCount >= KNN_MAX_CLASSES) return -1;
+
+    strncpy(classLabels[classCount], label, KNN_MAX_LABEL_CHAR - 1);
+    classLabels[classCount][KNN_MAX_LABEL_CHAR - 1] = '\0';
+    return classCount++;
 }
 
 bool KNN::addTrainingData(const char *label, const float features[]) {
     if (errorState) return false;
 
+    if (flashModel != nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Flash model is read-only", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (onlineCapacity > 0) {
+        errorState = true;
+        strncpy(errorMessage, "Online region active, use learnOnline", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
     if (currentDataSize >= maxData) {
         errorState = true;
         strncpy(errorMessage, "Training data full", 49);
@@ -176,116 +420,379 @@ bool KNN::addTrainingData(const char *label, const float features[]) {
         return false;
     }
 
-    for (int i = 0; i < maxFeatures; ++i) {
-        trainingData[currentDataSize][i] = features[i];
+    if (precision != PRECISION_FLOAT32 && !quantRangeSet) {
+        errorState = true;
+        strncpy(errorMessage, "Quantization range not set", 49);
+        errorMessage[49] = '\0';
+        return false;
     }
 
-    strncpy(trainingLabels[currentDataSize], label, 19);
-    trainingLabels[currentDataSize][19] = '\0';
+    int classId = internLabel(label);
+    if (classId < 0) {
+        errorState = true;
+        strncpy(errorMessage, "Too many classes", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
 
     currentDataSize++;
+    placeRow(currentDataSize - 1, classId, features);
+
+    return true;
+}
 
-    if (normalizationEnabled && currentDataSize == 1) {
+/*
+ * Writes a row that is already counted in currentDataSize and folds it
+ * into the ranges and the prepared copy. An overwritten row has to be
+ * released with releaseExtremes() first.
+ */
+void KNN::placeRow(int index, int classId, const float features[]) {
+    storeRow(index, features);
+    trainingClass[index] = (uint8_t) classId;
+
+    if (precision != PRECISION_FLOAT32) {
+        /*the quantization range stays fixed, rows outside it are clamped*/
+    } else if (flashModel != nullptr) {
+        /*the prepared rows in flash were normalized with the model's ranges, so those stay fixed*/
+    } else if (normalizationEnabled && currentDataSize == 1) {
         calculateFeatureRanges();
     } else if (normalizationEnabled) {
         for (int i = 0; i < maxFeatures; ++i) {
-            if (features[i] < featureMin[i]) featureMin[i] = features[i];
-            if (features[i] > featureMax[i]) featureMax[i] = features[i];
+            if (features[i] < featureMin[i]) {
+                featureMin[i] = features[i];
+                featureMinCount[i] = 1;
+                preparedDirty = true;
+            } else if (features[i] == featureMin[i] && featureMinCount[i] >= 0) {
+                featureMinCount[i]++;
+            }
+            if (features[i] > featureMax[i]) {
+                featureMax[i] = features[i];
+                featureMaxCount[i] = 1;
+                preparedDirty = true;
+            } else if (features[i] == featureMax[i] && featureMaxCount[i] >= 0) {
+                featureMaxCount[i]++;
+            }
         }
     }
 
-    return true;
+    if (fastSearchEnabled && !preparedDirty) {
+        storePreparedRow(index, features);
+    }
+    indexDirty = true;
 }
 
 const char *KNN::predict(const float dataPoint[]) {
-    if (errorState) return "ERROR";
+    KNNResult result;
+    predictWithConfidence(dataPoint, result);
+    return result.label;
+}
+
+bool KNN::predictWithConfidence(const float dataPoint[], KNNResult &result) {
+    result.label = "ERROR";
+    result.classId = -1;
+    result.confidence = 0.0f;
+    result.totalVotes = 0.0f;
+    result.neighborCount = 0;
+
+    if (errorState) return false;
 
     if (currentDataSize == 0) {
         errorState = true;
         strncpy(errorMessage, "No training data available", 49);
         errorMessage[49] = '\0';
-        return "ERROR";
+        return false;
     }
 
     if (dataPoint == nullptr) {
         errorState = true;
         strncpy(errorMessage, "Null data point provided", 49);
         errorMessage[49] = '\0';
-        return "ERROR";
+        return false;
     }
 
-    if (voteBuffer == nullptr || distanceBuffer == nullptr) {
+    if (distanceBuffer == nullptr) {
         errorState = true;
         strncpy(errorMessage, "Buffer not allocated", 49);
         errorMessage[49] = '\0';
-        return "ERROR";
+        return false;
     }
 
-    for (int i = 0; i < currentDataSize; i++) {
-        voteBuffer[i] = 0;
+    int effectiveK = (k > currentDataSize) ? currentDataSize : k;
+    findNearest(dataPoint, effectiveK);
+    tallyVotes(distanceBuffer, effectiveK, useWeightedVoting, result);
+
+    if (debugMode) {
+        Serial.print("Predicted label: ");
+        Serial.println(result.label);
     }
 
-    for (int i = 0; i < currentDataSize; i++) {
-        distanceBuffer[i].distance = calculateDistance(dataPoint, trainingData[i]);
-        distanceBuffer[i].index = i;
+    return true;
+}
+
+void KNN::tallyVotes(const DistanceIndex *neighbors, int count, bool weighted, KNNResult &result) const {
+    result.totalVotes = 0.0f;
+    result.neighborCount = 0;
+
+    for (int i = 0; i < classCount; i++) {
+        result.classVotes[i] = 0.0f;
     }
 
-    qsort(distanceBuffer, currentDataSize, sizeof(DistanceIndex), compareDistances);
+    int maxVotedClass = trainingClass[neighbors[0].index];
 
-    int effectiveK = (k > currentDataSize) ? currentDataSize : k;
+    for (int i = 0; i < count; i++) {
+        int classId = trainingClass[neighbors[i].index];
+        float distance = neighbors[i].distance;
+        float vote = weighted ? 1.0f / (distance + 0.0001f) : 1.0f;
+
+        result.classVotes[classId] += vote;
+        result.totalVotes += vote;
+
+        if (result.classVotes[classId] > result.classVotes[maxVotedClass]) {
+            maxVotedClass = classId;
+        }
+
+        if (i < KNN_MAX_NEIGHBORS) {
+            result.neighborIndices[i] = neighbors[i].index;
+            result.neighborDistances[i] = distance;
+            result.neighborCount++;
+        }
+    }
+
+    /*an exact match always wins a weighted vote*/
+    if (weighted && neighbors[0].distance <= 0.0001f) {
+        maxVotedClass = trainingClass[neighbors[0].index];
+    }
+
+    result.classId = maxVotedClass;
+    result.label = classLabels[maxVotedClass];
+    result.confidence = (result.totalVotes > 0.0f) ? (result.classVotes[maxVotedClass] / result.totalVotes) : 0.0f;
+}
+
+/*
+ * queries holds queryCount rows of maxFeatures values back to back. They
+ * are scored KNN_BATCH_TILE at a time: every block of KNN_BATCH_ROWS
+ * training rows is run against the whole tile before moving on, so the
+ * block stays in cache instead of the store streaming past once per
+ * query. Results match predictWithConfidence() exactly. confidences may
+ * be nullptr.
+ */
+bool KNN::predictBatch(const float queries[], int queryCount, const char *labels[], float confidences[]) {
+    if (queries == nullptr || labels == nullptr || queryCount <= 0) return false;
+
+    const float *tile[KNN_BATCH_TILE];
+    bool success = true;
+
+    for (int start = 0; start < queryCount; start += KNN_BATCH_TILE) {
+        int count = (queryCount - start < KNN_BATCH_TILE) ? queryCount - start : KNN_BATCH_TILE;
+        for (int q = 0; q < count; q++) {
+            tile[q] = queries + (size_t) (start + q) * maxFeatures;
+        }
+        if (!predictTile(tile, count, labels + start, (confidences != nullptr) ? confidences + start : nullptr)) {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+/*
+ * Only fast search with Euclidean or Manhattan is blocked: those distances
+ * are plain sums, so a whole tile of them is computed in one tight loop
+ * (across queries for row-major stores, across rows for column-major) and
+ * then filtered against each query's heap. Cosine, the kd-tree index,
+ * quantized stores, the unprepared path and single-query tiles go one
+ * query at a time. A flash model's online rows are offered to each heap
+ * afterwards, the way searchPrepared() does.
+ */
+bool KNN::predictTile(const float *const queries[], int count, const char *labels[], float confidences[]) {
+    bool blocked = count > 1 && fastSearchEnabled && metric != COSINE && precision == PRECISION_FLOAT32 &&
+                   currentDataSize > 0 && !errorState && !useIndex();
+    for (int q = 0; blocked && q < count; q++) {
+        if (queries[q] == nullptr) blocked = false;
+    }
 
-    int maxVotes = 0;
-    int maxVotedIndex = distanceBuffer[0].index;
+    if (blocked && batchNeighbors == nullptr) {
+        batchNeighbors = new DistanceIndex[(size_t) KNN_BATCH_TILE * k];
+        batchQueries = new float[(size_t) KNN_BATCH_TILE * maxFeatures];
+        batchDistances = new float[KNN_BATCH_TILE * KNN_BATCH_ROWS];
+        if (batchNeighbors == nullptr || batchQueries == nullptr || batchDistances == nullptr) {
+            delete[] batchNeighbors;
+            delete[] batchQueries;
+            delete[] batchDistances;
+            batchNeighbors = nullptr;
+            batchQueries = nullptr;
+            batchDistances = nullptr;
 
-    if (useWeightedVoting) {
-        auto *weights = new float[currentDataSize];
-        if (weights == nullptr) {
             errorState = true;
             strncpy(errorMessage, "Memory allocation failed", 49);
             errorMessage[49] = '\0';
-            return "ERROR";
+            blocked = false;
         }
+    }
 
-        for (int i = 0; i < effectiveK; i++) {
-            int idx = distanceBuffer[i].index;
-            float distance = distanceBuffer[i].distance;
+    if (!blocked) {
+        bool success = true;
+        for (int q = 0; q < count; q++) {
+            KNNResult result;
+            if (!predictWithConfidence(queries[q], result)) success = false;
+            labels[q] = result.label;
+            if (confidences != nullptr) confidences[q] = result.confidence;
+        }
+        return success;
+    }
+
+    if (preparedDirty) prepareFastSearch();
+
+    int effectiveK = (k > currentDataSize) ? currentDataSize : k;
+    const float *data = searchData();
+    bool manhattan = metric == MANHATTAN;
+
+    /*
+     * Queries are stored feature-major, lane q of feature j at
+     * [j * KNN_BATCH_TILE + q]. Where the metric has an inline vector
+     * kernel, row-major stores keep them row by row instead and score each
+     * pair with the same kernel as calculatePreparedDistance(), so the sums
+     * round identically.
+     */
+    bool pairKernels = KNN_PAIR_KERNELS && layout == ROW_MAJOR && (manhattan ? KNN_SIMD_ABS : KNN_SIMD_SQUARED);
+    for (int j = 0; j < maxFeatures; j++) {
+        for (int q = 0; q < KNN_BATCH_TILE; q++) {
+            float &value = pairKernels ? batchQueries[q * maxFeatures + j] : batchQueries[j * KNN_BATCH_TILE + q];
+            if (q >= count) value = 0.0f;
+            else if (!normalizationEnabled) value = queries[q][j];
+            else if (featureScale[j] == 0.0f) value = 0.5f;
+            else value = (queries[q][j] - featureMin[j]) * featureScale[j];
+        }
+    }
+
+    int filled[KNN_BATCH_TILE];
+    for (int q = 0; q < count; q++) {
+        filled[q] = 0;
+    }
+
+    int storedRows = storeRows();
+    for (int blockStart = 0; blockStart < storedRows; blockStart += KNN_BATCH_ROWS) {
+        int rows = (storedRows - blockStart < KNN_BATCH_ROWS) ? storedRows - blockStart : KNN_BATCH_ROWS;
+
+        if (layout == COLUMN_MAJOR) {
+            for (int q = 0; q < count; q++) {
+                float *out = batchDistances + q * KNN_BATCH_ROWS;
+                for (int r = 0; r < rows; r++) {
+                    out[r] = 0.0f;
+                }
+
+                for (int j = 0; j < maxFeatures; j++) {
+                    const float *column = data + (size_t) j * maxData + blockStart;
+                    float value = batchQueries[j * KNN_BATCH_TILE + q];
+
+                    if (manhattan) {
+                        float weight = featureWeight[j];
+                        for (int r = 0; r < rows; r++) {
+                            out[r] += abs(value - column[r]) * weight;
+                        }
+                    } else {
+                        float weight = featureWeightSq[j];
+                        for (int r = 0; r < rows; r++) {
+                            float diff = value - column[r];
+                            out[r] += diff * diff * weight;
+                        }
+                    }
+                }
+            }
+        } else if (pairKernels) {
+            const float *row = data + (size_t) blockStart * maxFeatures;
+            for (int r = 0; r < rows; r++, row += maxFeatures) {
+                for (int q = 0; q < count; q++) {
+                    const float *query = batchQueries + (size_t) q * maxFeatures;
+                    batchDistances[q * KNN_BATCH_ROWS + r] =
+                            manhattan ? knnSimdAbsDistance(query, row, featureWeight, maxFeatures)
+                                      : knnSimdSquaredDistance(query, row, featureWeightSq, maxFeatures);
+                }
+            }
+        } else {
+            const float *row = data + (size_t) blockStart * maxFeatures;
+            for (int r = 0; r < rows; r++, row += maxFeatures) {
+                float sums[KNN_BATCH_TILE] = {0.0f};
+
+                for (int j = 0; j < maxFeatures; j++) {
+                    const float *lane = batchQueries + j * KNN_BATCH_TILE;
+                    float value = row[j];
+
+                    if (manhattan) {
+                        float weight = featureWeight[j];
+                        for (int q = 0; q < KNN_BATCH_TILE; q++) {
+                            sums[q] += abs(lane[q] - value) * weight;
+                        }
+                    } else {
+                        float weight = featureWeightSq[j];
+                        for (int q = 0; q < KNN_BATCH_TILE; q++) {
+                            float diff = lane[q] - value;
+                            sums[q] += diff * diff * weight;
+                        }
+                    }
+                }
 
-            if (distance <= 0.0001f) {
-                for (int j = 0; j < currentDataSize; j++) {
-                    weights[j] = 0;
+                for (int q = 0; q < count; q++) {
+                    batchDistances[q * KNN_BATCH_ROWS + r] = sums[q];
                 }
-                weights[idx] = 1.0f;
-                maxVotedIndex = idx;
-                break;
             }
+        }
 
-            float weight = 1.0f / (distance + 0.0001f);
-            weights[idx] += weight;
+        for (int q = 0; q < count; q++) {
+            DistanceIndex *heap = batchNeighbors + (size_t) q * effectiveK;
+            const float *distances = batchDistances + q * KNN_BATCH_ROWS;
 
-            if (weights[idx] > weights[maxVotedIndex]) {
-                maxVotedIndex = idx;
+            for (int r = 0; r < rows; r++) {
+                if (filled[q] == effectiveK && distances[r] > heap[0].distance) continue;
+
+                DistanceIndex candidate = {distances[r], blockStart + r};
+                offerCandidate(heap, candidate, effectiveK, filled[q]);
             }
         }
+    }
 
-        delete[] weights;
-    } else {
-        for (int i = 0; i < effectiveK; i++) {
-            int idx = distanceBuffer[i].index;
-            voteBuffer[idx]++;
+    for (int q = 0; q < count; q++) {
+        DistanceIndex *heap = batchNeighbors + (size_t) q * effectiveK;
+        if (storedRows < currentDataSize) {
+            for (int j = 0; j < maxFeatures; j++) {
+                if (!normalizationEnabled) queryBuffer[j] = queries[q][j];
+                else if (featureScale[j] == 0.0f) queryBuffer[j] = 0.5f;
+                else queryBuffer[j] = (queries[q][j] - featureMin[j]) * featureScale[j];
+            }
+            searchOnline(queryBuffer, heap, effectiveK, filled[q]);
+        }
+        sortHeap(heap, effectiveK);
 
-            if (voteBuffer[idx] > maxVotes) {
-                maxVotes = voteBuffer[idx];
-                maxVotedIndex = idx;
+        if (!manhattan) {
+            for (int i = 0; i < effectiveK; i++) {
+                heap[i].distance = sqrt(heap[i].distance);
             }
         }
+
+        KNNResult result;
+        tallyVotes(heap, effectiveK, useWeightedVoting, result);
+        labels[q] = result.label;
+        if (confidences != nullptr) confidences[q] = result.confidence;
     }
 
-    if (debugMode) {
-        Serial.print("Predicted label: ");
-        Serial.println(trainingLabels[maxVotedIndex]);
+    return true;
+}
+
+/*the batch tile heaps are sized by k, they are reallocated on next use*/
+bool KNN::setK(int newK) {
+    if (newK <= 0 || newK > maxData) return false;
+
+    if (newK != k) {
+        delete[] batchNeighbors;
+        delete[] batchQueries;
+        delete[] batchDistances;
+        batchNeighbors = nullptr;
+        batchQueries = nullptr;
+        batchDistances = nullptr;
     }
 
-    return trainingLabels[maxVotedIndex];
+    k = newK;
+    return true;
 }
 
 void KNN::setDistanceMetric(DistanceMetric newMetric) {
@@ -298,6 +805,7 @@ void KNN::setWeightedVoting(bool weighted) {
 
 void KNN::enableNormalization(bool enable) {
     normalizationEnabled = enable;
+    preparedDirty = true;
     if (enable && currentDataSize > 0) {
         calculateFeatureRanges();
     }
@@ -311,390 +819,2409 @@ void KNN::setDebugMode(bool enable) {
     debugMode = enable;
 }
 
-void KNN::calculateFeatureRanges() {
-    if (currentDataSize == 0 || featureMin == nullptr || featureMax == nullptr) return;
+/*
+ * Fast search ranks rows on a normalized copy of the store: normalization
+ * runs once per row at insert time instead of on every query, Euclidean
+ * ranks by squared distance so sqrt only runs for the k winners, and on
+ * row-major stores a row is abandoned as soon as its partial sum passes
+ * the current k-th best. The copy costs as much RAM as the store itself.
+ */
+bool KNN::enableFastSearch(bool enable) {
+    if (!enable) {
+        enableIndex(false);
+        delete[] preparedBlock;
+        preparedBlock = nullptr;
+        preparedData = nullptr;
+        fastSearchEnabled = false;
+        return true;
+    }
 
-    for (int i = 0; i < maxFeatures; i++) {
-        featureMin[i] = trainingData[0][i];
-        featureMax[i] = trainingData[0][i];
+    if (fastSearchEnabled) return true;
+    if (precision != PRECISION_FLOAT32) return true;
+
+    if (flashModel != nullptr && flashModel->preparedFeatures != nullptr) {
+        preparedData = const_cast<float *>(flashModel->preparedFeatures);
+        fastSearchEnabled = true;
+        preparedDirty = true;
+        return true;
     }
 
-    for (int i = 1; i < currentDataSize; i++) {
-        for (int j = 0; j < maxFeatures; j++) {
-            if (trainingData[i][j] < featureMin[j]) featureMin[j] = trainingData[i][j];
-            if (trainingData[i][j] > featureMax[j]) featureMax[j] = trainingData[i][j];
-        }
+    preparedBlock = new uint8_t[(size_t) maxData * maxFeatures * sizeof(float) + KNN_STORE_ALIGNMENT];
+    if (preparedBlock == nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return false;
     }
-}
 
-void KNN::clearTrainingData() {
-    currentDataSize = 0;
-    clearError();
+    preparedData = alignStore(preparedBlock);
+    fastSearchEnabled = true;
+    preparedDirty = true;
+    return true;
 }
 
-bool KNN::removeTrainingData(int index) {
-    if (index < 0 || index >= currentDataSize) {
+/*
+ * The index is a kd-tree over the fast search rows, so enabling it also
+ * enables fast search. It is rebuilt lazily after the data changes and is
+ * only consulted for Euclidean from KNN_INDEX_MIN_DATA rows and Manhattan
+ * from KNN_INDEX_MIN_DATA_MANHATTAN rows; the Manhattan plane bound prunes
+ * less and the index is slower than fast search below a few thousand rows
+ * (about 2000 to 5000 in KNNIndexBench). Cosine, quantized stores and
+ * column-major stores stay on fast search, the column scan in
+ * searchPrepared() runs before any index lookup. Column-major stores and
+ * stores with room for fewer than KNN_INDEX_MIN_DATA rows are refused.
+ */
+bool KNN::enableIndex(bool enable) {
+    if (!enable) {
+        delete[] indexNodes;
+        delete[] indexOrder;
+        indexNodes = nullptr;
+        indexOrder = nullptr;
+        indexNodeCount = 0;
+        indexEnabled = false;
+        return true;
+    }
+
+    if (indexEnabled) return true;
+    if (layout == COLUMN_MAJOR || maxData < KNN_INDEX_MIN_DATA) return false;
+    if (precision != PRECISION_FLOAT32 || !enableFastSearch(true)) return false;
+
+    indexMaxNodes = 4 * (maxData / KNN_INDEX_LEAF_SIZE + 1);
+    indexNodes = new IndexNode[indexMaxNodes];
+    indexOrder = new int[maxData];
+    if (indexNodes == nullptr || indexOrder == nullptr) {
+        enableIndex(false);
         errorState = true;
-        strncpy(errorMessage, "Invalid index", 49);
+        strncpy(errorMessage, "Memory allocation failed", 49);
         errorMessage[49] = '\0';
         return false;
     }
 
-    for (int i = index; i < currentDataSize - 1; i++) {
-        for (int j = 0; j < maxFeatures; j++) {
-            trainingData[i][j] = trainingData[i + 1][j];
-        }
-        strncpy(trainingLabels[i], trainingLabels[i + 1], 19);
-        trainingLabels[i][19] = '\0';
-    }
+    indexEnabled = true;
+    indexDirty = true;
+    return true;
+}
 
-    currentDataSize--;
+/*a store too small for the current metric is left dirty and built once it grows*/
+bool KNN::buildIndex() {
+    if (!useIndex()) return false;
+    if (preparedDirty) prepareFastSearch();
 
-    if (normalizationEnabled) {
-        calculateFeatureRanges();
+    int rows = storeRows();
+    for (int i = 0; i < rows; i++) {
+        indexOrder[i] = i;
     }
 
+    indexNodeCount = 0;
+    if (rows > 0) buildIndexNode(0, rows);
+    indexDirty = false;
     return true;
 }
 
-int KNN::getDataCount() const {
-    return currentDataSize;
+void KNN::calculateFeatureRanges() {
+    if (currentDataSize == 0 || featureMin == nullptr || featureMax == nullptr) return;
+    if (precision != PRECISION_FLOAT32) return;
+
+    if (flashModel != nullptr) {
+        for (int j = 0; j < maxFeatures; j++) {
+            featureMin[j] = flashModel->featureMin[j];
+            featureMax[j] = flashModel->featureMax[j];
+            featureMinCount[j] = -1;
+            featureMaxCount[j] = -1;
+        }
+        rangesDirty = false;
+        preparedDirty = true;
+        return;
+    }
+
+    for (int j = 0; j < maxFeatures; j++) {
+        rescanFeatureRange(j);
+    }
+    rangesDirty = false;
+    preparedDirty = true;
 }
 
-int KNN::getDataCountByLabel(const char *label) const {
-    if (label == nullptr) return 0;
+void KNN::rescanFeatureRange(int feature) {
+    int stride = featureStride();
+    const float *column = rowPointer(0) + feature * stride;
+    size_t step = (layout == COLUMN_MAJOR) ? 1 : maxFeatures;
 
-    int count = 0;
-    for (int i = 0; i < currentDataSize; i++) {
-        if (strcmp(trainingLabels[i], label) == 0) {
-            count++;
+    float min = column[0];
+    float max = column[0];
+    int32_t minCount = 1;
+    int32_t maxCount = 1;
+    for (int i = 1; i < currentDataSize; i++) {
+        float value = column[i * step];
+        if (value < min) {
+            min = value;
+            minCount = 1;
+        } else if (value == min) {
+            minCount++;
+        }
+        if (value > max) {
+            max = value;
+            maxCount = 1;
+        } else if (value == max) {
+            maxCount++;
         }
     }
 
-    return count;
+    featureMin[feature] = min;
+    featureMax[feature] = max;
+    featureMinCount[feature] = minCount;
+    featureMaxCount[feature] = maxCount;
 }
 
-bool KNN::getNearestNeighbors(const float dataPoint[], int indices[], float distances[], int neighborCount) {
-    if (errorState || dataPoint == nullptr || indices == nullptr || distances == nullptr) return false;
-    if (neighborCount <= 0 || neighborCount > currentDataSize) return false;
+/*rescans only the features whose last min or max row was removed*/
+void KNN::refreshFeatureRanges() {
+    rangesDirty = false;
+    if (currentDataSize == 0 || precision != PRECISION_FLOAT32) return;
 
-    for (int i = 0; i < currentDataSize; i++) {
-        distanceBuffer[i].distance = calculateDistance(dataPoint, trainingData[i]);
-        distanceBuffer[i].index = i;
+    for (int j = 0; j < maxFeatures; j++) {
+        if (featureMinCount[j] == 0 || featureMaxCount[j] == 0) rescanFeatureRange(j);
     }
+    preparedDirty = true;
+}
 
-    qsort(distanceBuffer, currentDataSize, sizeof(DistanceIndex), compareDistances);
+/*
+ * Takes a row that is about to leave the store out of the extreme counts.
+ * Unknown counts are settled with one scan of that feature first.
+ */
+void KNN::releaseExtremes(const float features[]) {
+    for (int j = 0; j < maxFeatures; j++) {
+        if (features[j] == featureMin[j]) {
+            if (featureMinCount[j] < 0) featureMinCount[j] = countFeatureValue(j, features[j]);
+            if (featureMinCount[j] > 0 && --featureMinCount[j] == 0) rangesDirty = true;
+        }
+        if (features[j] == featureMax[j]) {
+            if (featureMaxCount[j] < 0) featureMaxCount[j] = countFeatureValue(j, features[j]);
+            if (featureMaxCount[j] > 0 && --featureMaxCount[j] == 0) rangesDirty = true;
+        }
+    }
+    if (rangesDirty) preparedDirty = true;
+}
+
+int32_t KNN::countFeatureValue(int feature, float value) const {
+    const float *column = rowPointer(0) + feature * featureStride();
+    size_t step = (layout == COLUMN_MAJOR) ? 1 : maxFeatures;
+
+    int32_t count = 0;
+    for (int i = 0; i < currentDataSize; i++) {
+        if (column[i * step] == value) count++;
+    }
+    return count;
+}
+
+/*
+ * Weights scale each feature after normalization: 0 drops a feature, 2
+ * counts it twice as far. nullptr restores all weights to 1. Weights must
+ * not be negative.
+ */
+bool KNN::setFeatureWeights(const float weights[]) {
+    if (featureWeight == nullptr) return false;
+
+    for (int j = 0; weights != nullptr && j < maxFeatures; j++) {
+        if (!(weights[j] >= 0.0f)) return false;
+    }
+
+    featureWeightSq = featureWeight + maxFeatures;
+    featureCoef = featureWeight + 2 * maxFeatures;
+    featureOffset = featureWeight + 3 * maxFeatures;
+    featureCoefSq = featureWeight + 4 * maxFeatures;
+
+    for (int j = 0; j < maxFeatures; j++) {
+        setFeatureWeight(j, (weights != nullptr) ? weights[j] : 1.0f);
+    }
+    return true;
+}
+
+bool KNN::setFeatureWeight(int feature, float weight) {
+    if (featureWeight == nullptr || feature < 0 || feature >= maxFeatures || !(weight >= 0.0f)) return false;
+
+    featureWeight[feature] = weight;
+    featureWeightSq[feature] = weight * weight;
+
+    featureWeighted = false;
+    for (int j = 0; j < maxFeatures; j++) {
+        if (featureWeight[j] != 1.0f) featureWeighted = true;
+    }
+
+    /*the prepared rows stay unweighted, only the cached coefficients change*/
+    preparedDirty = true;
+    return true;
+}
+
+float KNN::getFeatureWeight(int feature) const {
+    if (featureWeight == nullptr || feature < 0 || feature >= maxFeatures) return 0.0f;
+    return featureWeight[feature];
+}
+
+/*also drops the online region, enableOnlineLearning() starts a new one*/
+void KNN::clearTrainingData() {
+    delete[] onlineSequence;
+    delete[] onlineBlock;
+    onlineSequence = nullptr;
+    onlineSaved = nullptr;
+    onlineBlock = nullptr;
+    onlineData = nullptr;
+    onlinePrepared = nullptr;
+    onlineCapacity = 0;
+    onlineCount = 0;
+    baseDataCount = 0;
+
+    currentDataSize = 0;
+    classCount = 0;
+    rangesDirty = false;
+    preparedDirty = true;
+    indexDirty = true;
+    clearError();
+}
+
+/*
+ * Swap-remove: the last row moves into the freed slot, so only that row
+ * changes index. Ranges stay exact through the extreme counts; a feature
+ * is rescanned before the next search only if its last min or max row
+ * was the one removed.
+ */
+bool KNN::removeTrainingData(int index) {
+    if (flashModel != nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Flash model is read-only", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (onlineCapacity > 0) {
+        errorState = true;
+        strncpy(errorMessage, "Online region active", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (index < 0 || index >= currentDataSize) {
+        errorState = true;
+        strncpy(errorMessage, "Invalid index", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (normalizationEnabled && precision == PRECISION_FLOAT32) {
+        copyRow(index, rowBuffer);
+        releaseExtremes(rowBuffer);
+    }
+
+    int last = currentDataSize - 1;
+    if (index != last) {
+        uint8_t *store = (precision == PRECISION_FLOAT32) ? (uint8_t *) trainingData : codeData;
+        moveRow(store, elementSize(), last, index);
+        trainingClass[index] = trainingClass[last];
+
+        /*an up-to-date prepared copy only needs the same move*/
+        if (normalizationEnabled && preparedBlock != nullptr && !preparedDirty) {
+            moveRow((uint8_t *) preparedData, sizeof(float), last, index);
+        }
+    }
+
+    currentDataSize--;
+    indexDirty = true;
+    return true;
+}
+
+void KNN::moveRow(uint8_t *store, size_t size, int from, int to) {
+    if (layout == COLUMN_MAJOR) {
+        for (int j = 0; j < maxFeatures; j++) {
+            uint8_t *column = store + (size_t) j * maxData * size;
+            memcpy(column + (size_t) to * size, column + (size_t) from * size, size);
+        }
+    } else {
+        size_t rowBytes = (size_t) maxFeatures * size;
+        memcpy(store + (size_t) to * rowBytes, store + (size_t) from * rowBytes, rowBytes);
+    }
+}
+
+/*
+ * Moves the store, class ids and search buffers into blocks sized for
+ * rows. The prepared copy and the index are rebuilt lazily.
+ */
+bool KNN::growStore(int rows) {
+    size_t size = elementSize();
+    bool prepared = fastSearchEnabled;
+
+    uint8_t *block = new uint8_t[(size_t) rows * maxFeatures * size + KNN_STORE_ALIGNMENT];
+    uint8_t *classes = new uint8_t[rows];
+    DistanceIndex *distances = new DistanceIndex[rows];
+    uint8_t *preparedCopy = prepared ? new uint8_t[(size_t) rows * maxFeatures * sizeof(float) + KNN_STORE_ALIGNMENT]
+                                     : nullptr;
+    int maxNodes = 4 * (rows / KNN_INDEX_LEAF_SIZE + 1);
+    IndexNode *nodes = indexEnabled ? new IndexNode[maxNodes] : nullptr;
+    int *order = indexEnabled ? new int[rows] : nullptr;
+
+    if (block == nullptr || classes == nullptr || distances == nullptr || (prepared && preparedCopy == nullptr) ||
+        (indexEnabled && (nodes == nullptr || order == nullptr))) {
+        delete[] block;
+        delete[] classes;
+        delete[] distances;
+        delete[] preparedCopy;
+        delete[] nodes;
+        delete[] order;
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    const uint8_t *source = (precision == PRECISION_FLOAT32) ? (const uint8_t *) trainingData : codeData;
+    uint8_t *target = (uint8_t *) alignStore(block);
+    if (layout == COLUMN_MAJOR) {
+        for (int j = 0; j < maxFeatures; j++) {
+            memcpy(target + (size_t) j * rows * size, source + (size_t) j * maxData * size, currentDataSize * size);
+        }
+    } else {
+        memcpy(target, source, (size_t) currentDataSize * maxFeatures * size);
+    }
+    memcpy(classes, trainingClass, currentDataSize);
+
+    delete[] trainingBlock;
+    delete[] trainingClass;
+    delete[] distanceBuffer;
+    delete[] preparedBlock;
+    delete[] indexNodes;
+    delete[] indexOrder;
+
+    trainingBlock = block;
+    if (precision == PRECISION_FLOAT32) {
+        trainingData = (float *) target;
+    } else {
+        codeData = target;
+    }
+    trainingClass = classes;
+    distanceBuffer = distances;
+    preparedBlock = preparedCopy;
+    preparedData = prepared ? alignStore(preparedCopy) : nullptr;
+    indexNodes = nodes;
+    indexOrder = order;
+    indexMaxNodes = maxNodes;
+    indexNodeCount = 0;
+
+    maxData = rows;
+    preparedDirty = true;
+    indexDirty = true;
+    return true;
+}
+
+/*
+ * Heap side of a flash model's online region: capacity raw and prepared
+ * rows, plus class ids and a distance buffer covering base and online
+ * rows. The flash rows are not copied.
+ */
+bool KNN::attachOnlineBlock(int capacity) {
+    int rows = currentDataSize + capacity;
+    uint8_t *block = new uint8_t[(size_t) 2 * capacity * maxFeatures * sizeof(float) + KNN_STORE_ALIGNMENT];
+    uint8_t *classes = new uint8_t[rows];
+    DistanceIndex *distances = new DistanceIndex[rows];
+
+    if (block == nullptr || classes == nullptr || distances == nullptr) {
+        delete[] block;
+        delete[] classes;
+        delete[] distances;
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    memcpy(classes, trainingClass, currentDataSize);
+    if (trainingClass != flashModel->classes) delete[] trainingClass;
+    delete[] distanceBuffer;
+
+    trainingClass = classes;
+    distanceBuffer = distances;
+    onlineBlock = block;
+    onlineData = alignStore(block);
+    onlinePrepared = onlineData + (size_t) capacity * maxFeatures;
+    return true;
+}
+
+/*
+ * Reserves capacity rows after the current data for samples confirmed in
+ * the field. The rows loaded so far become the fixed base. A flash model
+ * stays in flash, only its online rows and class ids go to the heap, and
+ * they are normalized with the model's ranges. addTrainingData() and
+ * removeTrainingData() are refused from then on, learnOnline() is the
+ * only way in.
+ */
+bool KNN::enableOnlineLearning(int capacity, KNNOnlineEviction eviction) {
+    if (errorState) return false;
+
+    if (onlineCapacity > 0 || capacity <= 0) {
+        errorState = true;
+        strncpy(errorMessage, onlineCapacity > 0 ? "Online region already enabled" : "Invalid parameters", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (flashModel != nullptr) {
+        if (!attachOnlineBlock(capacity)) return false;
+    } else if (currentDataSize + capacity > maxData && !growStore(currentDataSize + capacity)) {
+        return false;
+    }
+
+    onlineSequence = new uint32_t[2 * capacity];
+    if (onlineSequence == nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    onlineSaved = onlineSequence + capacity;
+    for (int i = 0; i < 2 * capacity; i++) {
+        onlineSequence[i] = 0;
+    }
+
+    baseDataCount = currentDataSize;
+    onlineCapacity = capacity;
+    onlineCount = 0;
+    onlineHead = 0;
+    onlineEviction = eviction;
+    onlineClock = 1;
+    onlineRewrite = false;
+    return true;
+}
+
+/*
+ * Adds one confirmed sample to the online region. While the ring has room
+ * the sample takes the next free row; once full it overwrites the slot
+ * chosen by the eviction policy, so the row count stays fixed.
+ */
+bool KNN::learnOnline(const char *label, const float features[]) {
+    if (errorState) return false;
+
+    if (onlineCapacity == 0) {
+        errorState = true;
+        strncpy(errorMessage, "Online learning not enabled", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (label == nullptr || features == nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Null pointer provided", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    if (precision != PRECISION_FLOAT32 && !quantRangeSet) {
+        errorState = true;
+        strncpy(errorMessage, "Quantization range not set", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    int classId = internLabel(label);
+    if (classId < 0) {
+        errorState = true;
+        strncpy(errorMessage, "Too many classes", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    int slot = (onlineCount < onlineCapacity) ? onlineCount : onlineVictim();
+    placeOnline(slot, classId, features, onlineClock++);
+    return true;
+}
+
+/*
+ * Oldest-first follows the ring head. Class balance takes the oldest
+ * sample of the class holding the most online slots, so a run of one
+ * status cannot push the rarer ones out.
+ */
+int KNN::onlineVictim() {
+    if (onlineEviction == EVICT_OLDEST) {
+        int slot = onlineHead;
+        onlineHead = (onlineHead + 1) % onlineCapacity;
+        return slot;
+    }
+
+    int classSlots[KNN_MAX_CLASSES] = {0};
+    int crowded = 0;
+    for (int s = 0; s < onlineCount; s++) {
+        int classId = trainingClass[baseDataCount + s];
+        if (++classSlots[classId] > crowded) crowded = classSlots[classId];
+    }
+
+    int victim = -1;
+    for (int s = 0; s < onlineCount; s++) {
+        if (classSlots[trainingClass[baseDataCount + s]] != crowded) continue;
+        if (victim < 0 || onlineSequence[s] < onlineSequence[victim]) victim = s;
+    }
+    return victim;
+}
+
+/*fills the next free slot or overwrites an occupied one in place*/
+void KNN::placeOnline(int slot, int classId, const float features[], uint32_t sequence) {
+    int row = baseDataCount + slot;
+
+    if (slot < onlineCount) {
+        if (normalizationEnabled && precision == PRECISION_FLOAT32 && flashModel == nullptr) {
+            copyRow(row, rowBuffer);
+            releaseExtremes(rowBuffer);
+        }
+    } else {
+        onlineCount++;
+        currentDataSize++;
+    }
+
+    placeRow(row, classId, features);
+    onlineSequence[slot] = sequence;
+}
+
+int KNN::getOnlineCount() const {
+    return onlineCount;
+}
+
+int KNN::getOnlineCapacity() const {
+    return onlineCapacity;
+}
+
+/*slots whose sample has changed since the last saveOnlineSamples()*/
+int KNN::getUnsavedOnlineCount() const {
+    int unsaved = 0;
+    for (int s = 0; s < onlineCapacity; s++) {
+        if (onlineSequence[s] != onlineSaved[s]) unsaved++;
+    }
+    return unsaved;
+}
+
+int KNN::getDataCount() const {
+    return currentDataSize;
+}
+
+int KNN::getDataCountByLabel(const char *label) const {
+    if (label == nullptr) return 0;
+
+    int classId = findClass(label);
+    if (classId < 0) return 0;
+
+    int count = 0;
+    for (int i = 0; i < currentDataSize; i++) {
+        if (trainingClass[i] == classId) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+const char *KNN::getLabel(int index) const {
+    if (index < 0 || index >= currentDataSize) return nullptr;
+    return classLabels[trainingClass[index]];
+}
+
+/*the row as it was added whatever the layout, quantized rows come back decoded*/
+bool KNN::getTrainingData(int index, float features[]) const {
+    if (index < 0 || index >= currentDataSize || features == nullptr) return false;
+    copyRow(index, features);
+    return true;
+}
+
+int KNN::getClassCount() const {
+    return classCount;
+}
+
+const char *KNN::getClassLabel(int classId) const {
+    if (classId < 0 || classId >= classCount) return nullptr;
+    return classLabels[classId];
+}
+
+KNNStorageLayout KNN::getStorageLayout() const {
+    return layout;
+}
+
+KNNPrecision KNN::getStoragePrecision() const {
+    return precision;
+}
+
+int KNN::getK() const {
+    return k;
+}
+
+DistanceMetric KNN::getDistanceMetric() const {
+    return metric;
+}
+
+bool KNN::getWeightedVoting() const {
+    return useWeightedVoting;
+}
+
+bool KNN::isReadOnly() const {
+    return flashModel != nullptr;
+}
+
+size_t KNN::getMemoryUsage() const {
+    size_t usage = sizeof(KNN);
+    int onlineRows = (onlineData != nullptr) ? onlineCapacity : 0;
+    if (flashModel == nullptr) {
+        usage += (size_t) maxData * maxFeatures * elementSize() + KNN_STORE_ALIGNMENT;
+        usage += (size_t) maxData * sizeof(uint8_t);
+    } else if (onlineBlock != nullptr) {
+        usage += (size_t) 2 * onlineRows * maxFeatures * sizeof(float) + KNN_STORE_ALIGNMENT;
+        usage += (size_t) (maxData + onlineRows) * sizeof(uint8_t);
+    }
+    usage += (size_t) (maxData + onlineRows) * sizeof(DistanceIndex);
+    usage += (size_t) maxFeatures * (10 * sizeof(float) + 3 * sizeof(int32_t) + sizeof(uint16_t));
+    if (preparedBlock != nullptr) {
+        usage += (size_t) maxData * maxFeatures * sizeof(float) + KNN_STORE_ALIGNMENT;
+    }
+    if (batchNeighbors != nullptr) {
+        usage += (size_t) KNN_BATCH_TILE * (k * sizeof(DistanceIndex) + (maxFeatures + KNN_BATCH_ROWS) * sizeof(float));
+    }
+    usage += (size_t) onlineCapacity * 2 * sizeof(uint32_t);
+    return usage;
+}
+
+bool KNN::getNearestNeighbors(const float dataPoint[], int indices[], float distances[], int neighborCount) {
+    if (errorState || dataPoint == nullptr || indices == nullptr || distances == nullptr) return false;
+    if (neighborCount <= 0 || neighborCount > currentDataSize) return false;
+
+    findNearest(dataPoint, neighborCount);
+
+    for (int i = 0; i < neighborCount; i++) {
+        indices[i] = distanceBuffer[i].index;
+        distances[i] = distanceBuffer[i].distance;
+    }
+
+    return true;
+}
+
+float KNN::getPredictionConfidence(const float dataPoint[]) {
+    if (errorState || currentDataSize == 0 || dataPoint == nullptr) return 0.0f;
+
+    KNNResult result;
+    predictWithConfidence(dataPoint, result);
+    return result.confidence;
+}
+
+float KNN::evaluateAccuracy(const float **testFeatures, const char **testLabels, int testCount) {
+    if (errorState || testFeatures == nullptr || testLabels == nullptr || testCount <= 0) return 0.0f;
+
+    int correctPredictions = 0;
+    const char *predictedLabels[KNN_BATCH_TILE];
+
+    for (int start = 0; start < testCount; start += KNN_BATCH_TILE) {
+        int count = (testCount - start < KNN_BATCH_TILE) ? testCount - start : KNN_BATCH_TILE;
+        predictTile(testFeatures + start, count, predictedLabels, nullptr);
+
+        for (int i = 0; i < count; i++) {
+            if (testLabels[start + i] != nullptr && strcmp(predictedLabels[i], testLabels[start + i]) == 0) {
+                correctPredictions++;
+            }
+        }
+    }
+
+    return (float) correctPredictions / testCount;
+}
+
+/*
+ * Every fold is scored straight from the store against the rows of the
+ * other folds, so no model is copied. On ESP32 the caller and a TaskHandle
+ * task on the other core share the folds, on the host one thread per
+ * hardware thread does.
+ */
+float KNN::crossValidate(int folds) {
+    if (errorState || currentDataSize < folds || folds < 2) return 0.0f;
+
+    int *indices = new int[currentDataSize];
+    int *foldOf = new int[currentDataSize];
+    float *foldAccuracy = new float[folds];
+    if (indices == nullptr || foldOf == nullptr || foldAccuracy == nullptr) {
+        delete[] indices;
+        delete[] foldOf;
+        delete[] foldAccuracy;
+        return 0.0f;
+    }
+
+    for (int i = 0; i < currentDataSize; i++) {
+        indices[i] = i;
+    }
+
+    for (int i = 0; i < currentDataSize; i++) {
+        int j = random(currentDataSize);
+        int temp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = temp;
+    }
+
+    int foldSize = currentDataSize / folds;
+    for (int i = 0; i < currentDataSize; i++) {
+        int fold = i / foldSize;
+        foldOf[indices[i]] = (fold < folds) ? fold : folds - 1;
+    }
+    delete[] indices;
+
+    FoldCounter nextFold(0);
+    FoldWorker workers[KNN_MAX_FOLD_WORKERS];
+    int workerCount = 0;
+    int wantedWorkers = foldWorkerCount(folds);
+
+    while (workerCount < wantedWorkers) {
+        FoldWorker &worker = workers[workerCount];
+        worker.neighbors = new DistanceIndex[k];
+        worker.query = new float[4 * maxFeatures];
+        if (worker.neighbors == nullptr || worker.query == nullptr) {
+            delete[] worker.neighbors;
+            delete[] worker.query;
+            break;
+        }
+
+        worker.row = worker.query + maxFeatures;
+        worker.rangeMin = worker.query + 2 * maxFeatures;
+        worker.rangeScale = worker.query + 3 * maxFeatures;
+        worker.foldOf = foldOf;
+        worker.foldAccuracy = foldAccuracy;
+        worker.folds = folds;
+        worker.nextFold = &nextFold;
+        worker.model = this;
+        workerCount++;
+    }
+
+#if defined(ESP32)
+    /*a helper that fails to start simply leaves its folds to the others*/
+    bool started[KNN_MAX_FOLD_WORKERS] = {false};
+    TaskHandle tasks;
+    tasks.setInitCoreID(xPortGetCoreID() == 0 ? 1 : 0);
+
+    for (int w = 1; w < workerCount; w++) {
+        workers[w].done = xSemaphoreCreateBinary();
+        if (workers[w].done == nullptr) continue;
+
+        TaskHandle_t *handle = tasks.createTask(KNN_FOLD_TASK_STACK, foldTask, "knnFold", &workers[w]);
+        started[w] = (*handle != nullptr);
+        delete handle;
+        if (!started[w]) vSemaphoreDelete(workers[w].done);
+    }
+
+    if (workerCount > 0) runFoldWorker(workers[0]);
+
+    for (int w = 1; w < workerCount; w++) {
+        if (!started[w]) continue;
+        xSemaphoreTake(workers[w].done, portMAX_DELAY);
+        vSemaphoreDelete(workers[w].done);
+    }
+#elif !defined(ARDUINO)
+    std::thread threads[KNN_MAX_FOLD_WORKERS];
+    for (int w = 1; w < workerCount; w++) {
+        threads[w] = std::thread([this, &workers, w]() { runFoldWorker(workers[w]); });
+    }
+
+    if (workerCount > 0) runFoldWorker(workers[0]);
+
+    for (int w = 1; w < workerCount; w++) {
+        threads[w].join();
+    }
+#else
+    if (workerCount > 0) runFoldWorker(workers[0]);
+#endif
+
+    float totalAccuracy = 0.0f;
+    for (int fold = 0; fold < folds; fold++) {
+        totalAccuracy += foldAccuracy[fold];
+    }
+
+    for (int w = 0; w < workerCount; w++) {
+        delete[] workers[w].neighbors;
+        delete[] workers[w].query;
+    }
+    delete[] foldOf;
+    delete[] foldAccuracy;
+
+    return (workerCount > 0) ? totalAccuracy / folds : 0.0f;
+}
+
+#if defined(ESP32)
+void KNN::foldTask(void *parameter) {
+    FoldWorker *worker = (FoldWorker *) parameter;
+    worker->model->runFoldWorker(*worker);
+    xSemaphoreGive(worker->done);
+    vTaskDelete(nullptr);
+}
+#endif
+
+void KNN::runFoldWorker(FoldWorker &worker) const {
+    for (int fold = (*worker.nextFold)++; fold < worker.folds; fold = (*worker.nextFold)++) {
+        worker.foldAccuracy[fold] = evaluateFold(fold, worker);
+#if defined(ESP32)
+        /*long validations would otherwise starve the idle task watchdog*/
+        vTaskDelay(1);
+#endif
+    }
+}
+
+/*
+ * Classifies every row of one fold against the rows of the other folds,
+ * the way a model trained on those folds would: a float store normalizes
+ * with the ranges of the training folds, a quantized store keeps its
+ * fixed code range.
+ */
+float KNN::evaluateFold(int fold, FoldWorker &worker) const {
+    const int *foldOf = worker.foldOf;
+    bool floatStore = (precision == PRECISION_FLOAT32);
+
+    int trainCount = 0;
+    for (int i = 0; i < currentDataSize; i++) {
+        if (foldOf[i] != fold) trainCount++;
+    }
+
+    if (normalizationEnabled) {
+        for (int j = 0; j < maxFeatures; j++) {
+            worker.rangeMin[j] = floatStore ? FLT_MAX : featureMin[j];
+            worker.rangeScale[j] = floatStore ? -FLT_MAX : featureMax[j];
+        }
+
+        for (int i = 0; floatStore && i < currentDataSize; i++) {
+            if (foldOf[i] == fold) continue;
+            const float *row = rowPointer(i);
+            int stride = rowStride(i);
+            for (int j = 0; j < maxFeatures; j++) {
+                float value = row[j * stride];
+                if (value < worker.rangeMin[j]) worker.rangeMin[j] = value;
+                if (value > worker.rangeScale[j]) worker.rangeScale[j] = value;
+            }
+        }
+
+        for (int j = 0; j < maxFeatures; j++) {
+            float range = worker.rangeScale[j] - worker.rangeMin[j];
+            worker.rangeScale[j] = (range < 0.0001f) ? 0.0f : 1.0f / range;
+        }
+    }
+
+    int count = (k < trainCount) ? k : trainCount;
+    int testCount = 0;
+    int correctPredictions = 0;
+
+    for (int t = 0; t < currentDataSize; t++) {
+        if (foldOf[t] != fold) continue;
+        testCount++;
+
+        copyRow(t, worker.query);
+        if (normalizationEnabled) {
+            for (int j = 0; j < maxFeatures; j++) {
+                float scale = worker.rangeScale[j];
+                worker.query[j] = (scale == 0.0f) ? 0.5f : (worker.query[j] - worker.rangeMin[j]) * scale;
+            }
+        }
+
+        int filled = 0;
+        for (int i = 0; i < currentDataSize; i++) {
+            if (foldOf[i] == fold) continue;
+
+            const float *row = worker.row;
+            int stride = 1;
+            if (floatStore) {
+                row = rowPointer(i);
+                stride = rowStride(i);
+            } else {
+                copyRow(i, worker.row);
+            }
+
+            DistanceIndex candidate;
+            candidate.distance = foldDistance(worker.query, row, stride, worker);
+            candidate.index = i;
+            offerCandidate(worker.neighbors, candidate, count, filled);
+        }
+        sortHeap(worker.neighbors, count);
+
+        float classVotes[KNN_MAX_CLASSES] = {0.0f};
+        int maxVotedClass = trainingClass[worker.neighbors[0].index];
+        float nearestDistance = 0.0f;
+
+        for (int i = 0; i < count; i++) {
+            float distance = worker.neighbors[i].distance;
+            if (metric == EUCLIDEAN) distance = sqrt(distance);
+            if (i == 0) nearestDistance = distance;
+
+            int classId = trainingClass[worker.neighbors[i].index];
+            classVotes[classId] += useWeightedVoting ? 1.0f / (distance + 0.0001f) : 1.0f;
+            if (classVotes[classId] > classVotes[maxVotedClass]) {
+                maxVotedClass = classId;
+            }
+        }
+
+        if (useWeightedVoting && nearestDistance <= 0.0001f) {
+            maxVotedClass = trainingClass[worker.neighbors[0].index];
+        }
+
+        if (maxVotedClass == trainingClass[t]) {
+            correctPredictions++;
+        }
+    }
+
+    return (testCount > 0) ? (float) correctPredictions / testCount : 0.0f;
+}
+
+/*query is already normalized, Euclidean returns the squared distance*/
+float KNN::foldDistance(const float query[], const float row[], int stride, const FoldWorker &worker) const {
+    float sum = 0.0f;
+    float dotProduct = 0.0f;
+    float normA = 0.0f;
+    float normB = 0.0f;
+
+    for (int j = 0; j < maxFeatures; j++) {
+        float a = query[j];
+        float b = row[j * stride];
+
+        if (normalizationEnabled) {
+            b = (worker.rangeScale[j] == 0.0f) ? 0.5f : (b - worker.rangeMin[j]) * worker.rangeScale[j];
+        }
+
+        if (metric == COSINE) {
+            a *= featureWeight[j];
+            b *= featureWeight[j];
+            dotProduct += a * b;
+            normA += a * a;
+            normB += b * b;
+        } else {
+            float diff = a - b;
+            sum += (metric == MANHATTAN) ? abs(diff) * featureWeight[j] : diff * diff * featureWeightSq[j];
+        }
+    }
+
+    if (metric != COSINE) return sum;
+
+    normA = sqrt(normA);
+    normB = sqrt(normB);
+
+    if (normA < 0.0001f || normB < 0.0001f) return 1.0f;
+
+    float similarity = dotProduct / (normA * normB);
+
+    if (similarity > 1.0f) similarity = 1.0f;
+    if (similarity < -1.0f) similarity = -1.0f;
+
+    return 1.0f - similarity;
+}
+
+/*
+ * Leave-one-out accuracy: every row is classified by all the others, using
+ * the model's own k, metric and voting. Rows are normalized with the
+ * model's ranges, the held-out row included.
+ */
+float KNN::leaveOneOut() {
+    const DistanceMetric metrics[] = {metric};
+    const bool votings[] = {useWeightedVoting};
+    KNNLooScore score;
+
+    if (!runLeaveOneOut(metrics, 1, &k, 1, votings, 1, &score)) return 0.0f;
+    return score.accuracy;
+}
+
+/*
+ * Scores every k in kValues under each metric and both voting modes.
+ * scores receives kCount * KNN_METRIC_COUNT * 2 entries ordered metric,
+ * then voting (plain first), then k.
+ */
+bool KNN::leaveOneOutSweep(const int kValues[], int kCount, KNNLooScore scores[]) {
+    const DistanceMetric metrics[KNN_METRIC_COUNT] = {EUCLIDEAN, MANHATTAN, COSINE};
+    const bool votings[] = {false, true};
+
+    return runLeaveOneOut(metrics, KNN_METRIC_COUNT, kValues, kCount, votings, 2, scores);
+}
+
+/*
+ * The pairwise distances are symmetric, so each metric fills one packed
+ * lower triangle of n * (n - 1) / 2 floats (row i starts at i * (i - 1) / 2)
+ * and every k and voting mode is scored from it: a single pass keeps the
+ * largest k neighbours of each row, smaller k read a prefix of that list.
+ */
+bool KNN::runLeaveOneOut(const DistanceMetric metrics[], int metricCount, const int kValues[], int kCount,
+                         const bool votings[], int votingCount, KNNLooScore scores[]) {
+    if (errorState || kValues == nullptr || scores == nullptr || kCount <= 0) return false;
+
+    int n = currentDataSize;
+    if (n < 2) return false;
+
+    int maxK = 0;
+    for (int i = 0; i < kCount; i++) {
+        if (kValues[i] <= 0) return false;
+        if (kValues[i] > maxK) maxK = kValues[i];
+    }
+    if (maxK > n - 1) maxK = n - 1;
+    if (rangesDirty) refreshFeatureRanges();
+
+    float *rows = new float[(size_t) n * maxFeatures];
+    float *triangle = new float[(size_t) n * (n - 1) / 2];
+    int *correct = new int[kCount * votingCount];
+    if (rows == nullptr || triangle == nullptr || correct == nullptr) {
+        delete[] rows;
+        delete[] triangle;
+        delete[] correct;
+
+        errorState = true;
+        strncpy(errorMessage, "Memory allocation failed", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        float *row = rows + (size_t) i * maxFeatures;
+        copyRow(i, row);
+        if (!normalizationEnabled) continue;
+
+        for (int j = 0; j < maxFeatures; j++) {
+            float range = featureMax[j] - featureMin[j];
+            row[j] = (range < 0.0001f) ? 0.5f : (row[j] - featureMin[j]) * (1.0f / range);
+        }
+    }
+
+    /*calculatePreparedDistance() follows the metric member, restored below*/
+    DistanceMetric savedMetric = metric;
+
+    for (int m = 0; m < metricCount; m++) {
+        metric = metrics[m];
+
+        float *cell = triangle;
+        for (int i = 1; i < n; i++) {
+            const float *row = rows + (size_t) i * maxFeatures;
+            for (int j = 0; j < i; j++) {
+                *cell++ = calculatePreparedDistance(row, rows + (size_t) j * maxFeatures, 1, FLT_MAX);
+            }
+        }
+
+        for (int c = 0; c < kCount * votingCount; c++) {
+            correct[c] = 0;
+        }
+
+        for (int i = 0; i < n; i++) {
+            const float *below = triangle + (size_t) i * (i - 1) / 2;
+            int filled = 0;
+
+            for (int j = 0; j < n; j++) {
+                if (j == i) continue;
+
+                float distance = (j < i) ? below[j] : triangle[(size_t) j * (j - 1) / 2 + i];
+                if (filled == maxK && distance > distanceBuffer[0].distance) continue;
+
+                DistanceIndex candidate = {distance, j};
+                offerCandidate(distanceBuffer, candidate, maxK, filled);
+            }
+
+            sortHeap(distanceBuffer, maxK);
+
+            if (metric == EUCLIDEAN) {
+                for (int j = 0; j < maxK; j++) {
+                    distanceBuffer[j].distance = sqrt(distanceBuffer[j].distance);
+                }
+            }
+
+            for (int v = 0; v < votingCount; v++) {
+                for (int c = 0; c < kCount; c++) {
+                    int effectiveK = (kValues[c] < maxK) ? kValues[c] : maxK;
+
+                    KNNResult result;
+                    tallyVotes(distanceBuffer, effectiveK, votings[v], result);
+                    if (result.classId == trainingClass[i]) correct[v * kCount + c]++;
+                }
+            }
+        }
+
+        for (int v = 0; v < votingCount; v++) {
+            for (int c = 0; c < kCount; c++) {
+                KNNLooScore &score = scores[(m * votingCount + v) * kCount + c];
+                score.k = kValues[c];
+                score.metric = metrics[m];
+                score.weightedVoting = votings[v];
+                score.accuracy = (float) correct[v * kCount + c] / n;
+            }
+        }
+    }
+
+    metric = savedMetric;
+
+    delete[] rows;
+    delete[] triangle;
+    delete[] correct;
+    return true;
+}
+
+/*
+ * Picks k, metric and voting by leave-one-out accuracy and applies the
+ * winner. Metrics are scored one at a time, starting with the current
+ * one, and no new metric is started once budgetMs has passed, so at
+ * least one metric always completes. scores must hold
+ * kCount * KNN_METRIC_COUNT * 2 entries; the number filled is returned,
+ * 0 on failure. Ties keep the earlier configuration. Budget left over
+ * goes to a coordinate search over the feature weights; a weight only
+ * changes when it strictly improves best.accuracy.
+ */
+int KNN::autoTune(const int kValues[], int kCount, unsigned long budgetMs, KNNLooScore scores[], KNNLooScore &best) {
+    if (scores == nullptr || kValues == nullptr || kCount <= 0) return 0;
+
+    const bool votings[] = {useWeightedVoting, !useWeightedVoting};
+    unsigned long start = millis();
+    int filled = 0;
+
+    for (int m = 0; m < KNN_METRIC_COUNT; m++) {
+        if (m > 0 && millis() - start >= budgetMs) break;
+
+        DistanceMetric candidate = (DistanceMetric) ((metric + m) % KNN_METRIC_COUNT);
+        if (!runLeaveOneOut(&candidate, 1, kValues, kCount, votings, 2, scores + filled)) break;
+        filled += 2 * kCount;
+    }
+
+    if (filled == 0) return 0;
+
+    best = scores[0];
+    for (int i = 1; i < filled; i++) {
+        if (scores[i].accuracy > best.accuracy) best = scores[i];
+    }
+
+    setK((best.k < currentDataSize) ? best.k : currentDataSize);
+    metric = best.metric;
+    useWeightedVoting = best.weightedVoting;
+
+    const float candidates[] = {0.0f, 0.5f, 2.0f};
+    const bool voting[] = {best.weightedVoting};
+
+    for (int j = 0; j < maxFeatures && millis() - start < budgetMs; j++) {
+        float kept = featureWeight[j];
+
+        for (float weight: candidates) {
+            if (weight == kept || millis() - start >= budgetMs) continue;
+
+            KNNLooScore trial;
+            setFeatureWeight(j, weight);
+            if (runLeaveOneOut(&best.metric, 1, &best.k, 1, voting, 1, &trial) && trial.accuracy > best.accuracy) {
+                best.accuracy = trial.accuracy;
+                kept = weight;
+            }
+        }
+        setFeatureWeight(j, kept);
+    }
+    return filled;
+}
+
+bool KNN::hasError() const {
+    return errorState;
+}
+
+const char *KNN::getErrorMessage() const {
+    return errorState ? errorMessage : "No error";
+}
+
+void KNN::clearError() {
+    errorState = false;
+    errorMessage[0] = '\0';
+}
+
+#if defined(ESP32) || defined(HOST_SPIFFS)
+
+bool KNN::saveModel(const char *filename) {
+    if (errorState || filename == nullptr) return false;
+
+    /*ranges always go into the file so loading never has to rescan the rows*/
+    if (precision == PRECISION_FLOAT32 && !normalizationEnabled) {
+        calculateFeatureRanges();
+    } else if (rangesDirty) {
+        refreshFeatureRanges();
+    }
+
+    KNNModelHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = KNN_MODEL_MAGIC;
+    header.version = KNN_MODEL_VERSION;
+    header.headerSize = sizeof(KNNModelHeader);
+    header.endianTag = KNN_MODEL_ENDIAN_TAG;
+    header.featureCount = maxFeatures;
+    header.classCount = classCount;
+    header.dataCount = currentDataSize;
+    header.k = k;
+    header.metric = metric;
+    header.layout = layout;
+    header.precision = precision;
+    header.weightedVoting = useWeightedVoting;
+    header.normalization = normalizationEnabled;
+    knnModelLayoutBlocks(header, KNN_MAX_LABEL_CHAR, elementSize());
+
+    const uint8_t *store = (precision == PRECISION_FLOAT32) ? (const uint8_t *) trainingData : codeData;
+    size_t columnBytes = (size_t) storeRows() * elementSize();
+    size_t storeBytes = columnBytes * maxFeatures;
+    int storeBlocks = (layout == COLUMN_MAJOR) ? maxFeatures : 1;
+    size_t blockBytes = (layout == COLUMN_MAJOR) ? columnBytes : storeBytes;
+    size_t blockStride = (size_t) maxData * elementSize();
+
+    /*a flash model's online rows follow its flash rows in every block, one value per run when column-major*/
+    int onlineRows = currentDataSize - storeRows();
+    int onlineRuns = (layout == COLUMN_MAJOR) ? onlineRows : (onlineRows > 0 ? 1 : 0);
+    size_t runBytes = (layout == COLUMN_MAJOR) ? sizeof(float) : (size_t) onlineRows * maxFeatures * sizeof(float);
+    int runStep = (layout == COLUMN_MAJOR) ? maxFeatures : 0;
+
+    uint32_t crc = knnModelCrc32(0, &header, sizeof(header));
+    crc = knnModelCrc32(crc, classLabels, (size_t) classCount * KNN_MAX_LABEL_CHAR);
+    crc = knnModelCrc32(crc, featureMin, maxFeatures * sizeof(float));
+    crc = knnModelCrc32(crc, featureMax, maxFeatures * sizeof(float));
+    crc = knnModelCrc32(crc, featureWeight, maxFeatures * sizeof(float));
+    crc = knnModelCrc32(crc, trainingClass, currentDataSize);
+    for (int b = 0; b < storeBlocks; b++) {
+        crc = knnModelCrc32(crc, store + b * blockStride, blockBytes);
+        for (int r = 0; r < onlineRuns; r++) {
+            crc = knnModelCrc32(crc, onlineData + (size_t) r * runStep + b, runBytes);
+        }
+    }
+    header.crc = crc;
+
+    File file = SPIFFS.open(filename, "w");
+    if (!file) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to open file for writing", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    static const uint8_t padding[KNN_MODEL_BLOCK_ALIGNMENT] = {0};
+    size_t written = file.write((const uint8_t *) &header, sizeof(header));
+    written += file.write((const uint8_t *) classLabels, (size_t) classCount * KNN_MAX_LABEL_CHAR);
+    written += file.write(padding, header.rangeOffset - written);
+    written += file.write((const uint8_t *) featureMin, maxFeatures * sizeof(float));
+    written += file.write((const uint8_t *) featureMax, maxFeatures * sizeof(float));
+    written += file.write((const uint8_t *) featureWeight, maxFeatures * sizeof(float));
+    written += file.write(trainingClass, currentDataSize);
+    written += file.write(padding, header.featureOffset - written);
+    for (int b = 0; b < storeBlocks; b++) {
+        written += file.write(store + b * blockStride, blockBytes);
+        for (int r = 0; r < onlineRuns; r++) {
+            written += file.write((const uint8_t *) (onlineData + (size_t) r * runStep + b), runBytes);
+        }
+    }
+    file.close();
+
+    if (written != header.fileSize) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to write model", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+    return true;
+}
+
+/*
+ * CRC of a span of the file, read through a stack buffer. With classCount
+ * set, every byte also has to be a class id below it.
+ */
+static bool knnFileCrc(File &file, uint32_t offset, size_t bytes, uint32_t &crc, int classCount = -1) {
+    uint8_t buffer[64];
+    if (!file.seek(offset)) return false;
+    while (bytes > 0) {
+        size_t chunk = bytes < sizeof(buffer) ? bytes : sizeof(buffer);
+        if (file.read(buffer, chunk) != chunk) return false;
+        for (size_t i = 0; classCount >= 0 && i < chunk; i++) {
+            if (buffer[i] >= classCount) return false;
+        }
+        crc = knnModelCrc32(crc, buffer, chunk);
+        bytes -= chunk;
+    }
+    return true;
+}
+
+/*
+ * Checks the header and the CRC of the whole file before anything is
+ * touched, so a rejected or corrupt file leaves the current model in
+ * place. Only then are the blocks read straight into the store, class ids
+ * and ranges. The file has to match this model's feature count, layout
+ * and precision and fit in maxData rows; k, metric, voting, normalization
+ * and feature weights are taken from the file. Version 1 files carry no
+ * weights and load with every weight at 1.
+ */
+bool KNN::loadModel(const char *filename) {
+    if (filename == nullptr) return false;
+
+    if (flashModel != nullptr) {
+        errorState = true;
+        strncpy(errorMessage, "Flash model is read-only", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    File file = SPIFFS.open(filename, "r");
+    if (!file) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to open file for reading", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    const char *failure = nullptr;
+    KNNModelHeader header;
+    if (file.read((uint8_t *) &header, sizeof(header)) != sizeof(header) || header.magic != KNN_MODEL_MAGIC) {
+        failure = "Not a KNN model file";
+    } else if (header.endianTag != KNN_MODEL_ENDIAN_TAG) {
+        failure = "Model byte order mismatch";
+    } else if (header.version > KNN_MODEL_VERSION || header.headerSize < sizeof(header)) {
+        failure = "Unsupported model version";
+    } else if (header.featureCount != maxFeatures || header.dataCount > (uint32_t) maxData ||
+               header.classCount > KNN_MAX_CLASSES || (header.dataCount > 0 && header.classCount == 0) ||
+               header.k == 0 || header.k > maxData || header.metric > COSINE) {
+        failure = "Incompatible model dimensions";
+    } else if (header.layout != layout || header.precision != precision) {
+        failure = "Incompatible model storage";
+    }
+
+    /*dimensions are checked, so every size below fits the buffers*/
+    uint8_t *store = (precision == PRECISION_FLOAT32) ? (uint8_t *) trainingData : codeData;
+    size_t columnBytes = (size_t) header.dataCount * elementSize();
+    int storeBlocks = (layout == COLUMN_MAJOR) ? maxFeatures : 1;
+    size_t blockBytes = (layout == COLUMN_MAJOR) ? columnBytes : columnBytes * maxFeatures;
+    size_t blockStride = (size_t) maxData * elementSize();
+    size_t labelBytes = (size_t) header.classCount * KNN_MAX_LABEL_CHAR;
+    size_t rangeBytes = maxFeatures * sizeof(float);
+    float *weights = featureWeight + 2 * maxFeatures;
+
+    if (failure == nullptr) {
+        uint32_t expected = header.crc;
+        header.crc = 0;
+        uint32_t crc = knnModelCrc32(0, &header, sizeof(header));
+        header.crc = expected;
+
+        bool complete = knnFileCrc(file, header.labelOffset, labelBytes, crc) &&
+                        knnFileCrc(file, header.rangeOffset, 2 * rangeBytes, crc) &&
+                        (header.weightOffset == 0 || knnFileCrc(file, header.weightOffset, rangeBytes, crc)) &&
+                        knnFileCrc(file, header.classOffset, header.dataCount, crc, header.classCount) &&
+                        knnFileCrc(file, header.featureOffset, blockBytes * storeBlocks, crc);
+
+        if (!complete) {
+            failure = "Model file truncated";
+        } else if (crc != expected) {
+            failure = "Model checksum mismatch";
+        }
+    }
+
+    if (failure == nullptr) {
+        clearTrainingData();
+
+        bool complete = file.seek(header.labelOffset) &&
+                        file.read((uint8_t *) classLabels, labelBytes) == labelBytes &&
+                        file.seek(header.rangeOffset) &&
+                        file.read((uint8_t *) featureMin, rangeBytes) == rangeBytes &&
+                        file.read((uint8_t *) featureMax, rangeBytes) == rangeBytes &&
+                        (header.weightOffset == 0 || (file.seek(header.weightOffset) &&
+                                                      file.read((uint8_t *) weights, rangeBytes) == rangeBytes)) &&
+                        file.seek(header.classOffset) &&
+                        file.read(trainingClass, header.dataCount) == header.dataCount &&
+                        file.seek(header.featureOffset);
+        for (int b = 0; complete && b < storeBlocks; b++) {
+            complete = file.read(store + b * blockStride, blockBytes) == blockBytes;
+        }
+
+        if (!complete) {
+            /*the file changed under the check, what was read is not kept*/
+            failure = "Model file truncated";
+        } else {
+            for (int i = 0; i < header.classCount; i++) {
+                classLabels[i][KNN_MAX_LABEL_CHAR - 1] = '\0';
+            }
+            setK(header.k);
+            metric = (DistanceMetric) header.metric;
+            useWeightedVoting = header.weightedVoting != 0;
+            normalizationEnabled = header.normalization != 0;
+            classCount = header.classCount;
+            currentDataSize = header.dataCount;
+            quantRangeSet = true;
+            preparedDirty = true;
+            indexDirty = true;
+            rangesDirty = false;
+            for (int j = 0; j < maxFeatures; j++) {
+                featureMinCount[j] = -1;
+                featureMaxCount[j] = -1;
+            }
+
+            /*weights were read into the coefficient scratch, negative ones fall back to 1*/
+            for (int j = 0; j < maxFeatures; j++) {
+                setFeatureWeight(j, (header.weightOffset != 0 && weights[j] >= 0.0f) ? weights[j] : 1.0f);
+            }
+        }
+    }
+
+    file.close();
+
+    if (failure != nullptr) {
+        errorState = true;
+        strncpy(errorMessage, failure, 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Delta save of the online region: only slots changed since the last save
+ * are written, each at its fixed offset in the journal. A missing or
+ * incompatible journal is rewritten whole, which is still bounded by the
+ * ring capacity rather than by the model.
+ */
+bool KNN::saveOnlineSamples(const char *filename) {
+    if (errorState || filename == nullptr) return false;
+
+    if (onlineCapacity == 0) {
+        errorState = true;
+        strncpy(errorMessage, "Online learning not enabled", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    uint32_t recordSize = knnOnlineRecordSize(maxFeatures, KNN_MAX_LABEL_CHAR);
+    size_t featureBytes = maxFeatures * sizeof(float);
+    size_t labelPadding = recordSize - 2 * sizeof(uint32_t) - KNN_MAX_LABEL_CHAR - featureBytes;
+    bool rewrite = onlineRewrite || !SPIFFS.exists(filename);
+
+    File file = SPIFFS.open(filename, rewrite ? "w" : "r+");
+    if (!file) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to open file for writing", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+
+    bool complete = true;
+    if (rewrite) {
+        KNNOnlineHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = KNN_ONLINE_MAGIC;
+        header.version = KNN_ONLINE_VERSION;
+        header.headerSize = sizeof(KNNOnlineHeader);
+        header.endianTag = KNN_MODEL_ENDIAN_TAG;
+        header.featureCount = maxFeatures;
+        header.recordSize = recordSize;
+        header.capacity = onlineCapacity;
+        header.crc = knnModelCrc32(0, &header, sizeof(header));
+        complete = file.write((const uint8_t *) &header, sizeof(header)) == sizeof(header);
+    }
+
+    static const uint8_t padding[KNN_MAX_LABEL_CHAR] = {0};
+    for (int s = 0; complete && s < onlineCapacity; s++) {
+        if (!rewrite && onlineSequence[s] == onlineSaved[s]) continue;
+
+        uint32_t record[2] = {onlineSequence[s], 0};
+        const char *label = (const char *) padding;
+        if (s < onlineCount) {
+            label = classLabels[trainingClass[baseDataCount + s]];
+            copyRow(baseDataCount + s, rowBuffer);
+        } else {
+            memset(rowBuffer, 0, featureBytes);
+        }
+        record[1] = knnModelCrc32(0, &record[0], sizeof(uint32_t));
+        record[1] = knnModelCrc32(record[1], label, KNN_MAX_LABEL_CHAR);
+        record[1] = knnModelCrc32(record[1], rowBuffer, featureBytes);
+
+        size_t written = 0;
+        complete = file.seek(sizeof(KNNOnlineHeader) + (uint32_t) s * recordSize);
+        if (complete) {
+            written += file.write((const uint8_t *) record, sizeof(record));
+            written += file.write((const uint8_t *) label, KNN_MAX_LABEL_CHAR);
+            written += file.write(padding, labelPadding);
+            written += file.write((const uint8_t *) rowBuffer, featureBytes);
+            complete = written == recordSize;
+        }
+        if (complete) onlineSaved[s] = onlineSequence[s];
+    }
+    file.close();
+
+    onlineRewrite = !complete;
+    if (!complete) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to write online samples", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Replays the journal into the empty online region, so a boot costs at
+ * most one row per slot however long the device has been learning.
+ * Records failing their CRC are skipped and overwritten by the next save.
+ * A journal written with another capacity keeps its newest samples and is
+ * rewritten whole next time. Returns the samples restored, -1 if the
+ * journal cannot be used.
+ */
+int KNN::loadOnlineSamples(const char *filename) {
+    if (errorState || filename == nullptr) return -1;
+
+    if (onlineCapacity == 0 || onlineCount > 0) {
+        errorState = true;
+        strncpy(errorMessage, onlineCapacity == 0 ? "Online learning not enabled" : "Online region not empty", 49);
+        errorMessage[49] = '\0';
+        return -1;
+    }
+
+    onlineRewrite = true;
+    File file = SPIFFS.open(filename, "r");
+    if (!file) {
+        errorState = true;
+        strncpy(errorMessage, "Failed to open file for reading", 49);
+        errorMessage[49] = '\0';
+        return -1;
+    }
+
+    uint32_t recordSize = knnOnlineRecordSize(maxFeatures, KNN_MAX_LABEL_CHAR);
+    size_t featureBytes = maxFeatures * sizeof(float);
+    const char *failure = nullptr;
+    KNNOnlineHeader header;
+    if (file.read((uint8_t *) &header, sizeof(header)) != sizeof(header) || header.magic != KNN_ONLINE_MAGIC) {
+        failure = "Not a KNN online journal";
+    } else if (header.endianTag != KNN_MODEL_ENDIAN_TAG) {
+        failure = "Journal byte order mismatch";
+    } else if (header.version > KNN_ONLINE_VERSION || header.headerSize < sizeof(header)) {
+        failure = "Unsupported journal version";
+    } else if (header.featureCount != maxFeatures || header.recordSize != recordSize) {
+        failure = "Incompatible online journal";
+    } else {
+        uint32_t expected = header.crc;
+        header.crc = 0;
+        if (knnModelCrc32(0, &header, sizeof(header)) != expected) failure = "Journal checksum mismatch";
+    }
+
+    char label[KNN_MAX_LABEL_CHAR];
+    uint32_t newest = 0;
+    bool complete = true;
+    for (uint32_t p = 0; failure == nullptr && complete && p < header.capacity; p++) {
+        uint32_t offset = header.headerSize + p * recordSize;
+        uint32_t record[2];
+        complete = file.seek(offset) && file.read((uint8_t *) record, sizeof(record)) == sizeof(record) &&
+                   file.read((uint8_t *) label, KNN_MAX_LABEL_CHAR) == KNN_MAX_LABEL_CHAR &&
+                   file.seek(offset + recordSize - featureBytes) &&
+                   file.read((uint8_t *) queryBuffer, featureBytes) == featureBytes;
+        if (!complete) break;
+
+        uint32_t crc = knnModelCrc32(0, &record[0], sizeof(uint32_t));
+        crc = knnModelCrc32(crc, label, KNN_MAX_LABEL_CHAR);
+        crc = knnModelCrc32(crc, queryBuffer, featureBytes);
+        bool valid = record[0] != 0 && crc == record[1];
+        if (p < (uint32_t) onlineCapacity) onlineSaved[p] = (valid || record[0] == 0) ? record[0] : ~0u;
+        if (!valid) continue;
+
+        label[KNN_MAX_LABEL_CHAR - 1] = '\0';
+        int classId = internLabel(label);
+        if (classId < 0) continue;
+
+        /*a full ring only takes a record newer than its oldest sample*/
+        int slot = onlineCount;
+        if (onlineCount == onlineCapacity) {
+            slot = 0;
+            for (int s = 1; s < onlineCount; s++) {
+                if (onlineSequence[s] < onlineSequence[slot]) slot = s;
+            }
+            if (onlineSequence[slot] >= record[0]) continue;
+        }
+        placeOnline(slot, classId, queryBuffer, record[0]);
+        if (record[0] > newest) newest = record[0];
+    }
+    file.close();
+
+    if (failure != nullptr) {
+        errorState = true;
+        strncpy(errorMessage, failure, 49);
+        errorMessage[49] = '\0';
+        return -1;
+    }
+
+    onlineClock = newest + 1;
+    onlineHead = 0;
+    for (int s = 1; s < onlineCount; s++) {
+        if (onlineSequence[s] < onlineSequence[onlineHead]) onlineHead = s;
+    }
+    onlineRewrite = !complete || header.capacity != (uint32_t) onlineCapacity;
+    return onlineCount;
+}
+
+#endif
+
+void KNN::computeDistances(const float dataPoint[]) {
+    int rows = storeRows();
+
+    /*a flash model's online rows are contiguous, they always take the row kernels*/
+    for (int i = rows; i < currentDataSize; i++) {
+        distanceBuffer[i].distance = calculateDistance(dataPoint, rowPointer(i), 1);
+        distanceBuffer[i].index = i;
+    }
+
+    if (layout == COLUMN_MAJOR && metric != COSINE) {
+        for (int i = 0; i < rows; i++) {
+            distanceBuffer[i].distance = 0.0f;
+            distanceBuffer[i].index = i;
+        }
+
+        for (int j = 0; j < maxFeatures; j++) {
+            const float *column = trainingData + (size_t) j * maxData;
+            float a = dataPoint[j];
+            float coef = featureCoef[j];
+
+            for (int i = 0; i < rows; i++) {
+                float diff = (a - column[i]) * coef;
+                distanceBuffer[i].distance += (metric == MANHATTAN) ? abs(diff) : diff * diff;
+            }
+        }
+
+        if (metric == EUCLIDEAN) {
+            for (int i = 0; i < rows; i++) {
+                distanceBuffer[i].distance = sqrt(distanceBuffer[i].distance);
+            }
+        }
+        return;
+    }
+
+    int stride = featureStride();
+    int rowStep = (layout == COLUMN_MAJOR) ? 1 : maxFeatures;
+    const float *row = trainingData;
+    for (int i = 0; i < rows; i++, row += rowStep) {
+        distanceBuffer[i].distance = calculateDistance(dataPoint, row, stride);
+        distanceBuffer[i].index = i;
+    }
+}
+
+/*
+ * Leaves the count nearest entries of distanceBuffer in its head, sorted
+ * nearest first. The head is kept as a bounded max-heap while the rest of
+ * the buffer streams past it, so the cost is O(n log count) instead of a
+ * full sort of every training row.
+ */
+void KNN::selectNearest(int count) {
+    if (count <= 0) return;
+
+    buildHeap(distanceBuffer, count);
+
+    for (int i = count; i < currentDataSize; i++) {
+        if (isFarther(distanceBuffer[0], distanceBuffer[i])) {
+            distanceBuffer[0] = distanceBuffer[i];
+            siftDown(distanceBuffer, 0, count);
+        }
+    }
 
-    for (int i = 0; i < neighborCount; i++) {
-        indices[i] = distanceBuffer[i].index;
-        distances[i] = distanceBuffer[i].distance;
+    sortHeap(distanceBuffer, count);
+}
+
+void KNN::buildHeap(DistanceIndex *heap, int count) {
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        siftDown(heap, i, count);
     }
+}
 
-    return true;
+void KNN::sortHeap(DistanceIndex *heap, int count) {
+    for (int size = count - 1; size > 0; size--) {
+        DistanceIndex farthest = heap[0];
+        heap[0] = heap[size];
+        heap[size] = farthest;
+        siftDown(heap, 0, size);
+    }
 }
 
-float KNN::getPredictionConfidence(const float dataPoint[]) {
-    if (errorState || currentDataSize == 0 || dataPoint == nullptr) return 0.0f;
+void KNN::siftDown(DistanceIndex *heap, int root, int size) {
+    DistanceIndex item = heap[root];
 
-    for (int i = 0; i < currentDataSize; i++) {
-        voteBuffer[i] = 0;
-        distanceBuffer[i].distance = calculateDistance(dataPoint, trainingData[i]);
-        distanceBuffer[i].index = i;
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) break;
+        if (child + 1 < size && isFarther(heap[child + 1], heap[child])) child++;
+        if (!isFarther(heap[child], item)) break;
+
+        heap[root] = heap[child];
+        root = child;
     }
 
-    qsort(distanceBuffer, currentDataSize, sizeof(DistanceIndex), compareDistances);
+    heap[root] = item;
+}
+
+void KNN::findNearest(const float dataPoint[], int count) {
+    if (preparedDirty) prepareFastSearch();
 
-    int effectiveK = (k > currentDataSize) ? currentDataSize : k;
+    if (precision != PRECISION_FLOAT32) {
+        searchQuantized(dataPoint, count);
+        return;
+    }
+
+    if (!fastSearchEnabled) {
+        computeDistances(dataPoint);
+        selectNearest(count);
+        return;
+    }
 
-    if (useWeightedVoting) {
-        float totalWeight = 0.0f;
-        float maxWeight = 0.0f;
-        int maxIndex = -1;
+    for (int j = 0; j < maxFeatures; j++) {
+        if (!normalizationEnabled) queryBuffer[j] = dataPoint[j];
+        else if (featureScale[j] == 0.0f) queryBuffer[j] = 0.5f;
+        else queryBuffer[j] = (dataPoint[j] - featureMin[j]) * featureScale[j];
+    }
 
-        auto *labelWeights = new float[currentDataSize];
-        if (labelWeights == nullptr) return 0.0f;
+    searchPrepared(count);
 
-        for (int i = 0; i < currentDataSize; i++) {
-            labelWeights[i] = 0.0f;
+    if (metric == EUCLIDEAN) {
+        for (int i = 0; i < count; i++) {
+            distanceBuffer[i].distance = sqrt(distanceBuffer[i].distance);
         }
+    }
+}
 
-        for (int i = 0; i < effectiveK; i++) {
-            int idx = distanceBuffer[i].index;
-            float distance = distanceBuffer[i].distance;
-            float weight = 1.0f / (distance + 0.0001f);
+void KNN::searchPrepared(int count) {
+    const float *data = searchData();
+    int rows = storeRows();
+
+    if (layout == COLUMN_MAJOR && metric != COSINE) {
+        for (int i = 0; i < rows; i++) {
+            distanceBuffer[i].distance = 0.0f;
+            distanceBuffer[i].index = i;
+        }
 
-            labelWeights[idx] += weight;
-            totalWeight += weight;
+        for (int j = 0; j < maxFeatures; j++) {
+            const float *column = data + (size_t) j * maxData;
+            float q = queryBuffer[j];
 
-            if (labelWeights[idx] > maxWeight) {
-                maxWeight = labelWeights[idx];
-                maxIndex = idx;
+            if (metric == MANHATTAN) {
+                float weight = featureWeight[j];
+                for (int i = 0; i < rows; i++) {
+                    distanceBuffer[i].distance += abs(q - column[i]) * weight;
+                }
+            } else {
+                float weight = featureWeightSq[j];
+                for (int i = 0; i < rows; i++) {
+                    float diff = q - column[i];
+                    distanceBuffer[i].distance += diff * diff * weight;
+                }
             }
         }
 
-        float confidence = (totalWeight > 0.0f) ? (maxWeight / totalWeight) : 0.0f;
-        delete[] labelWeights;
-        return confidence;
-    } else {
-        int totalVotes = 0;
-        int maxVotes = 0;
+        const float *row = normalizationEnabled ? onlinePrepared : onlineData;
+        for (int i = rows; i < currentDataSize; i++, row += maxFeatures) {
+            distanceBuffer[i].distance = calculatePreparedDistance(queryBuffer, row, 1, FLT_MAX);
+            distanceBuffer[i].index = i;
+        }
 
-        for (int i = 0; i < effectiveK; i++) {
-            int idx = distanceBuffer[i].index;
-            voteBuffer[idx]++;
-            totalVotes++;
+        selectNearest(count);
+        return;
+    }
 
-            if (voteBuffer[idx] > maxVotes) {
-                maxVotes = voteBuffer[idx];
-            }
-        }
+    int filled = 0;
 
-        return (float) maxVotes / totalVotes;
+    if (useIndex()) {
+        if (indexDirty) buildIndex();
+        searchIndexNode(0, count, filled);
+        searchOnline(queryBuffer, distanceBuffer, count, filled);
+        sortHeap(distanceBuffer, count);
+        return;
     }
-}
 
-float KNN::evaluateAccuracy(const float **testFeatures, const char **testLabels, int testCount) {
-    if (errorState || testFeatures == nullptr || testLabels == nullptr || testCount <= 0) return 0.0f;
+    int stride = featureStride();
+    int rowStep = (layout == COLUMN_MAJOR) ? 1 : maxFeatures;
+    const float *row = data;
 
-    int correctPredictions = 0;
+    for (int i = 0; i < rows; i++, row += rowStep) {
+        float bound = (filled == count) ? distanceBuffer[0].distance : FLT_MAX;
+        float distance = calculatePreparedDistance(queryBuffer, row, stride, bound);
+        if (distance > bound) continue;
 
-    for (int i = 0; i < testCount; i++) {
-        const char *predictedLabel = predict(testFeatures[i]);
-        if (strcmp(predictedLabel, testLabels[i]) == 0) {
-            correctPredictions++;
-        }
+        DistanceIndex candidate = {distance, i};
+        offerCandidate(distanceBuffer, candidate, count, filled);
     }
 
-    return (float) correctPredictions / testCount;
+    searchOnline(queryBuffer, distanceBuffer, count, filled);
+    sortHeap(distanceBuffer, count);
 }
 
-float KNN::crossValidate(int folds) {
-    if (errorState || currentDataSize < folds || folds < 2) return 0.0f;
+/*offers the online rows of a flash model to a top-k heap, query already prepared*/
+void KNN::searchOnline(const float query[], DistanceIndex *heap, int count, int &filled) const {
+    const float *row = normalizationEnabled ? onlinePrepared : onlineData;
 
-    int *indices = new int[currentDataSize];
-    if (indices == nullptr) return 0.0f;
+    for (int i = storeRows(); i < currentDataSize; i++, row += maxFeatures) {
+        float bound = (filled == count) ? heap[0].distance : FLT_MAX;
+        float distance = calculatePreparedDistance(query, row, 1, bound);
+        if (distance > bound) continue;
 
-    for (int i = 0; i < currentDataSize; i++) {
-        indices[i] = i;
+        DistanceIndex candidate = {distance, i};
+        offerCandidate(heap, candidate, count, filled);
     }
+}
 
-    for (int i = 0; i < currentDataSize; i++) {
-        int j = random(currentDataSize);
-        int temp = indices[i];
-        indices[i] = indices[j];
-        indices[j] = temp;
+/*pushes a row into the top-k heap held in the head of distanceBuffer*/
+void KNN::offerCandidate(DistanceIndex *heap, const DistanceIndex &candidate, int count, int &filled) {
+    if (filled < count) {
+        heap[filled++] = candidate;
+        if (filled == count) buildHeap(heap, count);
+    } else if (isFarther(heap[0], candidate)) {
+        heap[0] = candidate;
+        siftDown(heap, 0, count);
     }
+}
 
-    int foldSize = currentDataSize / folds;
-    float totalAccuracy = 0.0f;
+bool KNN::useIndex() const {
+    if (!indexEnabled || metric == COSINE || precision != PRECISION_FLOAT32) return false;
+    return currentDataSize >= ((metric == MANHATTAN) ? KNN_INDEX_MIN_DATA_MANHATTAN : KNN_INDEX_MIN_DATA);
+}
 
-    for (int fold = 0; fold < folds; fold++) {
-        KNN tempModel(k, maxFeatures, currentDataSize);
-        tempModel.setDistanceMetric(metric);
-        tempModel.setWeightedVoting(useWeightedVoting);
-        tempModel.enableNormalization(normalizationEnabled);
+float KNN::indexValue(int row, int feature) const {
+    const float *data = searchData();
+    if (layout == COLUMN_MAJOR) return data[(size_t) feature * maxData + row];
+    return data[(size_t) row * maxFeatures + feature];
+}
+
+/*splits on the widest feature at its median, leaves keep up to KNN_INDEX_LEAF_SIZE rows*/
+int KNN::buildIndexNode(int start, int count) {
+    int node = indexNodeCount++;
+    IndexNode &current = indexNodes[node];
+    current.start = start;
+    current.count = count;
+    current.left = -1;
+    current.right = -1;
+    current.splitFeature = 0;
+    current.splitValue = 0.0f;
+
+    if (count <= KNN_INDEX_LEAF_SIZE || indexNodeCount + 2 > indexMaxNodes) return node;
+
+    int splitFeature = 0;
+    float widestSpread = -1.0f;
+    for (int j = 0; j < maxFeatures; j++) {
+        float low = indexValue(indexOrder[start], j);
+        float high = low;
+        for (int i = start + 1; i < start + count; i++) {
+            float value = indexValue(indexOrder[i], j);
+            if (value < low) low = value;
+            if (value > high) high = value;
+        }
+        if (high - low > widestSpread) {
+            widestSpread = high - low;
+            splitFeature = j;
+        }
+    }
 
-        int testStart = fold * foldSize;
-        int testEnd = (fold == folds - 1) ? currentDataSize : (fold + 1) * foldSize;
+    if (widestSpread <= 0.0f) return node;
 
-        for (int i = 0; i < currentDataSize; i++) {
-            int idx = indices[i];
-            if (i >= testStart && i < testEnd) continue;
+    int half = count / 2;
+    partitionIndex(start, count, half, splitFeature);
 
-            tempModel.addTrainingData(trainingLabels[idx], trainingData[idx]);
-        }
+    indexNodes[node].splitFeature = splitFeature;
+    indexNodes[node].splitValue = indexValue(indexOrder[start + half], splitFeature);
 
-        int correctPredictions = 0;
-        int testCount = testEnd - testStart;
+    int left = buildIndexNode(start, half);
+    int right = buildIndexNode(start + half, count - half);
+    indexNodes[node].left = left;
+    indexNodes[node].right = right;
+    return node;
+}
 
-        for (int i = testStart; i < testEnd; i++) {
-            int idx = indices[i];
-            const char *predictedLabel = tempModel.predict(trainingData[idx]);
-            if (strcmp(predictedLabel, trainingLabels[idx]) == 0) {
-                correctPredictions++;
+/*quickselect on indexOrder so the nth row holds the median of feature*/
+void KNN::partitionIndex(int start, int count, int nth, int feature) {
+    int low = start;
+    int high = start + count - 1;
+    int target = start + nth;
+
+    while (low < high) {
+        float pivot = indexValue(indexOrder[(low + high) / 2], feature);
+        int i = low;
+        int j = high;
+
+        while (i <= j) {
+            while (indexValue(indexOrder[i], feature) < pivot) i++;
+            while (indexValue(indexOrder[j], feature) > pivot) j--;
+            if (i <= j) {
+                int temp = indexOrder[i];
+                indexOrder[i] = indexOrder[j];
+                indexOrder[j] = temp;
+                i++;
+                j--;
             }
         }
 
-        totalAccuracy += (float) correctPredictions / testCount;
+        if (target <= j) high = j;
+        else if (target >= i) low = i;
+        else break;
     }
-
-    delete[] indices;
-    return totalAccuracy / folds;
 }
 
-bool KNN::hasError() const {
-    return errorState;
+void KNN::searchIndexNode(int node, int count, int &filled) {
+    const IndexNode &current = indexNodes[node];
+
+    if (current.left < 0) {
+        int stride = featureStride();
+        const float *data = searchData();
+
+        for (int i = current.start; i < current.start + current.count; i++) {
+            int index = indexOrder[i];
+            const float *row = data + (layout == COLUMN_MAJOR ? index : (size_t) index * maxFeatures);
+            float bound = (filled == count) ? distanceBuffer[0].distance : FLT_MAX;
+            float distance = calculatePreparedDistance(queryBuffer, row, stride, bound);
+            if (distance > bound) continue;
+
+            DistanceIndex candidate = {distance, index};
+            offerCandidate(distanceBuffer, candidate, count, filled);
+        }
+        return;
+    }
+
+    float planeDistance = queryBuffer[current.splitFeature] - current.splitValue;
+    int nearChild = (planeDistance < 0.0f) ? current.left : current.right;
+    int farChild = (planeDistance < 0.0f) ? current.right : current.left;
+
+    searchIndexNode(nearChild, count, filled);
+
+    float planeBound = (metric == MANHATTAN) ? abs(planeDistance) * featureWeight[current.splitFeature]
+                                             : planeDistance * planeDistance * featureWeightSq[current.splitFeature];
+    if (filled < count || planeBound <= distanceBuffer[0].distance) {
+        searchIndexNode(farChild, count, filled);
+    }
 }
 
-const char *KNN::getErrorMessage() const {
-    return errorState ? errorMessage : "No error";
+/*
+ * Refreshes the cached reciprocal ranges and kernel coefficients, then
+ * re-normalizes the prepared rows when fast search keeps its own copy.
+ */
+void KNN::prepareFastSearch() {
+    if (rangesDirty) refreshFeatureRanges();
+
+    for (int j = 0; j < maxFeatures; j++) {
+        float range = featureMax[j] - featureMin[j];
+        featureScale[j] = (range < 0.0001f) ? 0.0f : 1.0f / range;
+
+        float scale = normalizationEnabled ? featureScale[j] : 1.0f;
+        float bias = 0.0f;
+        if (normalizationEnabled) bias = (featureScale[j] == 0.0f) ? 0.5f : -featureMin[j] * featureScale[j];
+
+        featureCoef[j] = featureWeight[j] * scale;
+        featureCoefSq[j] = featureCoef[j] * featureCoef[j];
+        featureOffset[j] = featureWeight[j] * bias;
+    }
+
+    /*borrowed prepared rows stay as they are, a flash model's online rows are redone*/
+    int first = (preparedBlock != nullptr) ? 0 : storeRows();
+    for (int i = first; normalizationEnabled && i < currentDataSize; i++) {
+        copyRow(i, rowBuffer);
+        storePreparedRow(i, rowBuffer);
+    }
+
+    preparedDirty = false;
+    indexDirty = true;
 }
 
-void KNN::clearError() {
-    errorState = false;
-    errorMessage[0] = '\0';
+void KNN::storePreparedRow(int index, const float features[]) {
+    bool online = onlineData != nullptr && index >= baseDataCount;
+    if (!normalizationEnabled || (preparedBlock == nullptr && !online)) return;
+
+    float *row = preparedData + (layout == COLUMN_MAJOR ? index : (size_t) index * maxFeatures);
+    int stride = featureStride();
+    if (online) {
+        row = onlinePrepared + (size_t) (index - baseDataCount) * maxFeatures;
+        stride = 1;
+    }
+    for (int j = 0; j < maxFeatures; j++) {
+        row[j * stride] = (featureScale[j] == 0.0f) ? 0.5f : (features[j] - featureMin[j]) * featureScale[j];
+    }
 }
 
-#ifdef ESP32
+const float *KNN::searchData() const {
+    return normalizationEnabled ? preparedData : trainingData;
+}
 
-bool KNN::saveModel(const char *filename) {
-    if (errorState || filename == nullptr) return false;
+/*
+ * Sets the per-feature range a quantized store maps onto its codes. Rows
+ * added later are clamped to it, so it has to be set before the first
+ * row goes in.
+ */
+bool KNN::setQuantizationRange(const float minValues[], const float maxValues[]) {
+    if (precision == PRECISION_FLOAT32 || minValues == nullptr || maxValues == nullptr) return false;
 
-    File file = SPIFFS.open(filename, "w");
-    if (!file) {
+    if (currentDataSize > 0) {
         errorState = true;
-        strncpy(errorMessage, "Failed to open file for writing", 49);
+        strncpy(errorMessage, "Quantization range is locked", 49);
         errorMessage[49] = '\0';
         return false;
     }
 
-    file.write((uint8_t *) &k, sizeof(int));
-    file.write((uint8_t *) &maxFeatures, sizeof(int));
-    file.write((uint8_t *) &maxData, sizeof(int));
-    file.write((uint8_t *) &currentDataSize, sizeof(int));
-    file.write((uint8_t *) &metric, sizeof(DistanceMetric));
-    file.write((uint8_t *) &useWeightedVoting, sizeof(bool));
-    file.write((uint8_t *) &normalizationEnabled, sizeof(bool));
-
-    if (normalizationEnabled) {
-        file.write((uint8_t *) featureMin, maxFeatures * sizeof(float));
-        file.write((uint8_t *) featureMax, maxFeatures * sizeof(float));
-    }
-
-    for (int i = 0; i < currentDataSize; i++) {
-        file.write((uint8_t *) trainingData[i], maxFeatures * sizeof(float));
-        size_t labelLen = strlen(trainingLabels[i]) + 1;
-        file.write((uint8_t *) &labelLen, sizeof(size_t));
-        file.write((uint8_t *) trainingLabels[i], labelLen);
+    for (int j = 0; j < maxFeatures; j++) {
+        featureMin[j] = minValues[j];
+        featureMax[j] = maxValues[j];
     }
-
-    file.close();
+    quantRangeSet = true;
+    preparedDirty = true;
     return true;
 }
 
-bool KNN::loadModel(const char *filename) {
-    if (filename == nullptr) return false;
+/*
+ * Re-encodes a float store as int8 or int16 codes using the ranges from
+ * calculateFeatureRanges(), then frees the float block. Rows added later
+ * are clamped to those ranges.
+ */
+bool KNN::quantize(KNNPrecision newPrecision) {
+    if (errorState || precision != PRECISION_FLOAT32 || newPrecision == PRECISION_FLOAT32) return false;
 
-    File file = SPIFFS.open(filename, "r");
-    if (!file) {
+    if (flashModel != nullptr) {
         errorState = true;
-        strncpy(errorMessage, "Failed to open file for reading", 49);
+        strncpy(errorMessage, "Flash model is read-only", 49);
         errorMessage[49] = '\0';
         return false;
     }
 
-    clearTrainingData();
+    if (currentDataSize == 0) {
+        errorState = true;
+        strncpy(errorMessage, "No training data available", 49);
+        errorMessage[49] = '\0';
+        return false;
+    }
 
-    int newK, newMaxFeatures, newMaxData, newCurrentDataSize;
-    file.read((uint8_t *) &newK, sizeof(int));
-    file.read((uint8_t *) &newMaxFeatures, sizeof(int));
-    file.read((uint8_t *) &newMaxData, sizeof(int));
-    file.read((uint8_t *) &newCurrentDataSize, sizeof(int));
+    calculateFeatureRanges();
 
-    if (newMaxFeatures != maxFeatures || newMaxData > maxData) {
+    KNNPrecision oldPrecision = precision;
+    precision = newPrecision;
+    uint8_t *newBlock = new uint8_t[(size_t) maxData * maxFeatures * elementSize() + KNN_STORE_ALIGNMENT];
+    if (newBlock == nullptr) {
+        precision = oldPrecision;
         errorState = true;
-        strncpy(errorMessage, "Incompatible model dimensions", 49);
+        strncpy(errorMessage, "Memory allocation failed", 49);
         errorMessage[49] = '\0';
-        file.close();
         return false;
     }
 
-    k = newK;
-    file.read((uint8_t *) &metric, sizeof(DistanceMetric));
-    file.read((uint8_t *) &useWeightedVoting, sizeof(bool));
-    file.read((uint8_t *) &normalizationEnabled, sizeof(bool));
+    uint8_t *oldBlock = trainingBlock;
+    float *floatData = trainingData;
 
-    if (normalizationEnabled) {
-        file.read((uint8_t *) featureMin, maxFeatures * sizeof(float));
-        file.read((uint8_t *) featureMax, maxFeatures * sizeof(float));
+    trainingBlock = newBlock;
+    trainingData = nullptr;
+    codeData = (uint8_t *) alignStore(newBlock);
+    quantLevels = (precision == PRECISION_INT8) ? 255 : 65535;
+    quantRangeSet = true;
+
+    for (int i = 0; i < currentDataSize; i++) {
+        const float *row = floatData + (layout == COLUMN_MAJOR ? i : (size_t) i * maxFeatures);
+        int stride = (layout == COLUMN_MAJOR) ? maxData : 1;
+        for (int j = 0; j < maxFeatures; j++) {
+            rowBuffer[j] = row[j * stride];
+        }
+        storeRow(i, rowBuffer);
     }
 
-    for (int i = 0; i < newCurrentDataSize; i++) {
-        float features[maxFeatures];
-        file.read((uint8_t *) features, maxFeatures * sizeof(float));
+    delete[] oldBlock;
+    enableFastSearch(false);
+    return true;
+}
+
+/*
+ * With normalization on, codes already sit in normalized space, so ranking
+ * runs on integer kernels and only the reported distances are scaled back.
+ * Without normalization rows are decoded and go through the float kernels.
+ */
+void KNN::searchQuantized(const float dataPoint[], int count) {
+    if (!normalizationEnabled) {
+        for (int i = 0; i < currentDataSize; i++) {
+            copyRow(i, rowBuffer);
+            distanceBuffer[i].distance = calculateDistance(dataPoint, rowBuffer, 1);
+            distanceBuffer[i].index = i;
+        }
+        selectNearest(count);
+        return;
+    }
 
-        size_t labelLen;
-        file.read((uint8_t *) &labelLen, sizeof(size_t));
+    for (int j = 0; j < maxFeatures; j++) {
+        float range = featureMax[j] - featureMin[j];
+        if (range < 0.0001f) {
+            queryCodes[j] = quantLevels / 2;
+            continue;
+        }
 
-        char label[20];
-        if (labelLen > 20) labelLen = 20;
-        file.read((uint8_t *) label, labelLen);
+        float code = (dataPoint[j] - featureMin[j]) * quantLevels / range;
+        if (code < -quantLevels) code = -quantLevels;
+        if (code > 2.0f * quantLevels) code = 2.0f * quantLevels;
+        queryCodes[j] = (int32_t) (code < 0.0f ? code - 0.5f : code + 0.5f);
+    }
 
-        addTrainingData(label, features);
+    if (precision == PRECISION_INT8) {
+        computeQuantizedDistances<uint8_t, uint32_t>(codeData);
+    } else {
+        computeQuantizedDistances<uint16_t, uint64_t>((const uint16_t *) codeData);
     }
 
-    file.close();
-    return true;
+    selectNearest(count);
+
+    if (metric != COSINE) {
+        for (int i = 0; i < count; i++) {
+            float distance = distanceBuffer[i].distance;
+            if (metric == EUCLIDEAN) distance = sqrt(distance);
+            distanceBuffer[i].distance = distance / quantLevels;
+        }
+    }
 }
 
-#endif
+/*
+ * Non-uniform weights are floats, so weighted stores rank codes in float
+ * instead of the integer kernels. Same units as the integer kernels.
+ */
+template<typename Code>
+float KNN::weightedCodeDistance(const Code *row, int stride) const {
+    float sum = 0.0f;
+    float normA = 0.0f;
+    float normB = 0.0f;
+
+    for (int j = 0; j < maxFeatures; j++) {
+        float a = (float) queryCodes[j];
+        float b = (float) row[j * stride];
+
+        if (metric == COSINE) {
+            a *= featureWeight[j];
+            b *= featureWeight[j];
+            sum += a * b;
+            normA += a * a;
+            normB += b * b;
+        } else {
+            float diff = a - b;
+            sum += (metric == MANHATTAN) ? abs(diff) * featureWeight[j] : diff * diff * featureWeightSq[j];
+        }
+    }
+
+    if (metric != COSINE) return sum;
+    if (normA <= 0.0f || normB <= 0.0f) return 1.0f;
+
+    float similarity = sum / (sqrt(normA) * sqrt(normB));
+    if (similarity > 1.0f) similarity = 1.0f;
+    if (similarity < -1.0f) similarity = -1.0f;
+    return 1.0f - similarity;
+}
+
+/*
+ * Plain Euclidean or Manhattan sum over one row of codes. A difference of
+ * at most 65535 squares within 32 bits, so only Wide sums (an int16 query
+ * outside the code range) pay for the 64-bit multiply per feature.
+ */
+template<typename Code, typename Accumulator, bool Square, bool Wide>
+static inline Accumulator codeRowDistance(const int32_t query[], const Code *row, int stride, int count) {
+    Accumulator sum = 0;
+    for (int j = 0; j < count; j++) {
+        int32_t diff = query[j] - (int32_t) row[j * stride];
+        uint32_t magnitude = (uint32_t) (diff < 0 ? -diff : diff);
+        if (!Square) sum += magnitude;
+        else if (Wide) sum += (Accumulator) magnitude * magnitude;
+        else sum += (Accumulator) (magnitude * magnitude);
+    }
+    return sum;
+}
+
+template<typename Code, typename Accumulator, bool Square, bool Wide>
+static void codeDistances(const int32_t query[], const Code *codes, int rows, int rowStep, int stride, int count,
+                          float distances[], int distanceStep) {
+    const Code *row = codes;
+    for (int i = 0; i < rows; i++, row += rowStep) {
+        Accumulator sum = (stride == 1) ? codeRowDistance<Code, Accumulator, Square, Wide>(query, row, 1, count)
+                                        : codeRowDistance<Code, Accumulator, Square, Wide>(query, row, stride, count);
+        distances[(size_t) i * distanceStep] = (float) sum;
+    }
+}
+
+/*1 - cosine similarity of two code rows, or 1 when either is all zeros*/
+static inline float codeCosineDistance(uint64_t dot, uint64_t normA, uint64_t normB) {
+    if (normA == 0 || normB == 0) return 1.0f;
+    float similarity = (float) dot / (sqrt((float) normA) * sqrt((float) normB));
+    if (similarity > 1.0f) similarity = 1.0f;
+    return 1.0f - similarity;
+}
+
+template<typename Code, typename Accumulator>
+void KNN::computeQuantizedDistances(const Code *codes) {
+    int stride = featureStride();
+    int rowStep = (layout == COLUMN_MAJOR) ? 1 : maxFeatures;
+
+    for (int i = 0; i < currentDataSize; i++) {
+        distanceBuffer[i].index = i;
+    }
+
+    /*distances are written in place, one DistanceIndex apart*/
+    float *distances = &distanceBuffer[0].distance;
+    int distanceStep = sizeof(DistanceIndex) / sizeof(float);
+
+    bool inRange = true;
+    for (int j = 0; j < maxFeatures; j++) {
+        if (queryCodes[j] < 0 || queryCodes[j] > quantLevels) inRange = false;
+    }
+
+    /*a query inside the code range narrows to the store's width once, rows then go through the vector kernels*/
+    if (KNN_SIMD_CODES && !featureWeighted && stride == 1 && inRange) {
+        Code *query = (Code *) (queryCodes + maxFeatures);
+        uint64_t queryNorm = 0;
+        for (int j = 0; j < maxFeatures; j++) {
+            query[j] = (Code) queryCodes[j];
+            queryNorm += (uint64_t) queryCodes[j] * queryCodes[j];
+        }
+
+        const Code *row = codes;
+        for (int i = 0; i < currentDataSize; i++, row += rowStep) {
+            float distance;
+            if (metric == MANHATTAN) {
+                distance = (float) knnSimdCodeAbsDistance(query, row, maxFeatures);
+            } else if (metric == EUCLIDEAN) {
+                distance = (float) knnSimdCodeSquaredDistance(query, row, maxFeatures);
+            } else {
+                uint64_t dot;
+                uint64_t rowNorm;
+                knnSimdCodeDotTerms(query, row, maxFeatures, dot, rowNorm);
+                distance = codeCosineDistance(dot, queryNorm, rowNorm);
+            }
+            distances[(size_t) i * distanceStep] = distance;
+        }
+        return;
+    }
+
+    if (!featureWeighted && metric != COSINE) {
+        bool wide = sizeof(Code) > 1 && !inRange;
+        if (metric == MANHATTAN) {
+            codeDistances<Code, uint32_t, false, false>(queryCodes, codes, currentDataSize, rowStep, stride,
+                                                        maxFeatures, distances, distanceStep);
+        } else if (wide) {
+            codeDistances<Code, Accumulator, true, true>(queryCodes, codes, currentDataSize, rowStep, stride,
+                                                         maxFeatures, distances, distanceStep);
+        } else {
+            codeDistances<Code, Accumulator, true, false>(queryCodes, codes, currentDataSize, rowStep, stride,
+                                                          maxFeatures, distances, distanceStep);
+        }
+        return;
+    }
+
+    const Code *row = codes;
+    for (int i = 0; i < currentDataSize; i++, row += rowStep) {
+        if (featureWeighted) {
+            distanceBuffer[i].distance = weightedCodeDistance(row, stride);
+            continue;
+        }
+
+        int64_t dotProduct = 0;
+        int64_t normA = 0;
+        int64_t normB = 0;
+
+        for (int j = 0; j < maxFeatures; j++) {
+            int64_t a = queryCodes[j];
+            int64_t b = row[j * stride];
+            dotProduct += a * b;
+            normA += a * a;
+            normB += b * b;
+        }
+
+        float similarity = 0.0f;
+        if (normA > 0 && normB > 0) {
+            similarity = (float) dotProduct / (sqrt((float) normA) * sqrt((float) normB));
+            if (similarity > 1.0f) similarity = 1.0f;
+            if (similarity < -1.0f) similarity = -1.0f;
+        }
+        distanceBuffer[i].distance = (normA > 0 && normB > 0) ? 1.0f - similarity : 1.0f;
+    }
+}
+
+/*
+ * Distance between a prepared query and a prepared row, weighted per
+ * feature. Euclidean returns the squared distance. Euclidean and Manhattan stop summing as soon as
+ * the partial sum passes bound, the caller then discards the row.
+ */
+float KNN::calculatePreparedDistance(const float query[], const float row[], int stride, float bound) const {
+    float sum = 0.0f;
+
+    if (metric == COSINE) {
+        float normA = 0.0f;
+        float normB = 0.0f;
+
+        if (KNN_SIMD_COSINE && stride == 1) {
+            knnSimdCosineTerms(query, row, featureWeight, nullptr, maxFeatures, sum, normA, normB);
+        } else {
+            for (int i = 0; i < maxFeatures; i++) {
+                float a = query[i] * featureWeight[i];
+                float b = row[i * stride] * featureWeight[i];
+                sum += a * b;
+                normA += a * a;
+                normB += b * b;
+            }
+        }
+
+        normA = sqrt(normA);
+        normB = sqrt(normB);
+
+        if (normA < 0.0001f || normB < 0.0001f) return 1.0f;
+
+        float similarity = sum / (normA * normB);
+
+        if (similarity > 1.0f) similarity = 1.0f;
+        if (similarity < -1.0f) similarity = -1.0f;
+
+        return 1.0f - similarity;
+    }
+
+    /*without a vector body the loop below wins, it stops early on the bound*/
+    if (stride == 1 && metric == MANHATTAN && KNN_SIMD_ABS) {
+        return knnSimdAbsDistance(query, row, featureWeight, maxFeatures);
+    }
+    if (stride == 1 && metric != MANHATTAN && KNN_SIMD_SQUARED) {
+        return knnSimdSquaredDistance(query, row, featureWeightSq, maxFeatures);
+    }
+
+    for (int i = 0; i < maxFeatures; i++) {
+        float diff = query[i] - row[i * stride];
+        sum += (metric == MANHATTAN) ? abs(diff) * featureWeight[i] : diff * diff * featureWeightSq[i];
+        if (sum > bound) return sum;
+    }
+
+    return sum;
+}
 
-float KNN::calculateDistance(const float dataPoint[], const float trainDataPoint[]) const {
+float KNN::calculateDistance(const float dataPoint[], const float trainDataPoint[], int stride) const {
     switch (metric) {
         case MANHATTAN:
-            return calculateManhattanDistance(dataPoint, trainDataPoint);
+            return calculateManhattanDistance(dataPoint, trainDataPoint, stride);
         case COSINE:
-            return calculateCosineDistance(dataPoint, trainDataPoint);
+            return calculateCosineDistance(dataPoint, trainDataPoint, stride);
         case EUCLIDEAN:
         default:
-            return calculateEuclideanDistance(dataPoint, trainDataPoint);
+            return calculateEuclideanDistance(dataPoint, trainDataPoint, stride);
     }
 }
 
-float KNN::calculateEuclideanDistance(const float dataPoint[], const float trainDataPoint[]) const {
+/*
+ * Raw-value kernels: with normalization a normalized difference is the raw
+ * difference times weight / range, so no divides or bias terms are needed.
+ * Cosine needs the absolute values, coefficient and offset give those.
+ * Contiguous rows go through the KNNSimd.h kernels.
+ */
+float KNN::calculateEuclideanDistance(const float dataPoint[], const float trainDataPoint[], int stride) const {
+    if (KNN_SIMD_SQUARED && stride == 1) {
+        return sqrt(knnSimdSquaredDistance(dataPoint, trainDataPoint, featureCoefSq, maxFeatures));
+    }
+
     float sum = 0.0f;
 
     for (int i = 0; i < maxFeatures; i++) {
-        float a = dataPoint[i];
-        float b = trainDataPoint[i];
-
-        if (normalizationEnabled) {
-            a = normalizeFeature(a, i);
-            b = normalizeFeature(b, i);
-        }
-
-        float diff = a - b;
+        float diff = (dataPoint[i] - trainDataPoint[i * stride]) * featureCoef[i];
         sum += diff * diff;
     }
 
     return sqrt(sum);
 }
 
-float KNN::calculateManhattanDistance(const float dataPoint[], const float trainDataPoint[]) const {
+float KNN::calculateManhattanDistance(const float dataPoint[], const float trainDataPoint[], int stride) const {
+    if (KNN_SIMD_ABS && stride == 1) {
+        return knnSimdAbsDistance(dataPoint, trainDataPoint, featureCoef, maxFeatures);
+    }
+
     float sum = 0.0f;
 
     for (int i = 0; i < maxFeatures; i++) {
-        float a = dataPoint[i];
-        float b = trainDataPoint[i];
-
-        if (normalizationEnabled) {
-            a = normalizeFeature(a, i);
-            b = normalizeFeature(b, i);
-        }
-
-        sum += abs(a - b);
+        sum += abs(dataPoint[i] - trainDataPoint[i * stride]) * featureCoef[i];
     }
 
     return sum;
 }
 
-float KNN::calculateCosineDistance(const float dataPoint[], const float trainDataPoint[]) const {
+float KNN::calculateCosineDistance(const float dataPoint[], const float trainDataPoint[], int stride) const {
     float dotProduct = 0.0f;
     float normA = 0.0f;
     float normB = 0.0f;
 
-    for (int i = 0; i < maxFeatures; i++) {
-        float a = dataPoint[i];
-        float b = trainDataPoint[i];
+    if (KNN_SIMD_COSINE && stride == 1) {
+        knnSimdCosineTerms(dataPoint, trainDataPoint, featureCoef, featureOffset, maxFeatures,
+                           dotProduct, normA, normB);
+    } else {
+        for (int i = 0; i < maxFeatures; i++) {
+            float a = dataPoint[i] * featureCoef[i] + featureOffset[i];
+            float b = trainDataPoint[i * stride] * featureCoef[i] + featureOffset[i];
 
-        if (normalizationEnabled) {
-            a = normalizeFeature(a, i);
-            b = normalizeFeature(b, i);
+            dotProduct += a * b;
+            normA += a * a;
+            normB += b * b;
         }
-
-        dotProduct += a * b;
-        normA += a * a;
-        normB += b * b;
     }
 
     normA = sqrt(normA);
@@ -709,15 +3236,3 @@ float KNN::calculateCosineDistance(const float dataPoint[], const float trainDat
 
     return 1.0f - similarity;
 }
-
-float KNN::normalizeFeature(float value, int featureIndex) const {
-    if (!normalizationEnabled || featureMin == nullptr || featureMax == nullptr) return value;
-    if (featureIndex < 0 || featureIndex >= maxFeatures) return value;
-
-    float min = featureMin[featureIndex];
-    float max = featureMax[featureIndex];
-
-    if (max - min < 0.0001f) return 0.5f;
-
-    return (value - min) / (max - min);
-}
\ No newline at end of file
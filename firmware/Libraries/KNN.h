@@ -13,7 +13,7 @@
 #pragma message("[COMPILED]: KNN.h")
 
 #include "Arduino.h"
-#ifdef ESP32
+#if defined(ESP32) || defined(HOST_SPIFFS)
 #include "SPIFFS.h"
 #endif
 
@@ -23,14 +23,103 @@ enum DistanceMetric {
     COSINE
 };
 
+enum KNNStorageLayout {
+    ROW_MAJOR,
+    COLUMN_MAJOR
+};
+
+enum KNNPrecision {
+    PRECISION_FLOAT32,
+    PRECISION_INT16,
+    PRECISION_INT8
+};
+
+/*which online sample a full ring gives up for a new one*/
+enum KNNOnlineEviction {
+    EVICT_OLDEST,
+    EVICT_CLASS_BALANCE
+};
+
+const int KNN_MAX_LABEL_CHAR = 20;
+const int KNN_MAX_CLASSES = 16;
+const int KNN_STORE_ALIGNMENT = 16;
+const int KNN_MAX_NEIGHBORS = 16;
+const int KNN_INDEX_LEAF_SIZE = 8;
+const int KNN_INDEX_MIN_DATA = 256;
+const int KNN_INDEX_MIN_DATA_MANHATTAN = 4096;
+const int KNN_MAX_FOLD_WORKERS = 8;
+const int KNN_BATCH_TILE = 8;
+const int KNN_BATCH_ROWS = 64;
+const int KNN_METRIC_COUNT = 3;
+
+/*everything one distance pass yields, filled by KNN::predictWithConfidence()*/
+struct KNNResult {
+    const char *label;
+    int classId;
+    float confidence;
+    float totalVotes;
+    float classVotes[KNN_MAX_CLASSES];
+    int neighborCount;
+    int neighborIndices[KNN_MAX_NEIGHBORS];
+    float neighborDistances[KNN_MAX_NEIGHBORS];
+};
+
+/*one configuration scored by KNN::leaveOneOutSweep()*/
+struct KNNLooScore {
+    int k;
+    DistanceMetric metric;
+    bool weightedVoting;
+    float accuracy;
+};
+
+/*
+ * A trained model kept in read-only memory, generated from a dataset by
+ * KNNModelTool. On ESP32 const tables live in memory-mapped flash, so KNN
+ * reads the rows in place instead of copying them to the heap.
+ * preparedFeatures holds the same rows already normalized for fast search
+ * and may be nullptr, as may featureWeights (all weights 1).
+ */
+struct KNNFlashModel {
+    int featureCount;
+    int dataCount;
+    int classCount;
+    KNNStorageLayout layout;
+    const float *features;
+    const float *preparedFeatures;
+    const uint8_t *classes;
+    const char (*labels)[KNN_MAX_LABEL_CHAR];
+    const float *featureMin;
+    const float *featureMax;
+    const float *featureWeights;
+};
+
 class KNN {
 private:
     int k;
     int maxFeatures;
     int maxData;
     int currentDataSize;
-    float **trainingData;
-    char **trainingLabels;
+
+    /*single aligned block holding every feature value, see KNNStorageLayout*/
+    uint8_t *trainingBlock;
+    float *trainingData;
+    KNNStorageLayout layout;
+
+    /*set when the store and class ids are borrowed from a read-only model*/
+    const KNNFlashModel *flashModel;
+
+    /*quantized stores keep unsigned codes of the normalized value instead of floats*/
+    KNNPrecision precision;
+    uint8_t *codeData;
+    int32_t quantLevels;
+    bool quantRangeSet;
+    /*maxFeatures query codes, followed by room for the same codes narrowed to the store width*/
+    int32_t *queryCodes;
+
+    /*labels are interned, each row only stores its class id*/
+    uint8_t *trainingClass;
+    char classLabels[KNN_MAX_CLASSES][KNN_MAX_LABEL_CHAR];
+    int classCount;
 
     DistanceMetric metric;
     bool useWeightedVoting;
@@ -41,57 +130,230 @@ private:
     float *featureMin;
     float *featureMax;
 
+    /*
+     * Rows holding each feature's current min and max, so a removal only
+     * rescans a feature once its last extreme row is gone. 0 marks a stale
+     * extreme (rescanned lazily before the next search), -1 an unknown
+     * count for ranges taken from a file or a flash model.
+     */
+    int32_t *featureMinCount;
+    int32_t *featureMaxCount;
+    bool rangesDirty;
+
+    /*
+     * Per-feature weights multiply each feature after normalization. The
+     * raw-value kernels use featureCoef (weight / range), its square and
+     * featureOffset (weighted bias) so they only multiply-add; all five
+     * arrays share one allocation.
+     */
+    float *featureWeight;
+    float *featureWeightSq;
+    float *featureCoef;
+    float *featureCoefSq;
+    float *featureOffset;
+    bool featureWeighted;
+
+    /*fast search keeps a normalized copy of the store so queries skip the divides*/
+    bool fastSearchEnabled;
+    bool preparedDirty;
+    uint8_t *preparedBlock;
+    float *preparedData;
+    float *featureScale;
+    float *queryBuffer;
+
     struct DistanceIndex {
         float distance;
         int index;
     };
-    int *voteBuffer;
     DistanceIndex *distanceBuffer;
+    float *rowBuffer;
+
+    /*per-query heaps, normalized queries and distances for one predictBatch() tile*/
+    DistanceIndex *batchNeighbors;
+    float *batchQueries;
+    float *batchDistances;
+
+    /*kd-tree over the fast search rows, nodes own a slice of indexOrder*/
+    struct IndexNode {
+        int start;
+        int count;
+        int left;
+        int right;
+        int splitFeature;
+        float splitValue;
+    };
+    bool indexEnabled;
+    bool indexDirty;
+    IndexNode *indexNodes;
+    int *indexOrder;
+    int indexNodeCount;
+    int indexMaxNodes;
+
+    /*
+     * Online region: onlineCapacity slots after the baseDataCount base rows
+     * hold field-confirmed samples. A slot keeps its row for life and a
+     * full ring overwrites in place, so base rows never move and a boot
+     * replays at most onlineCapacity rows. onlineSaved holds the sequence
+     * each slot last had on disk; a slot that differs is dirty. A flash
+     * model keeps its rows in flash: its online rows, raw then prepared,
+     * sit row-major in onlineBlock and every search scans them after the
+     * flash rows.
+     */
+    int baseDataCount;
+    int onlineCapacity;
+    int onlineCount;
+    int onlineHead;
+    KNNOnlineEviction onlineEviction;
+    uint32_t onlineClock;
+    uint32_t *onlineSequence;
+    uint32_t *onlineSaved;
+    bool onlineRewrite;
+    uint8_t *onlineBlock;
+    float *onlineData;
+    float *onlinePrepared;
 
     bool errorState;
     char errorMessage[50];
 
-    float calculateEuclideanDistance(const float dataPoint[], const float trainDataPoint[]) const;
-    float calculateManhattanDistance(const float dataPoint[], const float trainDataPoint[]) const;
-    float calculateCosineDistance(const float dataPoint[], const float trainDataPoint[]) const;
-    float calculateDistance(const float dataPoint[], const float trainDataPoint[]) const;
+    float calculateEuclideanDistance(const float dataPoint[], const float trainDataPoint[], int stride) const;
+    float calculateManhattanDistance(const float dataPoint[], const float trainDataPoint[], int stride) const;
+    float calculateCosineDistance(const float dataPoint[], const float trainDataPoint[], int stride) const;
+    float calculateDistance(const float dataPoint[], const float trainDataPoint[], int stride) const;
+    void computeDistances(const float dataPoint[]);
+    float calculatePreparedDistance(const float query[], const float row[], int stride, float bound) const;
+    void findNearest(const float dataPoint[], int count);
+    void searchPrepared(int count);
+    void searchOnline(const float query[], DistanceIndex *heap, int count, int &filled) const;
+    void prepareFastSearch();
+    void storePreparedRow(int index, const float features[]);
+    const float *searchData() const;
+    void searchQuantized(const float dataPoint[], int count);
+    template<typename Code, typename Accumulator>
+    void computeQuantizedDistances(const Code *codes);
+    template<typename Code>
+    float weightedCodeDistance(const Code *row, int stride) const;
+
+    size_t elementSize() const;
+    int32_t encodeFeature(float value, int featureIndex) const;
+    float decodeFeature(int32_t code, int featureIndex) const;
 
-    static int compareDistances(const void *a, const void *b);
-    float normalizeFeature(float value, int featureIndex) const;
+    const float *rowPointer(int index) const;
+    int rowStride(int index) const;
+    int featureStride() const;
+    int storeRows() const;
+    void copyRow(int index, float output[]) const;
+    void storeRow(int index, const float features[]);
+    void placeRow(int index, int classId, const float features[]);
+    bool growStore(int rows);
+    bool attachOnlineBlock(int capacity);
+    int onlineVictim();
+    void placeOnline(int slot, int classId, const float features[], uint32_t sequence);
+    void moveRow(uint8_t *store, size_t size, int from, int to);
+    void rescanFeatureRange(int feature);
+    void refreshFeatureRanges();
+    void releaseExtremes(const float features[]);
+    int32_t countFeatureValue(int feature, float value) const;
+    int internLabel(const char *label);
+    int findClass(const char *label) const;
+    void releaseBuffers();
+
+    static bool isFarther(const DistanceIndex &a, const DistanceIndex &b);
+    static void siftDown(DistanceIndex *heap, int root, int size);
+    static void buildHeap(DistanceIndex *heap, int count);
+    static void sortHeap(DistanceIndex *heap, int count);
+    static void offerCandidate(DistanceIndex *heap, const DistanceIndex &candidate, int count, int &filled);
+    void selectNearest(int count);
+    void tallyVotes(const DistanceIndex *neighbors, int count, bool weighted, KNNResult &result) const;
+    bool predictTile(const float *const queries[], int count, const char *labels[], float confidences[]);
+
+    float indexValue(int row, int feature) const;
+    int buildIndexNode(int start, int count);
+    void partitionIndex(int start, int count, int nth, int feature);
+    void searchIndexNode(int node, int count, int &filled);
+    bool useIndex() const;
+
+    /*scratch owned by one crossValidate() worker, defined in KNN.cpp*/
+    struct FoldWorker;
+    void runFoldWorker(FoldWorker &worker) const;
+    float evaluateFold(int fold, FoldWorker &worker) const;
+    float foldDistance(const float query[], const float row[], int stride, const FoldWorker &worker) const;
+#ifdef ESP32
+    static void foldTask(void *parameter);
+#endif
+
+    bool runLeaveOneOut(const DistanceMetric metrics[], int metricCount, const int kValues[], int kCount,
+                        const bool votings[], int votingCount, KNNLooScore scores[]);
 
 public:
-    KNN(int k, int maxFeatures, int maxData);
+    KNN(int k, int maxFeatures, int maxData, KNNStorageLayout storageLayout = ROW_MAJOR,
+        KNNPrecision storagePrecision = PRECISION_FLOAT32);
+    KNN(int k, const KNNFlashModel &model);
     ~KNN();
 
     bool addTrainingData(const char *label, const float features[]);
     const char *predict(const float dataPoint[]);
+    bool predictWithConfidence(const float dataPoint[], KNNResult &result);
+    bool predictBatch(const float queries[], int queryCount, const char *labels[], float confidences[] = nullptr);
 
+    bool setK(int newK);
     void setDistanceMetric(DistanceMetric newMetric);
     void setWeightedVoting(bool weighted);
     void enableNormalization(bool enable);
     void setLowMemoryMode(bool enable);
     void setDebugMode(bool enable);
+    bool enableFastSearch(bool enable);
+    bool enableIndex(bool enable);
+    bool buildIndex();
     void calculateFeatureRanges();
+    bool setFeatureWeights(const float weights[]);
+    bool setFeatureWeight(int feature, float weight);
+    float getFeatureWeight(int feature) const;
+    bool setQuantizationRange(const float minValues[], const float maxValues[]);
+    bool quantize(KNNPrecision newPrecision);
 
     void clearTrainingData();
     bool removeTrainingData(int index);
+
+    bool enableOnlineLearning(int capacity, KNNOnlineEviction eviction = EVICT_OLDEST);
+    bool learnOnline(const char *label, const float features[]);
+    int getOnlineCount() const;
+    int getOnlineCapacity() const;
+    int getUnsavedOnlineCount() const;
     int getDataCount() const;
     int getDataCountByLabel(const char *label) const;
+    const char *getLabel(int index) const;
+    bool getTrainingData(int index, float features[]) const;
+    int getClassCount() const;
+    const char *getClassLabel(int classId) const;
+    KNNStorageLayout getStorageLayout() const;
+    KNNPrecision getStoragePrecision() const;
+    int getK() const;
+    DistanceMetric getDistanceMetric() const;
+    bool getWeightedVoting() const;
+    bool isReadOnly() const;
+    size_t getMemoryUsage() const;
 
     bool getNearestNeighbors(const float dataPoint[], int indices[], float distances[], int neighborCount);
     float getPredictionConfidence(const float dataPoint[]);
 
     float evaluateAccuracy(const float **testFeatures, const char **testLabels, int testCount);
     float crossValidate(int folds);
+    float leaveOneOut();
+    bool leaveOneOutSweep(const int kValues[], int kCount, KNNLooScore scores[]);
+    int autoTune(const int kValues[], int kCount, unsigned long budgetMs, KNNLooScore scores[], KNNLooScore &best);
 
     bool hasError() const;
     const char *getErrorMessage() const;
     void clearError();
 
-#ifdef ESP32
+#if defined(ESP32) || defined(HOST_SPIFFS)
     bool saveModel(const char *filename);
     bool loadModel(const char *filename);
+    bool saveOnlineSamples(const char *filename);
+    int loadOnlineSamples(const char *filename);
 #endif
 };
 
+#include "KNNFixed.h"
+
 #endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+/*
+ *  KNNEnsemble.cpp
+ *
+ *  Decision tree first, KNN only when the tree is unsure
+ *  Created on: 2026. 10. 17
+ */
+
+#include "KNNEnsemble.h"
+
+KNNEnsemble::KNNEnsemble(KNN &knn, DecisionTree &tree, float treeThreshold) :
+        knn(knn), tree(tree), treeThreshold(treeThreshold) {
+    resetStats();
+}
+
+/*
+ * A tree leaf at or above the threshold answers alone. Below it the KNN
+ * result wins; if KNN cannot answer the tree's label is still returned.
+ */
+bool KNNEnsemble::classify(const float features[], KNNEnsembleResult &result) {
+    unsigned long startUs = micros();
+
+    result.label = "ERROR";
+    result.confidence = 0.0f;
+    result.treeConfidence = 0.0f;
+    result.usedKNN = false;
+    result.modelsAgree = true;
+
+    DecisionTreeResult treeResult;
+    bool treeAnswered = tree.predictWithConfidence(features, treeResult);
+    if (treeAnswered) {
+        result.label = treeResult.label;
+        result.confidence = treeResult.confidence;
+        result.treeConfidence = treeResult.confidence;
+    }
+
+    if (!treeAnswered || treeResult.confidence < treeThreshold) {
+        KNNResult knnResult;
+        result.usedKNN = true;
+        result.modelsAgree = false;
+        if (knn.predictWithConfidence(features, knnResult)) {
+            result.modelsAgree = treeAnswered && strcmp(treeResult.label, knnResult.label) == 0;
+            result.label = knnResult.label;
+            result.confidence = knnResult.confidence;
+        } else if (!treeAnswered) {
+            result.latencyUs = micros() - startUs;
+            return false;
+        }
+    }
+
+    result.latencyUs = micros() - startUs;
+
+    int path = result.usedKNN ? 1 : 0;
+    pathCount[path]++;
+    if (result.usedKNN && result.modelsAgree) agreeCount++;
+    latencyHistogram[path][latencyBucket(result.latencyUs)]++;
+    latencyTotalUs[path] += result.latencyUs;
+    return true;
+}
+
+const char *KNNEnsemble::predict(const float features[]) {
+    KNNEnsembleResult result;
+    classify(features, result);
+    return result.label;
+}
+
+void KNNEnsemble::setTreeThreshold(float threshold) {
+    treeThreshold = threshold;
+}
+
+float KNNEnsemble::getTreeThreshold() const {
+    return treeThreshold;
+}
+
+uint32_t KNNEnsemble::getTreeOnlyCount() const {
+    return pathCount[0];
+}
+
+uint32_t KNNEnsemble::getKNNCount() const {
+    return pathCount[1];
+}
+
+/*fallbacks where the tree's majority class matched the KNN answer anyway*/
+uint32_t KNNEnsemble::getAgreementCount() const {
+    return agreeCount;
+}
+
+float KNNEnsemble::getTreeOnlyRate() const {
+    uint32_t total = pathCount[0] + pathCount[1];
+    return (total > 0) ? (float) pathCount[0] / total : 0.0f;
+}
+
+float KNNEnsemble::getAverageLatency(bool knnPath) const {
+    int path = knnPath ? 1 : 0;
+    return (pathCount[path] > 0) ? (float) latencyTotalUs[path] / pathCount[path] : 0.0f;
+}
+
+uint32_t KNNEnsemble::getLatencyCount(bool knnPath, int bucket) const {
+    if (bucket < 0 || bucket >= KNN_ENSEMBLE_BUCKETS) return 0;
+    return latencyHistogram[knnPath ? 1 : 0][bucket];
+}
+
+/*exclusive upper bound of a bucket in microseconds, 0 for the open-ended last one*/
+unsigned long KNNEnsemble::getBucketLimit(int bucket) {
+    if (bucket < 0 || bucket >= KNN_ENSEMBLE_BUCKETS - 1) return 0;
+    return KNN_ENSEMBLE_FIRST_BUCKET_US << bucket;
+}
+
+int KNNEnsemble::latencyBucket(unsigned long latencyUs) {
+    int bucket = 0;
+    while (bucket < KNN_ENSEMBLE_BUCKETS - 1 && latencyUs >= (KNN_ENSEMBLE_FIRST_BUCKET_US << bucket)) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void KNNEnsemble::printStats() const {
+    uint32_t total = pathCount[0] + pathCount[1];
+    Serial.println("=== ENSEMBLE STATS ===");
+    Serial.printf("Tree threshold: %.2f, classified: %lu\n", treeThreshold, (unsigned long) total);
+    Serial.printf("Tree only: %lu (%.1f%%), avg %.1f us\n", (unsigned long) pathCount[0],
+                  getTreeOnlyRate() * 100.0, getAverageLatency(false));
+    Serial.printf("KNN fallback: %lu, avg %.1f us, tree agreed on %lu\n", (unsigned long) pathCount[1],
+                  getAverageLatency(true), (unsigned long) agreeCount);
+    Serial.println("  latency      tree     knn");
+    for (int b = 0; b < KNN_ENSEMBLE_BUCKETS; b++) {
+        if (latencyHistogram[0][b] == 0 && latencyHistogram[1][b] == 0) continue;
+        if (getBucketLimit(b) > 0) {
+            Serial.printf("  < %5lu us %7lu %7lu\n", getBucketLimit(b), (unsigned long) latencyHistogram[0][b],
+                          (unsigned long) latencyHistogram[1][b]);
+        } else {
+            Serial.printf("  >=%5lu us %7lu %7lu\n", getBucketLimit(b - 1), (unsigned long) latencyHistogram[0][b],
+                          (unsigned long) latencyHistogram[1][b]);
+        }
+    }
+    Serial.println("======================");
+}
+
+void KNNEnsemble::resetStats() {
+    for (int path = 0; path < 2; path++) {
+        pathCount[path] = 0;
+        latencyTotalUs[path] = 0;
+        for (int b = 0; b < KNN_ENSEMBLE_BUCKETS; b++) {
+            latencyHistogram[path][b] = 0;
+        }
+    }
+    agreeCount = 0;
+}
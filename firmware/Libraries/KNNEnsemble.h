@@ -0,0 +1,76 @@
+/*
+ *  KNNEnsemble.h
+ *
+ *  Decision tree first, KNN only when the tree is unsure
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef KNN_ENSEMBLE_LIB_H
+#define KNN_ENSEMBLE_LIB_H
+
+#pragma message("[COMPILED]: KNNEnsemble.h")
+
+#include "KNN.h"
+#include "DecisionTree.h"
+
+/*latency buckets double from KNN_ENSEMBLE_FIRST_BUCKET_US, the last one is open-ended*/
+const int KNN_ENSEMBLE_BUCKETS = 12;
+const unsigned long KNN_ENSEMBLE_FIRST_BUCKET_US = 8;
+const float KNN_ENSEMBLE_DEFAULT_THRESHOLD = 0.9f;
+
+struct KNNEnsembleResult {
+    const char *label;
+    float confidence;
+    float treeConfidence;
+    bool usedKNN;
+    bool modelsAgree;
+    unsigned long latencyUs;
+};
+
+/*
+ * Runs a trained DecisionTree on every query and only pays for the KNN
+ * distance pass when the tree's leaf confidence is below the threshold.
+ * Both models have to be trained on the same labels. A KNN that learns
+ * online needs the tree retrained on its rows, KNN::getTrainingData(),
+ * after each sample, or confident leaves keep answering from the old
+ * data. Every call lands in a latency histogram per path, so the share
+ * of queries the cheap path answers, and what the fallback costs, can be
+ * read back on the device.
+ */
+class KNNEnsemble {
+private:
+    KNN &knn;
+    DecisionTree &tree;
+    float treeThreshold;
+
+    uint32_t pathCount[2];
+    uint32_t agreeCount;
+    uint32_t latencyHistogram[2][KNN_ENSEMBLE_BUCKETS];
+    unsigned long long latencyTotalUs[2];
+
+    static int latencyBucket(unsigned long latencyUs);
+
+public:
+    KNNEnsemble(KNN &knn, DecisionTree &tree, float treeThreshold = KNN_ENSEMBLE_DEFAULT_THRESHOLD);
+
+    bool classify(const float features[], KNNEnsembleResult &result);
+    const char *predict(const float features[]);
+
+    void setTreeThreshold(float threshold);
+    float getTreeThreshold() const;
+
+    uint32_t getTreeOnlyCount() const;
+    uint32_t getKNNCount() const;
+    uint32_t getAgreementCount() const;
+    float getTreeOnlyRate() const;
+    float getAverageLatency(bool knnPath) const;
+    uint32_t getLatencyCount(bool knnPath, int bucket) const;
+    static unsigned long getBucketLimit(int bucket);
+
+    void printStats() const;
+    void resetStats();
+};
+
+#endif
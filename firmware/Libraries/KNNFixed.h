@@ -0,0 +1,261 @@
+/*
+ *  KNNFixed.h
+ *
+ *  KNN specialized at compile time for a fixed feature count, k and metric
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef KNN_FIXED_LIB_H
+#define KNN_FIXED_LIB_H
+
+#pragma message("[COMPILED]: KNNFixed.h")
+
+#include "KNN.h"
+
+/*
+ * Same model as KNN, but Features, K and Metric are template parameters so
+ * every inner loop has a constant trip count the compiler can unroll, and
+ * the metric dispatch folds away. All buffers are statically sized, the
+ * object never touches the heap.
+ *
+ * Normalization costs no divides: every feature maps through a cached
+ * scale and bias, and for Euclidean and Manhattan the bias cancels, so a
+ * normalized difference is the raw difference times the scale.
+ */
+template<int Features, int K, DistanceMetric Metric = EUCLIDEAN, int MaxData = 128>
+class KNNFixed {
+private:
+    float trainingData[MaxData][Features];
+    uint8_t trainingClass[MaxData];
+    char classLabels[KNN_MAX_CLASSES][KNN_MAX_LABEL_CHAR];
+    int classCount;
+    int currentDataSize;
+
+    bool useWeightedVoting;
+    bool normalizationEnabled;
+
+    float featureMin[Features];
+    float featureMax[Features];
+    float featureScale[Features];
+    float featureBias[Features];
+    bool scaleDirty;
+    float preparedQuery[Features];
+
+    float bestDistance[K];
+    int bestIndex[K];
+
+    void updateScale() {
+        for (int j = 0; j < Features; j++) {
+            float range = featureMax[j] - featureMin[j];
+            if (!normalizationEnabled) {
+                featureScale[j] = 1.0f;
+                featureBias[j] = 0.0f;
+            } else if (range < 0.0001f) {
+                featureScale[j] = 0.0f;
+                featureBias[j] = 0.5f;
+            } else {
+                featureScale[j] = 1.0f / range;
+                featureBias[j] = -featureMin[j] / range;
+            }
+        }
+        scaleDirty = false;
+    }
+
+    /*
+     * Euclidean returns the squared distance, sqrt only runs for the K
+     * winners. Cosine expects the query already normalized.
+     */
+    float distance(const float query[], const float row[]) const {
+        if (Metric == COSINE) {
+            float dotProduct = 0.0f;
+            float normA = 0.0f;
+            float normB = 0.0f;
+
+            for (int j = 0; j < Features; j++) {
+                float a = query[j];
+                float b = row[j] * featureScale[j] + featureBias[j];
+                dotProduct += a * b;
+                normA += a * a;
+                normB += b * b;
+            }
+
+            normA = sqrt(normA);
+            normB = sqrt(normB);
+
+            if (normA < 0.0001f || normB < 0.0001f) return 1.0f;
+
+            float similarity = dotProduct / (normA * normB);
+
+            if (similarity > 1.0f) similarity = 1.0f;
+            if (similarity < -1.0f) similarity = -1.0f;
+
+            return 1.0f - similarity;
+        }
+
+        float sum = 0.0f;
+        for (int j = 0; j < Features; j++) {
+            float diff = (query[j] - row[j]) * featureScale[j];
+            sum += (Metric == MANHATTAN) ? abs(diff) : diff * diff;
+        }
+        return sum;
+    }
+
+    int findNearest(const float query[]) {
+        if (scaleDirty) updateScale();
+
+        if (Metric == COSINE) {
+            for (int j = 0; j < Features; j++) {
+                preparedQuery[j] = query[j] * featureScale[j] + featureBias[j];
+            }
+            query = preparedQuery;
+        }
+
+        int effectiveK = (K > currentDataSize) ? currentDataSize : K;
+        int filled = 0;
+
+        for (int i = 0; i < currentDataSize; i++) {
+            float d = distance(query, trainingData[i]);
+            if (filled == effectiveK && d >= bestDistance[effectiveK - 1]) continue;
+
+            int slot = (filled < effectiveK) ? filled++ : effectiveK - 1;
+            while (slot > 0 && bestDistance[slot - 1] > d) {
+                bestDistance[slot] = bestDistance[slot - 1];
+                bestIndex[slot] = bestIndex[slot - 1];
+                slot--;
+            }
+            bestDistance[slot] = d;
+            bestIndex[slot] = i;
+        }
+
+        if (Metric == EUCLIDEAN) {
+            for (int i = 0; i < effectiveK; i++) {
+                bestDistance[i] = sqrt(bestDistance[i]);
+            }
+        }
+
+        return effectiveK;
+    }
+
+public:
+    KNNFixed() : classCount(0), currentDataSize(0), useWeightedVoting(false),
+                 normalizationEnabled(false), scaleDirty(true) {
+        static_assert(Features > 0 && K > 0 && K <= MaxData, "Invalid KNNFixed parameters");
+        static_assert(K <= KNN_MAX_NEIGHBORS, "K exceeds KNN_MAX_NEIGHBORS");
+    }
+
+    bool addTrainingData(const char *label, const float features[]) {
+        if (label == nullptr || features == nullptr || currentDataSize >= MaxData) return false;
+
+        int classId = -1;
+        for (int i = 0; i < classCount; i++) {
+            if (strncmp(classLabels[i], label, KNN_MAX_LABEL_CHAR - 1) == 0) {
+                classId = i;
+                break;
+            }
+        }
+        if (classId < 0) {
+            if (classCount >= KNN_MAX_CLASSES) return false;
+            strncpy(classLabels[classCount], label, KNN_MAX_LABEL_CHAR - 1);
+            classLabels[classCount][KNN_MAX_LABEL_CHAR - 1] = '\0';
+            classId = classCount++;
+        }
+
+        for (int j = 0; j < Features; j++) {
+            trainingData[currentDataSize][j] = features[j];
+            if (currentDataSize == 0 || features[j] < featureMin[j]) featureMin[j] = features[j];
+            if (currentDataSize == 0 || features[j] > featureMax[j]) featureMax[j] = features[j];
+        }
+        trainingClass[currentDataSize] = (uint8_t) classId;
+
+        currentDataSize++;
+        scaleDirty = true;
+        return true;
+    }
+
+    const char *predict(const float dataPoint[]) {
+        KNNResult result;
+        predictWithConfidence(dataPoint, result);
+        return result.label;
+    }
+
+    bool predictWithConfidence(const float dataPoint[], KNNResult &result) {
+        result.label = "ERROR";
+        result.classId = -1;
+        result.confidence = 0.0f;
+        result.totalVotes = 0.0f;
+        result.neighborCount = 0;
+
+        if (dataPoint == nullptr || currentDataSize == 0) return false;
+
+        int effectiveK = findNearest(dataPoint);
+
+        for (int i = 0; i < classCount; i++) {
+            result.classVotes[i] = 0.0f;
+        }
+
+        int maxVotedClass = trainingClass[bestIndex[0]];
+
+        for (int i = 0; i < effectiveK; i++) {
+            int classId = trainingClass[bestIndex[i]];
+            float vote = useWeightedVoting ? 1.0f / (bestDistance[i] + 0.0001f) : 1.0f;
+
+            result.classVotes[classId] += vote;
+            result.totalVotes += vote;
+
+            if (result.classVotes[classId] > result.classVotes[maxVotedClass]) {
+                maxVotedClass = classId;
+            }
+
+            result.neighborIndices[i] = bestIndex[i];
+            result.neighborDistances[i] = bestDistance[i];
+            result.neighborCount++;
+        }
+
+        if (useWeightedVoting && bestDistance[0] <= 0.0001f) {
+            maxVotedClass = trainingClass[bestIndex[0]];
+        }
+
+        result.classId = maxVotedClass;
+        result.label = classLabels[maxVotedClass];
+        result.confidence = (result.totalVotes > 0.0f) ? (result.classVotes[maxVotedClass] / result.totalVotes) : 0.0f;
+        return true;
+    }
+
+    float getPredictionConfidence(const float dataPoint[]) {
+        KNNResult result;
+        predictWithConfidence(dataPoint, result);
+        return result.confidence;
+    }
+
+    void setWeightedVoting(bool weighted) {
+        useWeightedVoting = weighted;
+    }
+
+    void enableNormalization(bool enable) {
+        normalizationEnabled = enable;
+        scaleDirty = true;
+    }
+
+    void clearTrainingData() {
+        currentDataSize = 0;
+        classCount = 0;
+        scaleDirty = true;
+    }
+
+    int getDataCount() const {
+        return currentDataSize;
+    }
+
+    int getClassCount() const {
+        return classCount;
+    }
+
+    const char *getClassLabel(int classId) const {
+        if (classId < 0 || classId >= classCount) return nullptr;
+        return classLabels[classId];
+    }
+};
+
+#endif
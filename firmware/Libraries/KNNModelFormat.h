@@ -0,0 +1,134 @@
+/*
+ *  KNNModelFormat.h
+ *
+ *  On-disk layout shared by KNN::saveModel/loadModel and KNNModelTool
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef KNN_MODEL_FORMAT_H
+#define KNN_MODEL_FORMAT_H
+
+#pragma message("[COMPILED]: KNNModelFormat.h")
+
+#include <stddef.h>
+#include <stdint.h>
+
+const uint32_t KNN_MODEL_MAGIC = 0x4D4E4E4B;  // "KNNM"
+const uint16_t KNN_MODEL_VERSION = 2;
+const uint32_t KNN_MODEL_ENDIAN_TAG = 0x01020304;
+const uint32_t KNN_MODEL_BLOCK_ALIGNMENT = 16;
+
+/*
+ * A model file is this header followed by five blocks at the given
+ * offsets: class labels (classCount * KNN_MAX_LABEL_CHAR chars), feature
+ * ranges (featureCount mins then featureCount maxes), feature weights
+ * (featureCount floats), class ids (one byte per row) and the feature
+ * store. Version 1 files have no weight block and weightOffset 0. The
+ * store is written exactly as KNN keeps it for the given layout and
+ * precision, so loading is a bulk read per block (one per column for
+ * column-major). Fields are written in the producer's byte order;
+ * endianTag tells a reader whether that matches.
+ *
+ * crc is the CRC-32 of the header with crc zeroed, followed by the
+ * blocks in order. Padding between blocks is not covered.
+ */
+struct KNNModelHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t endianTag;
+    uint32_t crc;
+    uint32_t fileSize;
+    uint16_t featureCount;
+    uint16_t classCount;
+    uint32_t dataCount;
+    uint16_t k;
+    uint8_t metric;
+    uint8_t layout;
+    uint8_t precision;
+    uint8_t weightedVoting;
+    uint8_t normalization;
+    uint8_t reserved0;
+    uint32_t labelOffset;
+    uint32_t rangeOffset;
+    uint32_t classOffset;
+    uint32_t featureOffset;
+    uint32_t weightOffset;
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(KNNModelHeader) == 64, "KNNModelHeader must stay 64 bytes");
+
+const uint32_t KNN_ONLINE_MAGIC = 0x4F4E4E4B;  // "KNNO"
+const uint16_t KNN_ONLINE_VERSION = 1;
+
+/*
+ * The online journal written by KNN::saveOnlineSamples is this header
+ * followed by capacity fixed-size records, one per ring slot, so a delta
+ * save seeks to each changed slot and rewrites only that record and the
+ * file never grows past the ring. A record is a uint32 sequence (0 for
+ * an empty slot), the CRC-32 of the rest of the record, the label
+ * (labelChars chars) and featureCount floats. crc here covers the header
+ * with crc zeroed.
+ */
+struct KNNOnlineHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t endianTag;
+    uint32_t crc;
+    uint16_t featureCount;
+    uint16_t recordSize;
+    uint32_t capacity;
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(KNNOnlineHeader) == 32, "KNNOnlineHeader must stay 32 bytes");
+
+inline uint32_t knnOnlineRecordSize(size_t featureCount, size_t labelChars) {
+    return (uint32_t) (2 * sizeof(uint32_t) + ((labelChars + 3) & ~(size_t) 3) + featureCount * sizeof(float));
+}
+
+/*CRC-32 (IEEE 802.3, same as zlib), nibble-table driven so the table stays 64 bytes*/
+inline uint32_t knnModelCrc32(uint32_t crc, const void *data, size_t length) {
+    static const uint32_t table[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    const uint8_t *bytes = (const uint8_t *) data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/*fills the block offsets and fileSize from the dimension fields*/
+inline void knnModelLayoutBlocks(KNNModelHeader &header, size_t labelChars, size_t elementSize) {
+    uint32_t offset = sizeof(KNNModelHeader);
+
+    header.labelOffset = offset;
+    offset += header.classCount * labelChars;
+
+    offset = (offset + 3) & ~3u;
+    header.rangeOffset = offset;
+    offset += 2 * header.featureCount * sizeof(float);
+
+    header.weightOffset = offset;
+    offset += header.featureCount * sizeof(float);
+
+    header.classOffset = offset;
+    offset += header.dataCount;
+
+    offset = (offset + KNN_MODEL_BLOCK_ALIGNMENT - 1) & ~(KNN_MODEL_BLOCK_ALIGNMENT - 1);
+    header.featureOffset = offset;
+    offset += header.dataCount * header.featureCount * elementSize;
+
+    header.fileSize = offset;
+}
+
+#endif
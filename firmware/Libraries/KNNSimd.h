@@ -0,0 +1,452 @@
+/*
+ *  KNNSimd.h
+ *
+ *  Vector distance kernels for KNN, backend picked at compile time
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef KNN_SIMD_H
+#define KNN_SIMD_H
+
+#pragma message("[COMPILED]: KNNSimd.h")
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * Every kernel reads n contiguous floats or codes. Define KNN_DISABLE_SIMD
+ * to force the scalar loops; KNN only calls these for stride-1 rows and
+ * keeps its own scalar loops for strided ones. The esp-dsp backend has not
+ * been compiled or measured on an S3 yet, so it is opt-in through
+ * KNN_ENABLE_ESP_DSP and the S3 otherwise builds the scalar loops.
+ */
+#if defined(KNN_DISABLE_SIMD)
+#define KNN_SIMD_SCALAR
+#elif defined(KNN_ENABLE_ESP_DSP) && defined(CONFIG_IDF_TARGET_ESP32S3) && defined(__has_include)
+#if __has_include("esp_dsp.h")
+#include "esp_dsp.h"
+#define KNN_SIMD_ESP_DSP
+#else
+#define KNN_SIMD_SCALAR
+#endif
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define KNN_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KNN_SIMD_NEON
+#else
+#define KNN_SIMD_SCALAR
+#endif
+
+#if defined(KNN_SIMD_ESP_DSP)
+/*esp-dsp works on whole arrays, longer rows go through it in chunks of this size*/
+const int KNN_SIMD_CHUNK = 16;
+#endif
+
+/*
+ * Which kernels have a vector body on this backend. A kernel without one
+ * is only its scalar tail loop, and callers keep their own loops for it:
+ * those can stop early on a bound. esp-dsp only covers the squared distance.
+ */
+#if defined(KNN_SIMD_SSE2) || defined(KNN_SIMD_NEON)
+const bool KNN_SIMD_SQUARED = true;
+const bool KNN_SIMD_ABS = true;
+const bool KNN_SIMD_COSINE = true;
+const bool KNN_SIMD_CODES = true;
+#elif defined(KNN_SIMD_ESP_DSP)
+const bool KNN_SIMD_SQUARED = true;
+const bool KNN_SIMD_ABS = false;
+const bool KNN_SIMD_COSINE = false;
+const bool KNN_SIMD_CODES = false;
+#else
+const bool KNN_SIMD_SQUARED = false;
+const bool KNN_SIMD_ABS = false;
+const bool KNN_SIMD_COSINE = false;
+const bool KNN_SIMD_CODES = false;
+#endif
+
+inline const char *knnSimdBackend() {
+#if defined(KNN_SIMD_ESP_DSP)
+    return "esp-dsp";
+#elif defined(KNN_SIMD_SSE2)
+    return "sse2";
+#elif defined(KNN_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#if defined(KNN_SIMD_SSE2)
+inline float knnSimdSum(__m128 v) {
+    __m128 high = _mm_movehl_ps(v, v);
+    __m128 pair = _mm_add_ps(v, high);
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+
+inline uint32_t knnSimdSum(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t) _mm_cvtsi128_si32(v);
+}
+
+inline uint64_t knnSimdSum64(__m128i v) {
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, v);
+    return lanes[0] + lanes[1];
+}
+#endif
+
+/*sum of weight[i] * (a[i] - b[i])^2*/
+inline float knnSimdSquaredDistance(const float *a, const float *b, const float *weight, int n) {
+    float sum = 0.0f;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_mul_ps(diff, diff), _mm_loadu_ps(weight + i)));
+    }
+    sum = knnSimdSum(acc);
+#elif defined(KNN_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t diff = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc = vmlaq_f32(acc, vmulq_f32(diff, diff), vld1q_f32(weight + i));
+    }
+    sum = vaddvq_f32(acc);
+#elif defined(KNN_SIMD_ESP_DSP)
+    float diff[KNN_SIMD_CHUNK];
+    float scaled[KNN_SIMD_CHUNK];
+    while (n - i >= 4) {
+        int length = (n - i < KNN_SIMD_CHUNK) ? (n - i) & ~3 : KNN_SIMD_CHUNK;
+        float part = 0.0f;
+        dsps_sub_f32(a + i, b + i, diff, length, 1, 1, 1);
+        dsps_mul_f32(diff, weight + i, scaled, length, 1, 1, 1);
+        dsps_dotprod_f32(scaled, diff, &part, length);
+        sum += part;
+        i += length;
+    }
+#endif
+
+    for (; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff * weight[i];
+    }
+    return sum;
+}
+
+/*sum of weight[i] * |a[i] - b[i]|*/
+inline float knnSimdAbsDistance(const float *a, const float *b, const float *weight, int n) {
+    float sum = 0.0f;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 diff = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(diff, _mm_loadu_ps(weight + i)));
+    }
+    sum = knnSimdSum(acc);
+#elif defined(KNN_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        acc = vmlaq_f32(acc, vabdq_f32(vld1q_f32(a + i), vld1q_f32(b + i)), vld1q_f32(weight + i));
+    }
+    sum = vaddvq_f32(acc);
+#endif
+
+    for (; i < n; i++) {
+        sum += fabsf(a[i] - b[i]) * weight[i];
+    }
+    return sum;
+}
+
+/*
+ * One pass over both vectors yields the dot product and both squared
+ * norms of x * scale + offset; offset may be nullptr.
+ */
+inline void knnSimdCosineTerms(const float *a, const float *b, const float *scale, const float *offset, int n,
+                               float &dot, float &normA, float &normB) {
+    dot = 0.0f;
+    normA = 0.0f;
+    normB = 0.0f;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    __m128 dotAcc = _mm_setzero_ps();
+    __m128 normAAcc = _mm_setzero_ps();
+    __m128 normBAcc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(scale + i);
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(a + i), s);
+        __m128 y = _mm_mul_ps(_mm_loadu_ps(b + i), s);
+        if (offset != nullptr) {
+            __m128 o = _mm_loadu_ps(offset + i);
+            x = _mm_add_ps(x, o);
+            y = _mm_add_ps(y, o);
+        }
+        dotAcc = _mm_add_ps(dotAcc, _mm_mul_ps(x, y));
+        normAAcc = _mm_add_ps(normAAcc, _mm_mul_ps(x, x));
+        normBAcc = _mm_add_ps(normBAcc, _mm_mul_ps(y, y));
+    }
+    dot = knnSimdSum(dotAcc);
+    normA = knnSimdSum(normAAcc);
+    normB = knnSimdSum(normBAcc);
+#elif defined(KNN_SIMD_NEON)
+    float32x4_t dotAcc = vdupq_n_f32(0.0f);
+    float32x4_t normAAcc = vdupq_n_f32(0.0f);
+    float32x4_t normBAcc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s = vld1q_f32(scale + i);
+        float32x4_t x = vmulq_f32(vld1q_f32(a + i), s);
+        float32x4_t y = vmulq_f32(vld1q_f32(b + i), s);
+        if (offset != nullptr) {
+            float32x4_t o = vld1q_f32(offset + i);
+            x = vaddq_f32(x, o);
+            y = vaddq_f32(y, o);
+        }
+        dotAcc = vmlaq_f32(dotAcc, x, y);
+        normAAcc = vmlaq_f32(normAAcc, x, x);
+        normBAcc = vmlaq_f32(normBAcc, y, y);
+    }
+    dot = vaddvq_f32(dotAcc);
+    normA = vaddvq_f32(normAAcc);
+    normB = vaddvq_f32(normBAcc);
+#endif
+
+    for (; i < n; i++) {
+        float x = a[i] * scale[i] + ((offset != nullptr) ? offset[i] : 0.0f);
+        float y = b[i] * scale[i] + ((offset != nullptr) ? offset[i] : 0.0f);
+        dot += x * y;
+        normA += x * x;
+        normB += y * y;
+    }
+}
+
+/*
+ * Integer kernels compare two rows of quantization codes, n codes each.
+ * Differences are taken as unsigned magnitudes at the code width and only
+ * widened for the multiply, so a row is never dequantized.
+ */
+inline uint32_t knnSimdCodeSquaredDistance(const uint8_t *a, const uint8_t *b, int n) {
+    uint32_t sum = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadl_epi64((const __m128i *) (a + i));
+        __m128i y = _mm_loadl_epi64((const __m128i *) (b + i));
+        __m128i diff = _mm_unpacklo_epi8(_mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x)), zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(diff, diff));
+    }
+    sum = knnSimdSum(acc);
+#elif defined(KNN_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 8 <= n; i += 8) {
+        uint8x8_t diff = vabd_u8(vld1_u8(a + i), vld1_u8(b + i));
+        acc = vpadalq_u16(acc, vmull_u8(diff, diff));
+    }
+    sum = vaddvq_u32(acc);
+#endif
+
+    for (; i < n; i++) {
+        uint32_t diff = (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+/*a 16-bit difference squares within 32 bits, the sum of several does not*/
+inline uint64_t knnSimdCodeSquaredDistance(const uint16_t *a, const uint16_t *b, int n) {
+    uint64_t sum = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+        __m128i diff = _mm_or_si128(_mm_subs_epu16(x, y), _mm_subs_epu16(y, x));
+        __m128i low = _mm_mullo_epi16(diff, diff);
+        __m128i high = _mm_mulhi_epu16(diff, diff);
+        __m128i squares = _mm_unpacklo_epi16(low, high);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(squares, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(squares, zero));
+        squares = _mm_unpackhi_epi16(low, high);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(squares, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(squares, zero));
+    }
+    sum = knnSimdSum64(acc);
+#elif defined(KNN_SIMD_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t diff = vabdq_u16(vld1q_u16(a + i), vld1q_u16(b + i));
+        acc = vpadalq_u32(acc, vmull_u16(vget_low_u16(diff), vget_low_u16(diff)));
+        acc = vpadalq_u32(acc, vmull_high_u16(diff, diff));
+    }
+    sum = vaddvq_u64(acc);
+#endif
+
+    for (; i < n; i++) {
+        uint32_t diff = (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+inline uint32_t knnSimdCodeAbsDistance(const uint8_t *a, const uint8_t *b, int n) {
+    uint32_t sum = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadl_epi64((const __m128i *) (a + i));
+        __m128i y = _mm_loadl_epi64((const __m128i *) (b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(x, y));
+    }
+    sum = (uint32_t) _mm_cvtsi128_si32(acc);
+#elif defined(KNN_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 8 <= n; i += 8) {
+        acc = vpadalq_u16(acc, vmovl_u8(vabd_u8(vld1_u8(a + i), vld1_u8(b + i))));
+    }
+    sum = vaddvq_u32(acc);
+#endif
+
+    for (; i < n; i++) {
+        sum += (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+    }
+    return sum;
+}
+
+inline uint32_t knnSimdCodeAbsDistance(const uint16_t *a, const uint16_t *b, int n) {
+    uint32_t sum = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+        __m128i diff = _mm_or_si128(_mm_subs_epu16(x, y), _mm_subs_epu16(y, x));
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(diff, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(diff, zero));
+    }
+    sum = knnSimdSum(acc);
+#elif defined(KNN_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 8 <= n; i += 8) {
+        acc = vpadalq_u16(acc, vabdq_u16(vld1q_u16(a + i), vld1q_u16(b + i)));
+    }
+    sum = vaddvq_u32(acc);
+#endif
+
+    for (; i < n; i++) {
+        sum += (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+    }
+    return sum;
+}
+
+/*dot product of two code rows and the squared norm of b, for cosine*/
+inline void knnSimdCodeDotTerms(const uint8_t *a, const uint8_t *b, int n, uint64_t &dot, uint64_t &normB) {
+    uint32_t dotSum = 0;
+    uint32_t normSum = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i dotAcc = zero;
+    __m128i normAcc = zero;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (a + i)), zero);
+        __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (b + i)), zero);
+        dotAcc = _mm_add_epi32(dotAcc, _mm_madd_epi16(x, y));
+        normAcc = _mm_add_epi32(normAcc, _mm_madd_epi16(y, y));
+    }
+    dotSum = knnSimdSum(dotAcc);
+    normSum = knnSimdSum(normAcc);
+#elif defined(KNN_SIMD_NEON)
+    uint32x4_t dotAcc = vdupq_n_u32(0);
+    uint32x4_t normAcc = vdupq_n_u32(0);
+    for (; i + 8 <= n; i += 8) {
+        uint8x8_t x = vld1_u8(a + i);
+        uint8x8_t y = vld1_u8(b + i);
+        dotAcc = vpadalq_u16(dotAcc, vmull_u8(x, y));
+        normAcc = vpadalq_u16(normAcc, vmull_u8(y, y));
+    }
+    dotSum = vaddvq_u32(dotAcc);
+    normSum = vaddvq_u32(normAcc);
+#endif
+
+    for (; i < n; i++) {
+        dotSum += (uint32_t) a[i] * b[i];
+        normSum += (uint32_t) b[i] * b[i];
+    }
+    dot = dotSum;
+    normB = normSum;
+}
+
+inline void knnSimdCodeDotTerms(const uint16_t *a, const uint16_t *b, int n, uint64_t &dot, uint64_t &normB) {
+    dot = 0;
+    normB = 0;
+    int i = 0;
+
+#if defined(KNN_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i dotAcc = zero;
+    __m128i normAcc = zero;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+        __m128i dotLow = _mm_mullo_epi16(x, y);
+        __m128i dotHigh = _mm_mulhi_epu16(x, y);
+        __m128i normLow = _mm_mullo_epi16(y, y);
+        __m128i normHigh = _mm_mulhi_epu16(y, y);
+        __m128i products = _mm_unpacklo_epi16(dotLow, dotHigh);
+        dotAcc = _mm_add_epi64(dotAcc, _mm_unpacklo_epi32(products, zero));
+        dotAcc = _mm_add_epi64(dotAcc, _mm_unpackhi_epi32(products, zero));
+        products = _mm_unpackhi_epi16(dotLow, dotHigh);
+        dotAcc = _mm_add_epi64(dotAcc, _mm_unpacklo_epi32(products, zero));
+        dotAcc = _mm_add_epi64(dotAcc, _mm_unpackhi_epi32(products, zero));
+        products = _mm_unpacklo_epi16(normLow, normHigh);
+        normAcc = _mm_add_epi64(normAcc, _mm_unpacklo_epi32(products, zero));
+        normAcc = _mm_add_epi64(normAcc, _mm_unpackhi_epi32(products, zero));
+        products = _mm_unpackhi_epi16(normLow, normHigh);
+        normAcc = _mm_add_epi64(normAcc, _mm_unpacklo_epi32(products, zero));
+        normAcc = _mm_add_epi64(normAcc, _mm_unpackhi_epi32(products, zero));
+    }
+    dot = knnSimdSum64(dotAcc);
+    normB = knnSimdSum64(normAcc);
+#elif defined(KNN_SIMD_NEON)
+    uint64x2_t dotAcc = vdupq_n_u64(0);
+    uint64x2_t normAcc = vdupq_n_u64(0);
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t x = vld1q_u16(a + i);
+        uint16x8_t y = vld1q_u16(b + i);
+        dotAcc = vpadalq_u32(dotAcc, vmull_u16(vget_low_u16(x), vget_low_u16(y)));
+        dotAcc = vpadalq_u32(dotAcc, vmull_high_u16(x, y));
+        normAcc = vpadalq_u32(normAcc, vmull_u16(vget_low_u16(y), vget_low_u16(y)));
+        normAcc = vpadalq_u32(normAcc, vmull_high_u16(y, y));
+    }
+    dot = vaddvq_u64(dotAcc);
+    normB = vaddvq_u64(normAcc);
+#endif
+
+    for (; i < n; i++) {
+        dot += (uint32_t) a[i] * b[i];
+        normB += (uint32_t) b[i] * b[i];
+    }
+}
+
+#endif  // KNN_SIMD_H
@@ -26,13 +26,14 @@ void TaskHandle::setInitCoreID(uint8_t coreID) {
 }
 
 TaskHandle_t *
-TaskHandle::createTask(uint32_t _stack_depth, void (*_task_callback)(void *pvParameter), const char *_task_name) {
-    TaskHandle_t *taskHandler = new TaskHandle_t;
+TaskHandle::createTask(uint32_t _stack_depth, void (*_task_callback)(void *pvParameter), const char *_task_name,
+                       void *_parameter) {
+    TaskHandle_t *taskHandler = new TaskHandle_t(nullptr);
     xTaskCreatePinnedToCore(
             _task_callback,
             _task_name,
             _stack_depth,
-            nullptr,
+            _parameter,
             1,
             taskHandler,
             task_index_);
@@ -75,13 +76,13 @@ void TaskHandle::initialize(void (*_callback)()) {
 
 TaskHandle_t *
 TaskHandle::createTask(uint32_t _stack_depth, int8_t _priority, void (*_task_callback)(void *pvParameter),
-                       const char *_task_name) {
-    TaskHandle_t *taskHandler = new TaskHandle_t;
+                       const char *_task_name, void *_parameter) {
+    TaskHandle_t *taskHandler = new TaskHandle_t(nullptr);
     xTaskCreate(
             _task_callback,
             _task_name,
             _stack_depth,
-            nullptr,
+            _parameter,
             _priority,
             taskHandler);
     return taskHandler;
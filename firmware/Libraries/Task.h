@@ -26,7 +26,8 @@ public:
     void setInitCoreID(uint8_t coreID);
 
     TaskHandle_t *
-    createTask(uint32_t _stack_depth, void (*_task_callback)(void *pvParameter), const char *_task_name = "task");
+    createTask(uint32_t _stack_depth, void (*_task_callback)(void *pvParameter), const char *_task_name = "task",
+               void *_parameter = nullptr);
     void deleteTask(TaskHandle_t _task);
     void delay(uint32_t _time = 20);
 
@@ -57,7 +58,7 @@ public:
     void initialize(void (*_callback)() = nullptr);
     TaskHandle_t *
     createTask(uint32_t _stack_depth, int8_t _priority, void (*_task_callback)(void *pvParameter),
-               const char *_task_name = "task");
+               const char *_task_name = "task", void *_parameter = nullptr);
     void deleteTask(TaskHandle_t _task);
     void delay(uint32_t _time = 20);
 
@@ -1,6 +1,10 @@
 #include "hx711-sens.h"
 #include "Arduino.h"
 
+#if defined(ESP32)
+#include "Task.h"
+#endif
+
 HX711Sens::HX711Sens(uint8_t _sensorDOUTPin, uint8_t _sensorSCKPin, float _format,
                      float _stabilityTolerance, uint8_t _sampleCount,
                      uint32_t _stabilityTime, float _resetThreshold)
@@ -18,14 +22,24 @@ HX711Sens::HX711Sens(uint8_t _sensorDOUTPin, uint8_t _sensorSCKPin, float _forma
           weightIndex(0),
           isLocked(false),
           lockedWeight(0.0),
-          stabilityTimer(0) {
+          stabilityTimer(0),
+          sampleHead(0),
+          sampleTail(0),
+          droppedSamples(0),
+          samplingEnabled(false) {
     lastWeights = new float[sampleCount];
     for (uint8_t i = 0; i < sampleCount; i++) {
         lastWeights[i] = 0.0;
     }
+#if defined(ESP32)
+    samplingTaskHandle = nullptr;
+    busLock = nullptr;
+    busActive = false;
+#endif
 }
 
 HX711Sens::~HX711Sens() {
+    endSampling();
     if (lastWeights != nullptr) {
         delete[] lastWeights;
         lastWeights = nullptr;
@@ -38,64 +52,235 @@ bool HX711Sens::init() {
         name = "HX711Sens";
         doc = new JsonDocument;
     }
-    (*doc)[name] = 0;
+    if (sensorValue == nullptr) sensorValue = &fallbackValue;
+    sensorValue->set(0.0f);
     return true;
 }
 
 bool HX711Sens::update() {
+    if (samplingEnabled) {
+        RawSample sample;
+        float finalValue = 0.0;
+        bool drained = false;
+        float scale = this->get_scale();
+        long offset = this->get_offset();
+        while (popSample(sample)) {
+            float units = (float) (sample.counts - offset) / scale;
+            finalValue = processWeight(units, sample.timeMs);
+            drained = true;
+        }
+        if (drained) sensorValue->set(finalValue);
+        return drained;
+    }
+
     if (millis() - sensorTimer[0] >= 500) {
         if (this->is_ready()) {
-            float units = this->get_units();
-            if (units < 0) units = 0.0;
-            units = units / format;
-
-            if (lastWeights == nullptr) {
-                lastWeights = new float[sampleCount];
-                for (uint8_t i = 0; i < sampleCount; i++) {
-                    lastWeights[i] = 0.0;
-                }
-            }
+            sensorValue->set(processWeight(this->get_units(), millis()));
+            return true;
+        }
+        sensorTimer[0] = millis();
+    }
+    return false;
+}
 
-            lastWeights[weightIndex] = units;
-            weightIndex = (weightIndex + 1) % sampleCount;
+/*
+ * Converts one reading to the configured unit, clamping negatives to zero,
+ * and locks the weight once it has held still for stabilityTime. timeMs is
+ * when the conversion was read, so samples drained from the FIFO lock on
+ * their own timestamps rather than the time of the drain. The lock releases
+ * only when the load drops under resetThreshold.
+ */
+float HX711Sens::processWeight(float units, uint32_t timeMs) {
+    if (units < 0) units = 0.0;
+    units = units / format;
 
-            bool isStable = true;
-            float firstWeight = lastWeights[0];
-            for (uint8_t i = 1; i < sampleCount; i++) {
-                if (abs(lastWeights[i] - firstWeight) > stabilityTolerance) {
-                    isStable = false;
-                    break;
-                }
-            }
+    if (!weightPipeline.isEmpty()) units = weightPipeline.apply(units);
 
-            if (units < resetThreshold) {
-                isLocked = false;
-                lockedWeight = 0.0;
-            } else if (isStable && !isLocked) {
-                if (stabilityTimer == 0) {
-                    stabilityTimer = millis();
-                } else if (millis() - stabilityTimer > stabilityTime) {
-                    isLocked = true;
-                    lockedWeight = units;
-                }
-            } else if (!isStable) {
-                stabilityTimer = 0;
+    bool isStable = true;
+    if (weightPipeline.tracksStability()) {
+        isStable = weightPipeline.isSettled() && weightPipeline.getDeviation() <= stabilityTolerance;
+    } else {
+        if (lastWeights == nullptr) {
+            lastWeights = new float[sampleCount];
+            for (uint8_t i = 0; i < sampleCount; i++) {
+                lastWeights[i] = 0.0;
             }
+        }
 
-            float finalValue = isLocked ? lockedWeight : units;
+        lastWeights[weightIndex] = units;
+        weightIndex = (weightIndex + 1) % sampleCount;
 
-            if (sensorFilterCb != nullptr) {
-                finalValue = sensorFilterCb(finalValue);
+        float firstWeight = lastWeights[0];
+        for (uint8_t i = 1; i < sampleCount; i++) {
+            if (abs(lastWeights[i] - firstWeight) > stabilityTolerance) {
+                isStable = false;
+                break;
             }
+        }
+    }
 
-            (*doc)[name] = finalValue;
-            return true;
+    if (units < resetThreshold) {
+        isLocked = false;
+        lockedWeight = 0.0;
+    } else if (isStable && !isLocked) {
+        if (stabilityTimer == 0) {
+            stabilityTimer = timeMs;
+        } else if (timeMs - stabilityTimer > stabilityTime) {
+            isLocked = true;
+            lockedWeight = units;
         }
-        sensorTimer[0] = millis();
+    } else if (!isStable) {
+        stabilityTimer = 0;
     }
-    return false;
+
+    float finalValue = isLocked ? lockedWeight : units;
+
+    if (sensorFilterCb != nullptr) {
+        finalValue = sensorFilterCb(finalValue);
+    }
+    return finalValue;
+}
+
+/*stages see the configured unit, after the scale factor and before the lock*/
+SensorPipeline &HX711Sens::pipeline() {
+    return weightPipeline;
 }
 
+/*
+ * Hands conversions to a sampling task instead of polling from update().
+ * On ESP32 the DOUT falling edge wakes a task on coreID that reads the
+ * 24 bits and queues the raw count, so update() only drains the ring and
+ * every conversion of the chip (10 or 80 SPS) is kept. Other builds have
+ * no task: update() drains whatever captureSample() was given.
+ */
+bool HX711Sens::beginSampling(uint8_t coreID) {
+    if (samplingEnabled) return true;
+    sampleHead = 0;
+    sampleTail = 0;
+    droppedSamples = 0;
+
+#if defined(ESP32)
+    busLock = xSemaphoreCreateMutex();
+    if (busLock == nullptr) return false;
+
+    TaskHandle tasks;
+    tasks.setInitCoreID(coreID);
+    TaskHandle_t *handle = tasks.createTask(HX711_SAMPLE_TASK_STACK, samplingTask, "hx711Sample", this);
+    samplingTaskHandle = *handle;
+    delete handle;
+    if (samplingTaskHandle == nullptr) {
+        vSemaphoreDelete(busLock);
+        busLock = nullptr;
+        return false;
+    }
+    attachInterruptArg(digitalPinToInterrupt(sensorDOUTPin), dataReadyISR, this, FALLING);
+#else
+    (void) coreID;
+#endif
+
+    samplingEnabled = true;
+    return true;
+}
+
+void HX711Sens::endSampling() {
+    if (!samplingEnabled) return;
+    samplingEnabled = false;
+
+#if defined(ESP32)
+    detachInterrupt(digitalPinToInterrupt(sensorDOUTPin));
+    /*holding the bus means the task is parked, never mid-transfer*/
+    xSemaphoreTake(busLock, portMAX_DELAY);
+    vTaskDelete(samplingTaskHandle);
+    samplingTaskHandle = nullptr;
+    xSemaphoreGive(busLock);
+    vSemaphoreDelete(busLock);
+    busLock = nullptr;
+#endif
+}
+
+bool HX711Sens::isSampling() const {
+    return samplingEnabled;
+}
+
+/*
+ * Reads one conversion into the ring, the deferred half of the DOUT
+ * interrupt. Does nothing while the chip is still converting.
+ */
+void HX711Sens::captureSample() {
+    lockBus();
+    if (this->is_ready()) pushSample(this->read());
+    unlockBus();
+}
+
+uint32_t HX711Sens::getDroppedSamples() const {
+    return __atomic_load_n(&droppedSamples, __ATOMIC_RELAXED);
+}
+
+void HX711Sens::tare(byte times) {
+    lockBus();
+    HX711::tare(times);
+    unlockBus();
+}
+
+/*a full ring keeps the older samples, update() has fallen behind anyway*/
+bool HX711Sens::pushSample(long counts) {
+    uint32_t head = __atomic_load_n(&sampleHead, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&sampleTail, __ATOMIC_ACQUIRE);
+    if (head - tail >= HX711_SAMPLE_RING_SIZE) {
+        __atomic_store_n(&droppedSamples, droppedSamples + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    RawSample &slot = sampleRing[head & (HX711_SAMPLE_RING_SIZE - 1)];
+    slot.counts = counts;
+    slot.timeMs = millis();
+    __atomic_store_n(&sampleHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool HX711Sens::popSample(RawSample &sample) {
+    uint32_t tail = __atomic_load_n(&sampleTail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&sampleHead, __ATOMIC_ACQUIRE);
+    if (tail == head) return false;
+    sample = sampleRing[tail & (HX711_SAMPLE_RING_SIZE - 1)];
+    __atomic_store_n(&sampleTail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void HX711Sens::lockBus() {
+#if defined(ESP32)
+    if (busLock == nullptr) return;
+    xSemaphoreTake(busLock, portMAX_DELAY);
+    busActive = true;
+#endif
+}
+
+void HX711Sens::unlockBus() {
+#if defined(ESP32)
+    if (busLock == nullptr) return;
+    busActive = false;
+    xSemaphoreGive(busLock);
+#endif
+}
+
+#if defined(ESP32)
+/*clocking the bits out toggles DOUT too, those edges are ignored*/
+void IRAM_ATTR HX711Sens::dataReadyISR(void *arg) {
+    HX711Sens *sensor = (HX711Sens *) arg;
+    if (sensor->busActive) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(sensor->samplingTaskHandle, &woken);
+    if (woken == pdTRUE) portYIELD_FROM_ISR();
+}
+
+void HX711Sens::samplingTask(void *parameter) {
+    HX711Sens *sensor = (HX711Sens *) parameter;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HX711_SAMPLE_TIMEOUT_MS));
+        sensor->captureSample();
+    }
+}
+#endif
+
 void HX711Sens::setDocument(const char *objName) {
     name = objName;
 }
@@ -105,10 +290,12 @@ void HX711Sens::setDocumentValue(JsonDocument *docBase) {
 }
 
 JsonDocument HX711Sens::getDocument() {
+    sensorValue->toJson(*doc, name);
     return (*doc);
 }
 
 JsonVariant HX711Sens::getVariant(const char *searchName) {
+    sensorValue->toJson(*doc, name);
     return (*doc)[searchName];
 }
 
@@ -126,7 +313,7 @@ float HX711Sens::getCalibrateFactorInit(float weight) {
         Serial.println("Tare done...");
         Serial.print("Place a known weight on the scale...");
         delay(5000);
-        float reading = this->get_units(10);
+        float reading = this->getUnits(10);
         Serial.print("| reading: ");
         Serial.print(reading);
         Serial.print("| result: ");
@@ -157,11 +344,17 @@ void HX711Sens::tareDelay(long time) {
 }
 
 float HX711Sens::getUnits(byte time) {
-    return this->get_units(time);
+    lockBus();
+    float units = this->get_units(time);
+    unlockBus();
+    return units;
 }
 
 uint32_t HX711Sens::getADC(byte times) {
-    return this->read_average(times);
+    lockBus();
+    uint32_t counts = this->read_average(times);
+    unlockBus();
+    return counts;
 }
 
 float HX711Sens::getCalibrateFactor(float units, float weight) {
@@ -169,7 +362,7 @@ float HX711Sens::getCalibrateFactor(float units, float weight) {
 }
 
 float HX711Sens::getValueWeight(bool isCanZero) const {
-    float value = (*doc)[name].as<float>();
+    float value = sensorValue->getFloat();
     if (isCanZero) return value;
     return value < 0 ? 0 : value;
 }
@@ -207,4 +400,12 @@ void HX711Sens::resetLock() {
     isLocked = false;
     lockedWeight = 0.0;
     stabilityTimer = 0;
+}
+
+bool HX711Sens::isValueLocked() const {
+    return isLocked;
+}
+
+float HX711Sens::getLockedValue() const {
+    return lockedWeight;
 }
\ No newline at end of file
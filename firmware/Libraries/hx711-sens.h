@@ -9,10 +9,21 @@
 #include "base/sensor-module.h"
 #include "HX711.h"
 
+/*raw conversions between the sampling task and update(), a power of two*/
+#define HX711_SAMPLE_RING_SIZE 16
+
+#if defined(ESP32)
+#define HX711_SAMPLE_TASK_STACK 2048
+/*a missed DOUT edge only costs this long before the task polls the pin*/
+#define HX711_SAMPLE_TIMEOUT_MS 200
+#endif
+
 class HX711Sens : public BaseSens, public HX711 {
 private:
     JsonDocument *doc;
     const char *name;
+    /*weight slot when the module registry is full or the driver runs standalone*/
+    SensorValue fallbackValue;
 
     uint32_t sensorTimer[2];
     uint8_t sensorDOUTPin;
@@ -25,12 +36,40 @@ private:
     uint32_t stabilityTime;
     float resetThreshold;
 
+    SensorPipeline weightPipeline;
     float *lastWeights;
     uint8_t weightIndex;
     bool isLocked;
     float lockedWeight;
     uint32_t stabilityTimer;
 
+    struct RawSample {
+        long counts;
+        uint32_t timeMs;
+    };
+
+    /*single producer (captureSample) and single consumer (update) ring*/
+    RawSample sampleRing[HX711_SAMPLE_RING_SIZE];
+    uint32_t sampleHead;
+    uint32_t sampleTail;
+    uint32_t droppedSamples;
+    bool samplingEnabled;
+
+#if defined(ESP32)
+    TaskHandle_t samplingTaskHandle;
+    SemaphoreHandle_t busLock;
+    volatile bool busActive;
+
+    static void dataReadyISR(void *arg);
+    static void samplingTask(void *parameter);
+#endif
+
+    bool pushSample(long counts);
+    bool popSample(RawSample &sample);
+    float processWeight(float units, uint32_t timeMs);
+    void lockBus();
+    void unlockBus();
+
     using HX711::HX711;
 
 public:
@@ -47,6 +86,14 @@ public:
     JsonVariant getVariant(const char *searchName) override;
 
     void filter(float (*sensorFilterCallback)(float value) = nullptr);
+    SensorPipeline &pipeline();
+
+    bool beginSampling(uint8_t coreID = 0);
+    void endSampling();
+    [[nodiscard]] bool isSampling() const;
+    void captureSample();
+    [[nodiscard]] uint32_t getDroppedSamples() const;
+    void tare(byte times = 10);
 
     float getCalibrateFactorInit(float weight);
     bool isReady();
@@ -64,6 +111,8 @@ public:
     void setStabilityTime(uint32_t time);
     void setResetThreshold(float threshold);
     void resetLock();
+    [[nodiscard]] bool isValueLocked() const;
+    [[nodiscard]] float getLockedValue() const;
 
     constexpr static const float G = 1.0;
     constexpr static const float KG = 1000.0;
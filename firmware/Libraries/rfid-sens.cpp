@@ -16,24 +16,28 @@ bool RFID_Mfrc522::init() {
         name = "RFID_Mfrc522";
         doc = new JsonDocument;
     }
+    if (sensorValue == nullptr) sensorValue = &fallbackValue;
     SPI.begin();
     MFRC522::PCD_Init();
-    (*doc)[name] = "";
+    sensorValue->set("");
     return true;
 }
 
 bool RFID_Mfrc522::update() {
-    String uuid = "";
     if (MFRC522::PICC_IsNewCardPresent() && MFRC522::PICC_ReadCardSerial()) {
-        for (byte i = 0; i < MFRC522::uid.size; i++) {
-            uuid += String(MFRC522::uid.uidByte[i], HEX);
+        /*same unpadded lowercase hex per byte as String(byte, HEX) gave*/
+        char uuid[SENSOR_VALUE_TEXT_CHAR];
+        int length = 0;
+        for (byte i = 0; i < MFRC522::uid.size && length < SENSOR_VALUE_TEXT_CHAR - 2; i++) {
+            length += snprintf(uuid + length, SENSOR_VALUE_TEXT_CHAR - length, "%x", MFRC522::uid.uidByte[i]);
         }
-        (*doc)[name] = uuid;
+        uuid[length] = '\0';
+        sensorValue->set(uuid);
         MFRC522::PICC_HaltA();
         MFRC522::PCD_StopCrypto1();
         return true;
     }
-    (*doc)[name] = "";
+    sensorValue->set("");
     return false;
 }
 
@@ -46,15 +50,19 @@ void RFID_Mfrc522::setDocumentValue(JsonDocument *docBase) {
 }
 
 JsonDocument RFID_Mfrc522::getDocument() {
+    sensorValue->toJson(*doc, name);
     return (*doc);
 }
 
 JsonVariant RFID_Mfrc522::getVariant(const char *searchName) {
+    sensorValue->toJson(*doc, name);
     return (*doc)[searchName];
 }
 
 String RFID_Mfrc522::getValueRFID_Mfrc522() const {
-    return (*doc)[name].as<String>();
+    char uuid[SENSOR_VALUE_TEXT_CHAR];
+    sensorValue->getText(uuid, sizeof(uuid));
+    return String(uuid);
 }
 
 void RFID_Mfrc522::setPins(uint8_t _pin) {
@@ -21,6 +21,8 @@ class RFID_Mfrc522 : public BaseSens, public MFRC522 {
 private:
     JsonDocument *doc;
     const char *name;
+    /*tag slot when no registry slot was attached*/
+    SensorValue fallbackValue;
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
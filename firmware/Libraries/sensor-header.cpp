@@ -5,14 +5,14 @@
  *  Created on: 2023. 4. 3
  */
 
+#include "sensor-header.h"
+
+#if defined(__AVR__)
+
 extern unsigned int __bss_end;
 extern unsigned int __heap_start;
 extern void *__brkval;
 
-#include "sensor-header.h"
-
-#if !defined(ESP32)
-
 int freeMemory() {
     int free_memory;
 
@@ -24,6 +24,13 @@ int freeMemory() {
     return free_memory;
 }
 
+#elif !defined(ESP32)
+
+/*no heap probe off AVR, e.g. the host benchmark build*/
+int freeMemory() {
+    return -1;
+}
+
 #endif
 
 float mapFloat(float x, float in_min, float in_max, float out_min, float out_max) {
@@ -37,4 +37,12 @@ JsonVariant BaseSens::getVariant(const char *searchName) {
 
 void BaseSens::process() {
     /*not implemented yet*/
+}
+
+void BaseSens::attachValue(SensorValue *valueSlot) {
+    sensorValue = valueSlot;
+}
+
+SensorValue *BaseSens::getSensorValue() const {
+    return sensorValue;
 }
\ No newline at end of file
@@ -9,13 +9,18 @@
 #include "sensor-module.h"
 
 SensorModule::SensorModule()
-        : base(nullptr),
+        : doc(nullptr),
+          base(nullptr),
           name(nullptr),
           len(0),
           lenName(0),
+          capacity(0),
+          moduleHandle(nullptr),
+          handleIndex(nullptr),
           sensorInit(nullptr),
           sensorEnable(false),
-          sensorReady(false) {
+          sensorReady(false),
+          valueUsed(0) {
 }
 
 SensorModule::~SensorModule() {
@@ -24,6 +29,11 @@ SensorModule::~SensorModule() {
         base = nullptr;
         len = 0;
     }
+    free(moduleHandle);
+    free(handleIndex);
+    moduleHandle = nullptr;
+    handleIndex = nullptr;
+    capacity = 0;
     if (doc != nullptr) {
         delete doc;
         doc = nullptr;
@@ -73,6 +83,14 @@ void SensorModule::update(void (*updateCallback)(void)) {
 void SensorModule::update(const char *searchName) {
     if (base == nullptr || !sensorEnable) return;
     BaseSens *module = getModuleByNamePtr(searchName);
+    if (module == nullptr) return;
+    module->update();
+    if (!sensorReady) sensorReady = true;
+}
+
+void SensorModule::update(SensorHandle handle) {
+    BaseSens *module = getModulePtr(handle);
+    if (module == nullptr || !sensorEnable) return;
     module->update();
     if (!sensorReady) sensorReady = true;
 }
@@ -94,64 +112,193 @@ bool SensorModule::isEnable() const {
     return sensorEnable;
 }
 
-void SensorModule::addModule(BaseSens *sensModule) {
-    auto **newBase = (BaseSens **) realloc(base, (len + 1) * sizeof(BaseSens *));  // increase length by 1
-    if (newBase == nullptr) {
+/*grows the module, name and handle tables together to exactly target entries*/
+bool SensorModule::grow(uint8_t target) {
+    if (target <= capacity) return true;
+    if (target > SENSOR_MODULE_MAX_MODULES) return false;
+
+    auto **newBase = (BaseSens **) realloc(base, target * sizeof(BaseSens *));
+    if (newBase == nullptr) return false;
+    base = newBase;
+    auto **newName = (char **) realloc(name, target * sizeof(char *));
+    if (newName == nullptr) return false;
+    name = newName;
+    auto *newModuleHandle = (uint8_t *) realloc(moduleHandle, target);
+    if (newModuleHandle == nullptr) return false;
+    moduleHandle = newModuleHandle;
+    auto *newHandleIndex = (uint8_t *) realloc(handleIndex, target);
+    if (newHandleIndex == nullptr) return false;
+    handleIndex = newHandleIndex;
+
+    for (int i = capacity; i < target; i++) {
+        handleIndex[i] = SENSOR_HANDLE_NONE.id;
+    }
+    capacity = target;
+    return true;
+}
+
+/*
+ * Room for count entries when adding past the capacity, doubling so a run
+ * of addModule() calls reallocates only a few times. Call reserve() up
+ * front to allocate once.
+ */
+bool SensorModule::growFor(uint8_t count) {
+    if (count <= capacity) return true;
+    int target = (capacity < 4) ? 4 : capacity * 2;
+    if (target < count) target = count;
+    if (target > SENSOR_MODULE_MAX_MODULES) target = SENSOR_MODULE_MAX_MODULES;
+    return grow(target);
+}
+
+bool SensorModule::reserve(uint8_t count) {
+    if (grow(count)) return true;
+    Serial.println("Memory Allocation Failed !");
+    return false;
+}
+
+uint8_t SensorModule::getCapacity() const {
+    return capacity;
+}
+
+SensorHandle SensorModule::addModule(BaseSens *sensModule) {
+    if (len >= capacity && !growFor(len + 1)) {
         Serial.println("Memory Allocation Failed !");
-        return;
+        return SENSOR_HANDLE_NONE;
     }
-    base = newBase;
+    uint8_t id = 0;
+    while (handleIndex[id] != SENSOR_HANDLE_NONE.id) id++;  // a free id exists while len < capacity
+
     base[len] = sensModule;  // assign to correct index
+    moduleHandle[len] = id;
+    handleIndex[id] = len;
     len++;
+
+    /*the slot is bound here, so handles taken any time later stay valid*/
+    SensorValue *valueSlot = claimValue();
+    if (valueSlot != nullptr) sensModule->attachValue(valueSlot);
+    else Serial.println("Sensor Value Registry Full !");
+    return {id};
+}
+
+SensorValue *SensorModule::claimValue() {
+    for (uint8_t i = 0; i < SENSOR_MODULE_MAX_VALUES; i++) {
+        if (!(valueUsed & (1u << i))) {
+            valueUsed |= (1u << i);
+            values[i].clear();
+            return &values[i];
+        }
+    }
+    return nullptr;
+}
+
+void SensorModule::releaseValue(SensorValue *valueSlot) {
+    if (valueSlot < values || valueSlot >= values + SENSOR_MODULE_MAX_VALUES) return;
+    valueUsed &= ~(1u << (valueSlot - values));
 }
 
 void SensorModule::addName(const char *newName) {
+    if (lenName >= capacity && !growFor(lenName + 1)) return;
     char *dynamicName = (char *) malloc(strlen(newName) + 1);
     if (dynamicName != nullptr) {
         strcpy(dynamicName, newName);
-        char **newTextArray = (char **) realloc(name, (lenName + 1) * sizeof(char *));
-        if (newTextArray != nullptr) {
-            newTextArray[lenName] = dynamicName;
-            name = newTextArray;
-            lenName++;
-        } else {
-            free(dynamicName);
-        }
+        name[lenName] = dynamicName;
+        lenName++;
     }
 }
 
-void SensorModule::addModule(const char *newName, BaseSens *sensModule) {
-    addModule(sensModule);
-    addName(newName);
+SensorHandle SensorModule::addModule(const char *newName, BaseSens *sensModule) {
+    SensorHandle handle = addModule(sensModule);
+    if (handle.isValid()) addName(newName);
+    return handle;
 }
 
-void SensorModule::addModule(const char *newName, BaseSens *(*callbackSensModule)()) {
+SensorHandle SensorModule::addModule(const char *newName, BaseSens *(*callbackSensModule)()) {
     BaseSens *sensModule = callbackSensModule();
-    if (sensModule != nullptr) addModule(newName, sensModule);
-    else Serial.println("Error Add Module");
+    if (sensModule != nullptr) return addModule(newName, sensModule);
+    Serial.println("Error Add Module");
+    return SENSOR_HANDLE_NONE;
 }
 
+/*the module's name and handle go with it; handles of the modules after it stay valid*/
 void SensorModule::removeModule(uint8_t index) {
     if (base == nullptr || index >= len) return;
+    releaseValue(base[index]->getSensorValue());
     delete base[index];
+    handleIndex[moduleHandle[index]] = SENSOR_HANDLE_NONE.id;
     for (uint8_t i = index; i < len - 1; i++) {
         base[i] = base[i + 1];
+        moduleHandle[i] = moduleHandle[i + 1];
+        handleIndex[moduleHandle[i]] = i;
+        if (sensorInit != nullptr) sensorInit[i] = sensorInit[i + 1];
     }
     len--;
-    auto **newBase = (BaseSens **) realloc(base, len * sizeof(BaseSens *));
-    if (newBase != nullptr) {
-        base = newBase;
+
+    if (index < lenName) {
+        free(name[index]);
+        for (uint8_t i = index; i < lenName - 1; i++) {
+            name[i] = name[i + 1];
+        }
+        lenName--;
     }
 }
 
 JsonVariant SensorModule::operator[](const char *searchName) {
-    auto module = getModuleByNamePtr(searchName);
-    return module->getVariant(searchName);
+    return operator[](getHandle(searchName));
+}
+
+JsonVariant SensorModule::operator[](SensorHandle handle) {
+    int index = getIndex(handle);
+    if (index < 0 || index >= lenName) return JsonVariant();
+    SensorValue *valueSlot = base[index]->getSensorValue();
+    if (valueSlot == nullptr || doc == nullptr) return base[index]->getVariant(name[index]);
+    valueSlot->toJson(*doc, name[index]);
+    return (*doc)[name[index]];
 }
 
 JsonDocument SensorModule::operator()(const char *searchName) {
-    auto module = getModuleByNamePtr(searchName);
-    return module->getDocument();
+    return toJson();
+}
+
+int SensorModule::findIndex(const char *searchName) const {
+    if (searchName == nullptr) return -1;
+    for (uint8_t i = 0; i < lenName && i < len; i++) {
+        if (strcmp(name[i], searchName) == 0) return i;
+    }
+    return -1;
+}
+
+/*the one name comparison; keep the handle and use it from then on*/
+SensorHandle SensorModule::getHandle(const char *searchName) const {
+    int index = findIndex(searchName);
+    if (index < 0) return SENSOR_HANDLE_NONE;
+    return {moduleHandle[index]};
+}
+
+/*current position of the module, -1 once it was removed*/
+int SensorModule::getIndex(SensorHandle handle) const {
+    if (!handle.isValid() || handle.id >= capacity) return -1;
+    uint8_t index = handleIndex[handle.id];
+    return (index == SENSOR_HANDLE_NONE.id) ? -1 : index;
+}
+
+/*resolve once at setup, then read the typed value every loop without a name lookup*/
+const SensorValue *SensorModule::getValueHandle(const char *searchName) {
+    return getValueHandle(getHandle(searchName));
+}
+
+const SensorValue *SensorModule::getValueHandle(SensorHandle handle) const {
+    BaseSens *module = getModulePtr(handle);
+    return (module != nullptr) ? module->getSensorValue() : nullptr;
+}
+
+/*JSON view of every value, refreshed from the registry on each call*/
+JsonDocument &SensorModule::toJson() {
+    if (doc == nullptr) doc = new JsonDocument;
+    for (uint8_t i = 0; i < lenName && i < len; i++) {
+        SensorValue *valueSlot = base[i]->getSensorValue();
+        if (valueSlot != nullptr) valueSlot->toJson(*doc, name[i]);
+    }
+    return *doc;
 }
 
 BaseSens &SensorModule::getModule(uint8_t index) {
@@ -163,22 +310,33 @@ BaseSens * SensorModule::getModulePtr(uint8_t index) const {
     return base[index];
 }
 
-BaseSens &SensorModule::getModuleByName(const char *searchName) {
-    int count = 0;
-    for (int i = 0; i < lenName; ++i) {
-        if (strcmp(name[i], searchName) == 0) return *(base[i]);
-        count++;
+/*what getModuleByName() hands back for a name that was never added*/
+class MissingSens : public BaseSens {
+public:
+    bool init() override {
+        return false;
     }
-    return *(base[count]);
+
+    bool update() override {
+        return false;
+    }
+};
+
+static MissingSens missingModule;
+
+BaseSens &SensorModule::getModuleByName(const char *searchName) {
+    int index = findIndex(searchName);
+    return (index >= 0) ? *(base[index]) : missingModule;
 }
 
 BaseSens *SensorModule::getModuleByNamePtr(const char *searchName) {
-    int count = 0;
-    for (int i = 0; i < lenName; ++i) {
-        if (strcmp(name[i], searchName) == 0) return base[i];
-        count++;
-    }
-    return base[count];
+    int index = findIndex(searchName);
+    return (index >= 0) ? base[index] : nullptr;
+}
+
+BaseSens *SensorModule::getModulePtr(SensorHandle handle) const {
+    int index = getIndex(handle);
+    return (index >= 0) ? base[index] : nullptr;
 }
 
 char * SensorModule::getName(uint8_t index) const {
@@ -192,20 +350,25 @@ char **SensorModule::getNames() {
 void SensorModule::clearModules() {
     if (base == nullptr) return;
     for (uint8_t i = 0; i < len; i++) {
+        releaseValue(base[i]->getSensorValue());
         delete base[i];
     }
     free(base);
     base = nullptr;
     len = 0;
 
-    if (lenName > 0) {
-        for (int i = 0; i < lenName; ++i) {
-            free(name[i]);
-        }
-        free(name);
-        name = nullptr;
-        lenName = 0;
+    for (int i = 0; i < lenName; ++i) {
+        free(name[i]);
     }
+    free(name);
+    name = nullptr;
+    lenName = 0;
+
+    free(moduleHandle);
+    free(handleIndex);
+    moduleHandle = nullptr;
+    handleIndex = nullptr;
+    capacity = 0;
 
     if (doc != nullptr) {
         delete doc;
@@ -219,8 +382,13 @@ uint8_t SensorModule::getModuleCount() const {
 
 void SensorModule::setModule(uint8_t index, BaseSens *sensModule) {
     if (base == nullptr || index >= len) return;
+    SensorValue *valueSlot = base[index]->getSensorValue();
     delete base[index];
     base[index] = sensModule;
+    if (valueSlot != nullptr && valueSlot >= values && valueSlot < values + SENSOR_MODULE_MAX_VALUES) {
+        valueSlot->clear();
+        sensModule->attachValue(valueSlot);
+    }
 }
 
 void SensorModule::swapModules(uint8_t index1, uint8_t index2) {
@@ -228,6 +396,23 @@ void SensorModule::swapModules(uint8_t index1, uint8_t index2) {
     BaseSens *temp = base[index1];
     base[index1] = base[index2];
     base[index2] = temp;
+
+    /*names and handles follow their modules*/
+    uint8_t handle = moduleHandle[index1];
+    moduleHandle[index1] = moduleHandle[index2];
+    moduleHandle[index2] = handle;
+    handleIndex[moduleHandle[index1]] = index1;
+    handleIndex[moduleHandle[index2]] = index2;
+    if (index1 < lenName && index2 < lenName) {
+        char *tempName = name[index1];
+        name[index1] = name[index2];
+        name[index2] = tempName;
+    }
+    if (sensorInit != nullptr) {
+        bool tempInit = sensorInit[index1];
+        sensorInit[index1] = sensorInit[index2];
+        sensorInit[index2] = tempInit;
+    }
 }
 
 bool SensorModule::isModulePresent(BaseSens *sensModule) {
@@ -387,7 +572,7 @@ void SensorModule::debugPretty(uint32_t time) {
     if (!isReady()) return;
     static uint32_t debugPrettyTime = 0;
     if (millis() - debugPrettyTime >= time) {
-        serializeJsonPretty((*doc), Serial);
+        serializeJsonPretty(toJson(), Serial);
         debugPrettyTime = millis();
     }
 }
@@ -17,11 +17,37 @@
 
 #include "sensor-debug.h"
 #include "sensor-header.h"
+#include "sensor-value.h"
+#include "sensor-pipeline.h"
 //#include "sensor-calibration.h"
 #include "../addons/sensor-filter.h"
 
+/*fixed value slots of one SensorModule, a module added past them keeps its own*/
+const int SENSOR_MODULE_MAX_VALUES = 16;
+const uint8_t SENSOR_MODULE_MAX_MODULES = 254;
+
+/*
+ * Token for one added module, returned by addModule() or looked up once by
+ * name with getHandle(). It keeps addressing the same module when others
+ * are removed or swapped, and resolves in O(1) without comparing names.
+ */
+struct SensorHandle {
+    uint8_t id;
+
+    bool isValid() const {
+        return id != 0xFF;
+    }
+};
+
+const SensorHandle SENSOR_HANDLE_NONE = {0xFF};
+
 class BaseSens {
+protected:
+    SensorValue *sensorValue = nullptr;
+
 public:
+    virtual ~BaseSens() = default;
+
     /*pure virtual function*/
     virtual bool init() = 0;
     virtual bool update() = 0;
@@ -40,6 +66,9 @@ public:
     /*additional function*/
     virtual void process();
 
+    void attachValue(SensorValue *valueSlot);
+    SensorValue *getSensorValue() const;
+
     BaseSens &operator=(const BaseSens &) = default;
     BaseSens &operator=(BaseSens &&) = default;
 };
@@ -51,9 +80,21 @@ private:
     char **name;
     uint8_t len;
     uint8_t lenName;
+    uint8_t capacity;
+    uint8_t *moduleHandle;
+    uint8_t *handleIndex;
     bool *sensorInit;
     bool sensorEnable;
     bool sensorReady;
+
+    SensorValue values[SENSOR_MODULE_MAX_VALUES];
+    uint16_t valueUsed;
+
+    SensorValue *claimValue();
+    void releaseValue(SensorValue *valueSlot);
+    bool grow(uint8_t target);
+    bool growFor(uint8_t count);
+    int findIndex(const char *searchName) const;
 public:
     SensorModule();
     ~SensorModule();
@@ -61,27 +102,41 @@ public:
     virtual void init(void (*initializeCallback)() = nullptr);
     virtual void update(void (*updateCallback)() = nullptr);
     virtual void update(const char *searchName);
+    void update(SensorHandle handle);
     virtual bool isReady(void (*readyCallback)() = nullptr);
 
     void enable();
     void disable();
     bool isEnable() const;
 
-    void addModule(BaseSens *sensModule);
+    bool reserve(uint8_t count);
+    uint8_t getCapacity() const;
+
+    SensorHandle addModule(BaseSens *sensModule);
     void addName(const char *newName);
 
-    void addModule(const char *newName, BaseSens *sensModule);
-    void addModule(const char *newName, BaseSens *(*callbackSensModule)());
+    SensorHandle addModule(const char *newName, BaseSens *sensModule);
+    SensorHandle addModule(const char *newName, BaseSens *(*callbackSensModule)());
 
     void removeModule(uint8_t index);
 
     JsonVariant operator[](const char *searchName);
+    JsonVariant operator[](SensorHandle handle);
     JsonDocument operator()(const char *searchName);
 
+    SensorHandle getHandle(const char *searchName) const;
+    int getIndex(SensorHandle handle) const;
+    const SensorValue *getValueHandle(const char *searchName);
+    const SensorValue *getValueHandle(SensorHandle handle) const;
+    JsonDocument &toJson();
+
     BaseSens &getModule(uint8_t index);
     BaseSens * getModulePtr(uint8_t index) const;
+    /*an unknown name yields an inert module that never initializes or updates*/
+    [[deprecated("use getModuleByNamePtr(), it returns nullptr for an unknown name")]]
     BaseSens &getModuleByName(const char *searchName);
     BaseSens *getModuleByNamePtr(const char *searchName);
+    BaseSens *getModulePtr(SensorHandle handle) const;
 
     char * getName(uint8_t index) const;
     char **getNames();
@@ -101,6 +156,11 @@ public:
         return modulePtr;
     }
 
+    template<typename T>
+    T *getModule(SensorHandle handle) const {
+        return static_cast<T *>(getModulePtr(handle));
+    }
+
     virtual void debug(const char *searchName, bool showHeapMemory = false, bool endl = true);
     virtual void debug(bool showHeapMemory = false);
     virtual void debug(uint32_t time, bool showHeapMemory = false, void (*debugCallback)() = nullptr);
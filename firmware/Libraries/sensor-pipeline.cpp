@@ -0,0 +1,246 @@
+#include "sensor-pipeline.h"
+
+/*scales a MAD to the standard deviation of normally distributed noise*/
+static const float HAMPEL_MAD_SCALE = 1.4826f;
+
+void SensorPipeline::Window::reset() {
+    count = 0;
+    next = 0;
+}
+
+/*
+ * Replaces the oldest sample once the window is full. The sorted copy is
+ * updated in place: the oldest value is found and closed over, then the
+ * new one is shifted into its slot.
+ */
+void SensorPipeline::Window::push(float value) {
+    uint8_t used = count;
+    if (count == size) {
+        float oldest = samples[next];
+        uint8_t at = 0;
+        while (at < used - 1 && sorted[at] != oldest) at++;
+        for (uint8_t i = at; i + 1 < used; i++) sorted[i] = sorted[i + 1];
+        used--;
+    } else {
+        count++;
+    }
+
+    uint8_t at = used;
+    while (at > 0 && sorted[at - 1] > value) {
+        sorted[at] = sorted[at - 1];
+        at--;
+    }
+    sorted[at] = value;
+
+    samples[next] = value;
+    next = (next + 1) % size;
+}
+
+float SensorPipeline::Window::median() const {
+    if (count == 0) return 0.0f;
+    uint8_t half = count / 2;
+    if (count % 2 == 1) return sorted[half];
+    return (sorted[half - 1] + sorted[half]) * 0.5f;
+}
+
+/*
+ * Median of |sample - center|. Distances grow walking outwards from the
+ * center of the sorted window, so merging the two walks yields them in
+ * order and the median is reached after count / 2 steps.
+ */
+float SensorPipeline::Window::medianDeviation(float center) const {
+    if (count == 0) return 0.0f;
+    int right = 0;
+    while (right < count && sorted[right] < center) right++;
+    int left = right - 1;
+
+    uint8_t lowRank = (count - 1) / 2;
+    uint8_t highRank = count / 2;
+    float low = 0.0f;
+    for (uint8_t rank = 0; rank <= highRank; rank++) {
+        float deviation;
+        if (left < 0) {
+            deviation = sorted[right++] - center;
+        } else if (right >= count) {
+            deviation = center - sorted[left--];
+        } else if (center - sorted[left] <= sorted[right] - center) {
+            deviation = center - sorted[left--];
+        } else {
+            deviation = sorted[right++] - center;
+        }
+        if (rank == lowRank) low = deviation;
+        if (rank == highRank) return (low + deviation) * 0.5f;
+    }
+    return low;
+}
+
+SensorPipeline::SensorPipeline()
+        : stageCount(0),
+          hampelThreshold(3.0f),
+          emaAlpha(1.0f),
+          emaValue(0.0f),
+          emaPrimed(false),
+          stabilityWindow(0),
+          stabilityCount(0),
+          stabilityNext(0),
+          stabilityAnchor(0.0f),
+          stabilitySum(0.0f),
+          stabilitySquares(0.0f),
+          output(0.0f) {
+    medianWindow.size = 1;
+    hampelWindow.size = 1;
+    medianWindow.reset();
+    hampelWindow.reset();
+}
+
+/*windows past SENSOR_PIPELINE_MAX_WINDOW are clamped, a repeated stage is ignored*/
+SensorPipeline &SensorPipeline::median(uint8_t window) {
+    if (!addStage(STAGE_MEDIAN)) return *this;
+    medianWindow.size = constrain(window, 1, SENSOR_PIPELINE_MAX_WINDOW);
+    medianWindow.reset();
+    return *this;
+}
+
+SensorPipeline &SensorPipeline::hampel(uint8_t window, float threshold) {
+    if (!addStage(STAGE_HAMPEL)) return *this;
+    hampelWindow.size = constrain(window, 1, SENSOR_PIPELINE_MAX_WINDOW);
+    hampelWindow.reset();
+    hampelThreshold = threshold;
+    return *this;
+}
+
+SensorPipeline &SensorPipeline::ema(float alpha) {
+    if (!addStage(STAGE_EMA)) return *this;
+    emaAlpha = constrain(alpha, 0.0f, 1.0f);
+    emaPrimed = false;
+    return *this;
+}
+
+SensorPipeline &SensorPipeline::stability(uint8_t window) {
+    if (!addStage(STAGE_STABILITY)) return *this;
+    stabilityWindow = constrain(window, 1, SENSOR_PIPELINE_MAX_STABILITY);
+    stabilityCount = 0;
+    stabilityNext = 0;
+    return *this;
+}
+
+void SensorPipeline::clear() {
+    stageCount = 0;
+    stabilityWindow = 0;
+    reset();
+}
+
+/*forgets every reading but keeps the declared chain*/
+void SensorPipeline::reset() {
+    medianWindow.reset();
+    hampelWindow.reset();
+    emaPrimed = false;
+    stabilityCount = 0;
+    stabilityNext = 0;
+    output = 0.0f;
+}
+
+float SensorPipeline::apply(float value) {
+    for (uint8_t i = 0; i < stageCount; i++) {
+        switch (stages[i]) {
+            case STAGE_MEDIAN:
+                medianWindow.push(value);
+                value = medianWindow.median();
+                break;
+            case STAGE_HAMPEL: {
+                hampelWindow.push(value);
+                float center = hampelWindow.median();
+                float spread = HAMPEL_MAD_SCALE * hampelWindow.medianDeviation(center);
+                if (hampelWindow.count >= 3 && abs(value - center) > hampelThreshold * spread) value = center;
+                break;
+            }
+            case STAGE_EMA:
+                if (!emaPrimed) {
+                    emaValue = value;
+                    emaPrimed = true;
+                } else {
+                    emaValue += emaAlpha * (value - emaValue);
+                }
+                value = emaValue;
+                break;
+            case STAGE_STABILITY:
+                pushStability(value);
+                break;
+        }
+    }
+    output = value;
+    return output;
+}
+
+bool SensorPipeline::isEmpty() const {
+    return stageCount == 0;
+}
+
+bool SensorPipeline::tracksStability() const {
+    return hasStage(STAGE_STABILITY);
+}
+
+/*true once the stability stage has seen a full window of readings*/
+bool SensorPipeline::isSettled() const {
+    return stabilityWindow > 0 && stabilityCount >= stabilityWindow;
+}
+
+/*standard deviation of the readings in the stability window*/
+float SensorPipeline::getDeviation() const {
+    if (stabilityCount == 0) return 0.0f;
+    float mean = stabilitySum / stabilityCount;
+    float variance = stabilitySquares / stabilityCount - mean * mean;
+    return variance > 0.0f ? sqrtf(variance) : 0.0f;
+}
+
+float SensorPipeline::getValue() const {
+    return output;
+}
+
+/*
+ * Sums are kept relative to an anchor near the readings, so squaring a
+ * 20 kg load does not swamp a few grams of spread.
+ */
+void SensorPipeline::pushStability(float value) {
+    if (stabilityCount == 0) {
+        stabilityAnchor = value;
+        stabilitySum = 0.0f;
+        stabilitySquares = 0.0f;
+    }
+    if (stabilityCount == stabilityWindow) {
+        float oldest = stabilitySamples[stabilityNext] - stabilityAnchor;
+        stabilitySum -= oldest;
+        stabilitySquares -= oldest * oldest;
+    } else {
+        stabilityCount++;
+    }
+
+    float delta = value - stabilityAnchor;
+    stabilitySum += delta;
+    stabilitySquares += delta * delta;
+    stabilitySamples[stabilityNext] = value;
+    stabilityNext = (stabilityNext + 1) % stabilityWindow;
+
+    if (stabilityNext != 0) return;
+    stabilityAnchor += stabilitySum / stabilityCount;
+    stabilitySum = 0.0f;
+    stabilitySquares = 0.0f;
+    for (uint8_t i = 0; i < stabilityCount; i++) {
+        delta = stabilitySamples[i] - stabilityAnchor;
+        stabilitySum += delta;
+        stabilitySquares += delta * delta;
+    }
+}
+
+bool SensorPipeline::addStage(Stage stage) {
+    if (stageCount >= SENSOR_PIPELINE_MAX_STAGES || hasStage(stage)) return false;
+    stages[stageCount++] = stage;
+    return true;
+}
+
+bool SensorPipeline::hasStage(Stage stage) const {
+    for (uint8_t i = 0; i < stageCount; i++) {
+        if (stages[i] == stage) return true;
+    }
+    return false;
+}
@@ -0,0 +1,109 @@
+/*
+ *  sensor-pipeline.h
+ *
+ *  streaming filter chain for sensor readings
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#pragma message("[COMPILED]: sensor-pipeline.h")
+
+#include "Arduino.h"
+
+/*largest median or Hampel window, the per-sample work is bounded by it*/
+const uint8_t SENSOR_PIPELINE_MAX_WINDOW = 15;
+const uint8_t SENSOR_PIPELINE_MAX_STABILITY = 64;
+const uint8_t SENSOR_PIPELINE_MAX_STAGES = 4;
+
+/*
+ * Chain of filter stages declared once and run on every reading, all in
+ * fixed storage. Stages run in the order they were added, each at most
+ * once:
+ *
+ *   median(n)         median of the last n readings
+ *   hampel(n, k)      a reading further than k scaled MADs from the median
+ *                     of the last n is replaced by that median
+ *   ema(alpha)        exponential smoothing
+ *   stability(n)      passes readings through and keeps the variance of
+ *                     the last n of them
+ *
+ * The median and Hampel windows keep their samples sorted, so a reading
+ * costs one shift of at most SENSOR_PIPELINE_MAX_WINDOW floats instead of
+ * a full rescan. The variance comes from running sums, re-based on their
+ * mean once per window so float error does not build up.
+ *
+ * Declare the chain once, before the first reading goes through it:
+ * adding a stage later starts it on an empty window while the stages
+ * before it are already warm.
+ */
+class SensorPipeline {
+private:
+    enum Stage : uint8_t {
+        STAGE_MEDIAN,
+        STAGE_HAMPEL,
+        STAGE_EMA,
+        STAGE_STABILITY
+    };
+
+    struct Window {
+        float samples[SENSOR_PIPELINE_MAX_WINDOW];
+        float sorted[SENSOR_PIPELINE_MAX_WINDOW];
+        uint8_t size;
+        uint8_t count;
+        uint8_t next;
+
+        void reset();
+        void push(float value);
+        float median() const;
+        float medianDeviation(float center) const;
+    };
+
+    Stage stages[SENSOR_PIPELINE_MAX_STAGES];
+    uint8_t stageCount;
+
+    Window medianWindow;
+    Window hampelWindow;
+    float hampelThreshold;
+
+    float emaAlpha;
+    float emaValue;
+    bool emaPrimed;
+
+    float stabilitySamples[SENSOR_PIPELINE_MAX_STABILITY];
+    uint8_t stabilityWindow;
+    uint8_t stabilityCount;
+    uint8_t stabilityNext;
+    float stabilityAnchor;
+    float stabilitySum;
+    float stabilitySquares;
+
+    float output;
+
+    void pushStability(float value);
+    bool addStage(Stage stage);
+    bool hasStage(Stage stage) const;
+
+public:
+    SensorPipeline();
+
+    SensorPipeline &median(uint8_t window);
+    SensorPipeline &hampel(uint8_t window, float threshold = 3.0f);
+    SensorPipeline &ema(float alpha);
+    SensorPipeline &stability(uint8_t window);
+
+    void clear();
+    void reset();
+    float apply(float value);
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] bool tracksStability() const;
+    [[nodiscard]] bool isSettled() const;
+    [[nodiscard]] float getDeviation() const;
+    [[nodiscard]] float getValue() const;
+};
+
+#endif
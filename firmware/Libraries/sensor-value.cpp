@@ -0,0 +1,159 @@
+/*
+ *  sensor-value.cpp
+ *
+ *  typed sensor value slot c
+ *  Created on: 2026. 10. 17
+ */
+
+#include "sensor-value.h"
+
+SensorValue::SensorValue()
+        : sequence(0),
+          type(SENSOR_VALUE_NONE),
+          integer(0) {
+    text[0] = '\0';
+}
+
+void SensorValue::beginWrite() {
+    uint32_t current = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&sequence, current + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void SensorValue::endWrite() {
+    uint32_t current = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&sequence, current + 1, __ATOMIC_RELEASE);
+}
+
+/*waits out a write in progress, which is at most one driver store*/
+uint32_t SensorValue::beginRead() const {
+    uint32_t started;
+    do {
+        started = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+    } while (started & 1);
+    return started;
+}
+
+bool SensorValue::endRead(uint32_t started) const {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&sequence, __ATOMIC_RELAXED) == started;
+}
+
+void SensorValue::set(float value) {
+    beginWrite();
+    type = SENSOR_VALUE_FLOAT;
+    number = value;
+    endWrite();
+}
+
+void SensorValue::set(int32_t value) {
+    beginWrite();
+    type = SENSOR_VALUE_INT;
+    integer = value;
+    endWrite();
+}
+
+void SensorValue::set(const char *value) {
+    beginWrite();
+    type = SENSOR_VALUE_TEXT;
+    strncpy(text, (value != nullptr) ? value : "", SENSOR_VALUE_TEXT_CHAR - 1);
+    text[SENSOR_VALUE_TEXT_CHAR - 1] = '\0';
+    endWrite();
+}
+
+void SensorValue::clear() {
+    beginWrite();
+    type = SENSOR_VALUE_NONE;
+    integer = 0;
+    text[0] = '\0';
+    endWrite();
+}
+
+SensorValueType SensorValue::getType() const {
+    SensorValueType current;
+    uint32_t started;
+    do {
+        started = beginRead();
+        current = type;
+    } while (!endRead(started));
+    return current;
+}
+
+/*even number that changes on every write, for cheap "is there a new reading" checks*/
+uint32_t SensorValue::getVersion() const {
+    return beginRead();
+}
+
+float SensorValue::getFloat() const {
+    float result;
+    uint32_t started;
+    do {
+        started = beginRead();
+        if (type == SENSOR_VALUE_FLOAT) result = number;
+        else if (type == SENSOR_VALUE_INT) result = (float) integer;
+        else result = 0.0f;
+    } while (!endRead(started));
+    return result;
+}
+
+int32_t SensorValue::getInt() const {
+    int32_t result;
+    uint32_t started;
+    do {
+        started = beginRead();
+        if (type == SENSOR_VALUE_INT) result = integer;
+        else if (type == SENSOR_VALUE_FLOAT) result = (int32_t) number;
+        else result = 0;
+    } while (!endRead(started));
+    return result;
+}
+
+/*copies the text value, or "" for numbers; returns its length*/
+size_t SensorValue::getText(char *buffer, size_t size) const {
+    if (buffer == nullptr || size == 0) return 0;
+    size_t length;
+    uint32_t started;
+    do {
+        started = beginRead();
+        length = 0;
+        if (type == SENSOR_VALUE_TEXT) {
+            while (length < size - 1 && text[length] != '\0') {
+                buffer[length] = text[length];
+                length++;
+            }
+        }
+        buffer[length] = '\0';
+    } while (!endRead(started));
+    return length;
+}
+
+/*the JSON view, built only when debug or upload code asks for it*/
+void SensorValue::toJson(JsonDocument &doc, const char *key) const {
+    SensorValueType current;
+    float currentNumber = 0.0f;
+    int32_t currentInteger = 0;
+    char buffer[SENSOR_VALUE_TEXT_CHAR];
+    uint32_t started;
+    do {
+        started = beginRead();
+        current = type;
+        if (current == SENSOR_VALUE_FLOAT) currentNumber = number;
+        else if (current == SENSOR_VALUE_INT) currentInteger = integer;
+        else if (current == SENSOR_VALUE_TEXT) memcpy(buffer, text, SENSOR_VALUE_TEXT_CHAR);
+    } while (!endRead(started));
+
+    switch (current) {
+        case SENSOR_VALUE_FLOAT:
+            doc[key] = currentNumber;
+            break;
+        case SENSOR_VALUE_INT:
+            doc[key] = currentInteger;
+            break;
+        case SENSOR_VALUE_TEXT:
+            doc[key] = buffer;
+            break;
+        default:
+            doc[key] = 0;
+            break;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  sensor-value.h
+ *
+ *  typed sensor value slot
+ *  Created on: 2026. 10. 17
+ */
+
+#pragma once
+
+#ifndef SENSOR_VALUE_H
+#define SENSOR_VALUE_H
+
+#pragma message("[COMPILED]: sensor-value.h")
+
+#include "Arduino.h"
+#include "ArduinoJson.h"
+
+/*an RFID uid of up to 10 bytes in hex plus the terminator*/
+const int SENSOR_VALUE_TEXT_CHAR = 24;
+
+enum SensorValueType : uint8_t {
+    SENSOR_VALUE_NONE,
+    SENSOR_VALUE_FLOAT,
+    SENSOR_VALUE_INT,
+    SENSOR_VALUE_TEXT
+};
+
+/*
+ * One reading, written by a single driver and read from anywhere without
+ * a lock. The writer bumps the sequence to odd, stores, then bumps it to
+ * even; a reader retries while the sequence is odd or moved under it.
+ * Readers never block the writer, and a torn text is never returned.
+ */
+class SensorValue {
+private:
+    uint32_t sequence;
+    SensorValueType type;
+    union {
+        float number;
+        int32_t integer;
+    };
+    char text[SENSOR_VALUE_TEXT_CHAR];
+
+    void beginWrite();
+    void endWrite();
+    uint32_t beginRead() const;
+    bool endRead(uint32_t started) const;
+
+public:
+    SensorValue();
+
+    void set(float value);
+    void set(int32_t value);
+    void set(const char *value);
+    void clear();
+
+    SensorValueType getType() const;
+    uint32_t getVersion() const;
+    float getFloat() const;
+    int32_t getInt() const;
+    size_t getText(char *buffer, size_t size) const;
+
+    void toJson(JsonDocument &doc, const char *key) const;
+};
+
+#endif  // SENSOR_VALUE_H
@@ -11,6 +11,14 @@ UltrasonicSens::UltrasonicSens(uint8_t trigger_pin, uint8_t echo_pin,
         : NewPing(trigger_pin, echo_pin, max_distance),
           name(""),
           sensorTimer(0),
+          triggerPin(trigger_pin),
+          echoPin(echo_pin),
+          maxDistanceCm(max_distance),
+          echoCaptureEnabled(false),
+          echoTriggered(false),
+          echoRiseUs(0),
+          echoWidthUs(0),
+          echoDone(false),
           stabilityTolerance(_stabilityTolerance),
           sampleCount(_sampleCount),
           stabilityTime(_stabilityTime),
@@ -27,6 +35,7 @@ UltrasonicSens::UltrasonicSens(uint8_t trigger_pin, uint8_t echo_pin,
 }
 
 UltrasonicSens::~UltrasonicSens() {
+    endEchoCapture();
     if (lastDistances != nullptr) {
         delete[] lastDistances;
         lastDistances = nullptr;
@@ -38,22 +47,54 @@ bool UltrasonicSens::init() {
         name = "UltrasonicSens";
         doc = new JsonDocument;
     }
-    (*doc)[name] = 0;
+    if (sensorValue == nullptr) sensorValue = &fallbackValue;
+    sensorValue->set(0.0f);
     return true;
 }
 
 bool UltrasonicSens::update() {
-    if (millis() - sensorTimer >= 50) {
-        float distance = this->ping_cm();
+    if (millis() - sensorTimer < 50) return false;
 
+    if (echoCaptureEnabled) {
+        /*the echo of the previous trigger has had the whole interval to come back*/
+        bool measured = echoTriggered;
+        float distance = 0;
+        if (__atomic_load_n(&echoDone, __ATOMIC_ACQUIRE)) {
+            uint32_t width = echoWidthUs;
+            if (width <= (uint32_t) maxDistanceCm * US_ROUNDTRIP_CM) distance = (float) (width / US_ROUNDTRIP_CM);
+        }
+        fireTrigger();
+        sensorTimer = millis();
+        if (!measured) return false;
+        processDistance(distance);
+        return true;
+    }
+
+    processDistance(this->ping_cm());
+    sensorTimer = millis();
+    return true;
+}
+
+/*
+ * Takes one distance in cm, 0 meaning the echo never came back, in which
+ * case the previous distance is held rather than fed to the filters. The
+ * lock releases as soon as the distance moves more than resetThreshold
+ * from the locked one, in either direction.
+ */
+void UltrasonicSens::processDistance(float distance) {
+    bool isStable = true;
+    if (distancePipeline.tracksStability()) {
+        distance = distance == 0 ? distancePipeline.getValue() : distancePipeline.apply(distance);
+        isStable = distancePipeline.isSettled() && distancePipeline.getDeviation() <= stabilityTolerance;
+    } else {
         if (distance == 0) {
             distance = lastDistances[distanceIndex > 0 ? distanceIndex - 1 : sampleCount - 1];
         }
+        if (!distancePipeline.isEmpty()) distance = distancePipeline.apply(distance);
 
         lastDistances[distanceIndex] = distance;
         distanceIndex = (distanceIndex + 1) % sampleCount;
 
-        bool isStable = true;
         float firstDistance = lastDistances[0];
         for (uint8_t i = 1; i < sampleCount; i++) {
             if (abs(lastDistances[i] - firstDistance) > stabilityTolerance) {
@@ -61,32 +102,95 @@ bool UltrasonicSens::update() {
                 break;
             }
         }
+    }
 
-        if (isLocked && abs(distance - lockedDistance) > resetThreshold) {
-            isLocked = false;
-            lockedDistance = 0.0;
-            stabilityTimer = 0;
-        }
-        else if (isStable && !isLocked) {
-            if (stabilityTimer == 0) {
-                stabilityTimer = millis();
-            } else if (millis() - stabilityTimer > stabilityTime) {
-                isLocked = true;
-                lockedDistance = distance;
-            }
-        }
-        else if (!isStable) {
-            stabilityTimer = 0;
+    if (isLocked && abs(distance - lockedDistance) > resetThreshold) {
+        isLocked = false;
+        lockedDistance = 0.0;
+        stabilityTimer = 0;
+    }
+    else if (isStable && !isLocked) {
+        if (stabilityTimer == 0) {
+            stabilityTimer = millis();
+        } else if (millis() - stabilityTimer > stabilityTime) {
+            isLocked = true;
+            lockedDistance = distance;
         }
+    }
+    else if (!isStable) {
+        stabilityTimer = 0;
+    }
 
-        float finalDistance = isLocked ? lockedDistance : distance;
+    sensorValue->set(distance);
+}
 
-        (*doc)[name] = distance;
-        sensorTimer = millis();
-        return true;
+/*
+ * Measures without waiting on the echo. update() only pulses the trigger
+ * and returns; on ESP32 an interrupt on both edges of the echo pin
+ * timestamps the pulse, and the next update() turns its width into the
+ * distance, one interval behind the trigger. Other builds have no
+ * interrupt: the caller reports the edges through echoEdge().
+ */
+bool UltrasonicSens::beginEchoCapture() {
+    if (echoCaptureEnabled) return true;
+    echoTriggered = false;
+    __atomic_store_n(&echoDone, false, __ATOMIC_RELAXED);
+    pinMode(triggerPin, OUTPUT);
+    pinMode(echoPin, INPUT);
+#if defined(ESP32)
+    attachInterruptArg(digitalPinToInterrupt(echoPin), echoISR, this, CHANGE);
+#endif
+    echoCaptureEnabled = true;
+    return true;
+}
+
+void UltrasonicSens::endEchoCapture() {
+    if (!echoCaptureEnabled) return;
+#if defined(ESP32)
+    detachInterrupt(digitalPinToInterrupt(echoPin));
+#endif
+    echoCaptureEnabled = false;
+}
+
+bool UltrasonicSens::isCapturingEcho() const {
+    return echoCaptureEnabled;
+}
+
+/*
+ * One edge of the echo pulse, with the micros() it happened at. A falling
+ * edge completes the measurement for the next update().
+ */
+void UltrasonicSens::echoEdge(bool high, uint32_t timeUs) {
+    if (high) {
+        echoRiseUs = timeUs;
+        return;
     }
-    return false;
+    echoWidthUs = timeUs - echoRiseUs;
+    __atomic_store_n(&echoDone, true, __ATOMIC_RELEASE);
+}
+
+/*stages see centimetres, missed echoes never reach them*/
+SensorPipeline &UltrasonicSens::pipeline() {
+    return distancePipeline;
+}
+
+/*the 10 us trigger pulse is the only time update() spends on the pins*/
+void UltrasonicSens::fireTrigger() {
+    __atomic_store_n(&echoDone, false, __ATOMIC_RELAXED);
+    digitalWrite(triggerPin, LOW);
+    delayMicroseconds(4);
+    digitalWrite(triggerPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(triggerPin, LOW);
+    echoTriggered = true;
+}
+
+#if defined(ESP32)
+void IRAM_ATTR UltrasonicSens::echoISR(void *arg) {
+    UltrasonicSens *sensor = (UltrasonicSens *) arg;
+    sensor->echoEdge(digitalRead(sensor->echoPin) == HIGH, micros());
 }
+#endif
 
 void UltrasonicSens::setDocument(const char *objName) {
     name = objName;
@@ -97,15 +201,17 @@ void UltrasonicSens::setDocumentValue(JsonDocument *docBase) {
 }
 
 JsonDocument UltrasonicSens::getDocument() {
+    sensorValue->toJson(*doc, name);
     return (*doc);
 }
 
 JsonVariant UltrasonicSens::getVariant(const char *searchName) {
+    sensorValue->toJson(*doc, name);
     return (*doc)[searchName];
 }
 
 float UltrasonicSens::getValueCm() const {
-    return (*doc)[name].as<float>();
+    return sensorValue->getFloat();
 }
 
 float UltrasonicSens::getValueIn() {
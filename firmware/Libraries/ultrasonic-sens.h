@@ -13,21 +13,40 @@ class UltrasonicSens : public BaseSens, public NewPing {
 private:
     JsonDocument *doc;
     const char *name;
+    /*distance slot used until a registry slot is attached*/
+    SensorValue fallbackValue;
 
     uint8_t sensorPin;
     uint32_t sensorTimer;
 
+    uint8_t triggerPin;
+    uint8_t echoPin;
+    unsigned int maxDistanceCm;
+    bool echoCaptureEnabled;
+    bool echoTriggered;
+    volatile uint32_t echoRiseUs;
+    volatile uint32_t echoWidthUs;
+    bool echoDone;
+
     float stabilityTolerance;
     uint8_t sampleCount;
     uint32_t stabilityTime;
     float resetThreshold;
 
+    SensorPipeline distancePipeline;
     float *lastDistances;
     uint8_t distanceIndex;
     bool isLocked;
     float lockedDistance;
     uint32_t stabilityTimer;
 
+#if defined(ESP32)
+    static void echoISR(void *arg);
+#endif
+
+    void fireTrigger();
+    void processDistance(float distance);
+
     using NewPing::NewPing;
 
 public:
@@ -46,6 +65,12 @@ public:
     JsonDocument getDocument() override;
     JsonVariant getVariant(const char *searchName) override;
 
+    bool beginEchoCapture();
+    void endEchoCapture();
+    [[nodiscard]] bool isCapturingEcho() const;
+    void echoEdge(bool high, uint32_t timeUs);
+    SensorPipeline &pipeline();
+
     float getValueCm() const;
     float getValueIn();
     void setPins(uint8_t _trigPin, uint8_t _echoPin);
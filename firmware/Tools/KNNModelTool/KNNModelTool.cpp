@@ -0,0 +1,458 @@
+/*
+ *  KNNModelTool.cpp
+ *
+ *  Host-side tool that prepares KNN models off-device: turns
+ *  firmware/dataset.csv into a flash model header or a KNN::loadModel()
+ *  file, and checks model files pulled off a device.
+ *
+ *  Build (from this directory):
+ *    g++ -O2 -std=c++17 -I../../Benchmark/host -I../../Libraries KNNModelTool.cpp -o knn-model-tool
+ *
+ *  Usage:
+ *    knn-model-tool header <dataset.csv|model.knn> <output.h> <NAME> [--column-major] [--weights=w1,w2,...]
+ *    knn-model-tool binary <dataset.csv> <output.knn> [--column-major] [--k=N] [--metric=euclidean|manhattan|cosine]
+ *                          [--weights=w1,w2,...]
+ *    knn-model-tool info <model.knn>
+ *
+ *  Regenerate the firmware model after editing the dataset:
+ *    knn-model-tool header ../../dataset.csv ../../IntanFirmwareR1/NutritionModel.h NUTRITION_MODEL
+ */
+
+#include "bench-common.h"
+#include "KNN.h"
+#include "KNNModelFormat.h"
+
+static const int MAX_ROWS = 4096;
+static const int MAX_FEATURES = 32;
+
+/*float32 model kept row-major in memory, the layout only applies when writing*/
+struct ModelTable {
+    int featureCount;
+    int dataCount;
+    int classCount;
+    int k;
+    DistanceMetric metric;
+    bool weightedVoting;
+    bool normalization;
+    KNNStorageLayout layout;
+    float features[MAX_ROWS][MAX_FEATURES];
+    uint8_t classes[MAX_ROWS];
+    char labels[KNN_MAX_CLASSES][KNN_MAX_LABEL_CHAR];
+    float featureMin[MAX_FEATURES];
+    float featureMax[MAX_FEATURES];
+    float featureWeight[MAX_FEATURES];
+};
+
+static void calculateRanges(ModelTable &table) {
+    for (int i = 0; i < table.dataCount; i++) {
+        for (int j = 0; j < table.featureCount; j++) {
+            float value = table.features[i][j];
+            if (i == 0 || value < table.featureMin[j]) table.featureMin[j] = value;
+            if (i == 0 || value > table.featureMax[j]) table.featureMax[j] = value;
+        }
+    }
+}
+
+/*class ids follow first appearance, the same ids KNN::addTrainingData() interns*/
+static bool loadDataset(const char *path, ModelTable &table) {
+    static float rows[MAX_ROWS][NUTRITION_FEATURES];
+    static const char *rowLabels[MAX_ROWS];
+
+    table.featureCount = NUTRITION_FEATURES;
+    table.classCount = 0;
+    table.dataCount = loadNutritionDataset(path, rows, rowLabels, MAX_ROWS);
+    if (table.dataCount == 0) return false;
+
+    for (int i = 0; i < table.dataCount; i++) {
+        int classId = -1;
+        for (int c = 0; c < table.classCount; c++) {
+            if (strcmp(table.labels[c], rowLabels[i]) == 0) classId = c;
+        }
+        if (classId < 0) {
+            if (table.classCount >= KNN_MAX_CLASSES) return false;
+            classId = table.classCount++;
+            memset(table.labels[classId], 0, KNN_MAX_LABEL_CHAR);
+            strncpy(table.labels[classId], rowLabels[i], KNN_MAX_LABEL_CHAR - 1);
+        }
+        table.classes[i] = (uint8_t) classId;
+
+        for (int j = 0; j < NUTRITION_FEATURES; j++) {
+            table.features[i][j] = rows[i][j];
+        }
+    }
+
+    calculateRanges(table);
+    for (int j = 0; j < table.featureCount; j++) {
+        table.featureWeight[j] = 1.0f;
+    }
+    return true;
+}
+
+static bool readBlock(FILE *file, uint32_t offset, void *data, size_t size) {
+    return fseek(file, offset, SEEK_SET) == 0 && fread(data, 1, size, file) == size;
+}
+
+/*reads and verifies a KNN::saveModel() file, features are only unpacked for float32 stores*/
+static const char *loadModelFile(const char *path, KNNModelHeader &header, ModelTable &table) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) return "cannot open file";
+
+    const char *failure = nullptr;
+    static uint8_t store[MAX_ROWS * MAX_FEATURES * sizeof(float)];
+
+    if (fread(&header, 1, sizeof(header), file) != sizeof(header) || header.magic != KNN_MODEL_MAGIC) {
+        failure = "not a KNN model file";
+    } else if (header.endianTag != KNN_MODEL_ENDIAN_TAG) {
+        failure = "byte order mismatch";
+    } else if (header.version > KNN_MODEL_VERSION || header.headerSize < sizeof(header)) {
+        failure = "unsupported version";
+    } else if (header.featureCount > MAX_FEATURES || header.dataCount > MAX_ROWS ||
+               header.classCount > KNN_MAX_CLASSES) {
+        failure = "model too large for this tool";
+    }
+
+    size_t elementSize = (header.precision == PRECISION_INT8) ? 1 : (header.precision == PRECISION_INT16) ? 2 : 4;
+    size_t storeBytes = (size_t) header.dataCount * header.featureCount * elementSize;
+    size_t rangeBytes = header.featureCount * sizeof(float);
+
+    for (int j = 0; j < MAX_FEATURES; j++) {
+        table.featureWeight[j] = 1.0f;
+    }
+
+    /*version 1 files have no weight block*/
+    if (failure == nullptr &&
+        !(readBlock(file, header.labelOffset, table.labels, (size_t) header.classCount * KNN_MAX_LABEL_CHAR) &&
+          readBlock(file, header.rangeOffset, table.featureMin, rangeBytes) &&
+          fread(table.featureMax, 1, rangeBytes, file) == rangeBytes &&
+          (header.weightOffset == 0 || readBlock(file, header.weightOffset, table.featureWeight, rangeBytes)) &&
+          readBlock(file, header.classOffset, table.classes, header.dataCount) &&
+          readBlock(file, header.featureOffset, store, storeBytes))) {
+        failure = "file truncated";
+    }
+    fclose(file);
+    if (failure != nullptr) return failure;
+
+    KNNModelHeader unsealed = header;
+    unsealed.crc = 0;
+    uint32_t crc = knnModelCrc32(0, &unsealed, sizeof(unsealed));
+    crc = knnModelCrc32(crc, table.labels, (size_t) header.classCount * KNN_MAX_LABEL_CHAR);
+    crc = knnModelCrc32(crc, table.featureMin, header.featureCount * sizeof(float));
+    crc = knnModelCrc32(crc, table.featureMax, rangeBytes);
+    if (header.weightOffset != 0) crc = knnModelCrc32(crc, table.featureWeight, rangeBytes);
+    crc = knnModelCrc32(crc, table.classes, header.dataCount);
+    crc = knnModelCrc32(crc, store, storeBytes);
+    if (crc != header.crc) return "checksum mismatch";
+
+    table.featureCount = header.featureCount;
+    table.dataCount = header.dataCount;
+    table.classCount = header.classCount;
+    table.k = header.k;
+    table.metric = (DistanceMetric) header.metric;
+    table.weightedVoting = header.weightedVoting != 0;
+    table.normalization = header.normalization != 0;
+    table.layout = (KNNStorageLayout) header.layout;
+
+    if (header.precision == PRECISION_FLOAT32) {
+        const float *values = (const float *) store;
+        for (int i = 0; i < table.dataCount; i++) {
+            for (int j = 0; j < table.featureCount; j++) {
+                table.features[i][j] = (table.layout == COLUMN_MAJOR) ? values[j * table.dataCount + i]
+                                                                      : values[i * table.featureCount + j];
+            }
+        }
+    }
+    return nullptr;
+}
+
+/*writes the same bytes KNN::saveModel() would for a float32 store*/
+static bool writeModelFile(const ModelTable &table, const char *path) {
+    static float store[MAX_ROWS * MAX_FEATURES];
+    for (int i = 0; i < table.dataCount; i++) {
+        for (int j = 0; j < table.featureCount; j++) {
+            if (table.layout == COLUMN_MAJOR) {
+                store[j * table.dataCount + i] = table.features[i][j];
+            } else {
+                store[i * table.featureCount + j] = table.features[i][j];
+            }
+        }
+    }
+    size_t storeBytes = (size_t) table.dataCount * table.featureCount * sizeof(float);
+
+    KNNModelHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = KNN_MODEL_MAGIC;
+    header.version = KNN_MODEL_VERSION;
+    header.headerSize = sizeof(KNNModelHeader);
+    header.endianTag = KNN_MODEL_ENDIAN_TAG;
+    header.featureCount = table.featureCount;
+    header.classCount = table.classCount;
+    header.dataCount = table.dataCount;
+    header.k = table.k;
+    header.metric = table.metric;
+    header.layout = table.layout;
+    header.precision = PRECISION_FLOAT32;
+    header.weightedVoting = table.weightedVoting;
+    header.normalization = table.normalization;
+    knnModelLayoutBlocks(header, KNN_MAX_LABEL_CHAR, sizeof(float));
+
+    uint32_t crc = knnModelCrc32(0, &header, sizeof(header));
+    crc = knnModelCrc32(crc, table.labels, (size_t) table.classCount * KNN_MAX_LABEL_CHAR);
+    crc = knnModelCrc32(crc, table.featureMin, table.featureCount * sizeof(float));
+    crc = knnModelCrc32(crc, table.featureMax, table.featureCount * sizeof(float));
+    crc = knnModelCrc32(crc, table.featureWeight, table.featureCount * sizeof(float));
+    crc = knnModelCrc32(crc, table.classes, table.dataCount);
+    crc = knnModelCrc32(crc, store, storeBytes);
+    header.crc = crc;
+
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr) return false;
+
+    static const uint8_t padding[KNN_MODEL_BLOCK_ALIGNMENT] = {0};
+    size_t written = fwrite(&header, 1, sizeof(header), file);
+    written += fwrite(table.labels, 1, (size_t) table.classCount * KNN_MAX_LABEL_CHAR, file);
+    written += fwrite(padding, 1, header.rangeOffset - written, file);
+    written += fwrite(table.featureMin, 1, table.featureCount * sizeof(float), file);
+    written += fwrite(table.featureMax, 1, table.featureCount * sizeof(float), file);
+    written += fwrite(table.featureWeight, 1, table.featureCount * sizeof(float), file);
+    written += fwrite(table.classes, 1, table.dataCount, file);
+    written += fwrite(padding, 1, header.featureOffset - written, file);
+    written += fwrite(store, 1, storeBytes, file);
+    fclose(file);
+
+    return written == header.fileSize;
+}
+
+/*mirrors KNN::prepareFastSearch() and KNN::storePreparedRow()*/
+static float preparedValue(const ModelTable &table, int row, int feature) {
+    float range = table.featureMax[feature] - table.featureMin[feature];
+    float scale = (range < 0.0001f) ? 0.0f : 1.0f / range;
+    if (scale == 0.0f) return 0.5f;
+    return (table.features[row][feature] - table.featureMin[feature]) * scale;
+}
+
+static void writeFloat(FILE *file, float value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", value);
+    fputs(text, file);
+    if (strpbrk(text, ".eEn") == nullptr) fputs(".0", file);
+    fputc('f', file);
+}
+
+static void writeFeatureBlock(FILE *file, const ModelTable &table, const char *name, const char *suffix,
+                              bool prepared) {
+    fprintf(file, "alignas(KNN_STORE_ALIGNMENT) const float %s_%s[%d * %d] PROGMEM = {\n",
+            name, suffix, table.dataCount, table.featureCount);
+
+    int outer = (table.layout == COLUMN_MAJOR) ? table.featureCount : table.dataCount;
+    int inner = (table.layout == COLUMN_MAJOR) ? table.dataCount : table.featureCount;
+
+    for (int o = 0; o < outer; o++) {
+        fputs("        ", file);
+        for (int i = 0; i < inner; i++) {
+            int row = (table.layout == COLUMN_MAJOR) ? i : o;
+            int feature = (table.layout == COLUMN_MAJOR) ? o : i;
+            writeFloat(file, prepared ? preparedValue(table, row, feature) : table.features[row][feature]);
+            fputs((i + 1 < inner) ? ", " : ",\n", file);
+        }
+    }
+    fputs("};\n\n", file);
+}
+
+static bool writeHeader(const ModelTable &table, const char *sourcePath, const char *outputPath, const char *name) {
+    FILE *file = fopen(outputPath, "w");
+    if (file == nullptr) return false;
+
+    const char *fileName = strrchr(outputPath, '/');
+    fileName = (fileName != nullptr) ? fileName + 1 : outputPath;
+    const char *sourceName = strrchr(sourcePath, '/');
+    sourceName = (sourceName != nullptr) ? sourceName + 1 : sourcePath;
+
+    fprintf(file, "/*\n *  %s\n *\n", fileName);
+    fprintf(file, " *  KNN model generated by KNNModelTool from %s, do not edit\n", sourceName);
+    fprintf(file, " *  %d rows, %d features, %d classes\n */\n\n", table.dataCount, table.featureCount,
+            table.classCount);
+    fprintf(file, "#pragma once\n\n#ifndef %s_H\n#define %s_H\n\n", name, name);
+    fprintf(file, "#include \"KNN.h\"\n\n");
+
+    writeFeatureBlock(file, table, name, "FEATURES", false);
+    writeFeatureBlock(file, table, name, "PREPARED", true);
+
+    fprintf(file, "const uint8_t %s_CLASSES[%d] PROGMEM = {\n", name, table.dataCount);
+    for (int i = 0; i < table.dataCount; i++) {
+        if (i % 20 == 0) fputs("        ", file);
+        fprintf(file, "%d", table.classes[i]);
+        fputs((i + 1 == table.dataCount || i % 20 == 19) ? ",\n" : ", ", file);
+    }
+    fputs("};\n\n", file);
+
+    fprintf(file, "const char %s_LABELS[%d][KNN_MAX_LABEL_CHAR] PROGMEM = {\n", name, table.classCount);
+    for (int c = 0; c < table.classCount; c++) {
+        fprintf(file, "        \"%s\",\n", table.labels[c]);
+    }
+    fputs("};\n\n", file);
+
+    fprintf(file, "const float %s_MIN[%d] PROGMEM = {", name, table.featureCount);
+    for (int j = 0; j < table.featureCount; j++) {
+        writeFloat(file, table.featureMin[j]);
+        fputs((j + 1 < table.featureCount) ? ", " : "};\n", file);
+    }
+    fprintf(file, "const float %s_MAX[%d] PROGMEM = {", name, table.featureCount);
+    for (int j = 0; j < table.featureCount; j++) {
+        writeFloat(file, table.featureMax[j]);
+        fputs((j + 1 < table.featureCount) ? ", " : "};\n", file);
+    }
+
+    bool weighted = false;
+    for (int j = 0; j < table.featureCount; j++) {
+        if (table.featureWeight[j] != 1.0f) weighted = true;
+    }
+    if (weighted) {
+        fprintf(file, "const float %s_WEIGHTS[%d] PROGMEM = {", name, table.featureCount);
+        for (int j = 0; j < table.featureCount; j++) {
+            writeFloat(file, table.featureWeight[j]);
+            fputs((j + 1 < table.featureCount) ? ", " : "};\n", file);
+        }
+    }
+    fputs("\n", file);
+
+    fprintf(file, "const KNNFlashModel %s = {\n", name);
+    fprintf(file, "        %d, %d, %d, %s,\n", table.featureCount, table.dataCount, table.classCount,
+            table.layout == COLUMN_MAJOR ? "COLUMN_MAJOR" : "ROW_MAJOR");
+    fprintf(file, "        %s_FEATURES, %s_PREPARED, %s_CLASSES, %s_LABELS,\n", name, name, name, name);
+    fprintf(file, "        %s_MIN, %s_MAX, ", name, name);
+    if (weighted) {
+        fprintf(file, "%s_WEIGHTS\n};\n\n#endif\n", name);
+    } else {
+        fputs("nullptr\n};\n\n#endif\n", file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static bool isModelFile(const char *path) {
+    size_t length = strlen(path);
+    return length > 4 && strcmp(path + length - 4, ".knn") == 0;
+}
+
+static bool hasOption(int argc, char **argv, int first, const char *option) {
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], option) == 0) return true;
+    }
+    return false;
+}
+
+static const char *optionValue(int argc, char **argv, int first, const char *prefix) {
+    size_t length = strlen(prefix);
+    for (int i = first; i < argc; i++) {
+        if (strncmp(argv[i], prefix, length) == 0) return argv[i] + length;
+    }
+    return nullptr;
+}
+
+static int usage() {
+    fprintf(stderr,
+            "usage: knn-model-tool header <dataset.csv|model.knn> <output.h> <NAME> [--column-major] "
+            "[--weights=w1,...]\n"
+            "       knn-model-tool binary <dataset.csv> <output.knn> [--column-major] [--k=N] "
+            "[--metric=euclidean|manhattan|cosine] [--weights=w1,...]\n"
+            "       knn-model-tool info <model.knn>\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    static ModelTable table;
+    static const char *metricNames[] = {"euclidean", "manhattan", "cosine"};
+    static const char *precisionNames[] = {"float32", "int16", "int8"};
+
+    if (argc < 3) return usage();
+
+    if (strcmp(argv[1], "info") == 0) {
+        KNNModelHeader header;
+        const char *failure = loadModelFile(argv[2], header, table);
+        if (failure != nullptr) {
+            fprintf(stderr, "%s: %s\n", argv[2], failure);
+            return 1;
+        }
+
+        printf("%s: version %d, %u bytes, crc %08X ok\n", argv[2], header.version, header.fileSize, header.crc);
+        printf("  %u rows, %d features, %d classes, %s %s\n", header.dataCount, header.featureCount,
+               header.classCount, precisionNames[header.precision % 3],
+               header.layout == COLUMN_MAJOR ? "column-major" : "row-major");
+        printf("  k=%d, %s, %s voting, normalization %s\n", header.k, metricNames[header.metric % 3],
+               header.weightedVoting ? "weighted" : "majority", header.normalization ? "on" : "off");
+        printf("  feature weights:");
+        for (int j = 0; j < table.featureCount; j++) {
+            printf(" %g", table.featureWeight[j]);
+        }
+        printf("\n");
+        for (int c = 0; c < table.classCount; c++) {
+            int count = 0;
+            for (int i = 0; i < table.dataCount; i++) {
+                if (table.classes[i] == c) count++;
+            }
+            printf("  class %d \"%s\": %d rows\n", c, table.labels[c], count);
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "header") == 0 || strcmp(argv[1], "binary") == 0) {
+        bool header = strcmp(argv[1], "header") == 0;
+        if (argc < (header ? 5 : 4)) return usage();
+
+        if (header && isModelFile(argv[2])) {
+            KNNModelHeader modelHeader;
+            const char *failure = loadModelFile(argv[2], modelHeader, table);
+            if (failure == nullptr && modelHeader.precision != PRECISION_FLOAT32) {
+                failure = "flash models need a float32 store";
+            }
+            if (failure != nullptr) {
+                fprintf(stderr, "%s: %s\n", argv[2], failure);
+                return 1;
+            }
+        } else if (!loadDataset(argv[2], table)) {
+            fprintf(stderr, "failed to read %s\n", argv[2]);
+            return 1;
+        } else {
+            /*same settings initKNNMethods() applies to the firmware model*/
+            table.k = 5;
+            table.metric = EUCLIDEAN;
+            table.weightedVoting = true;
+            table.normalization = true;
+        }
+
+        int first = header ? 5 : 4;
+        table.layout = hasOption(argc, argv, first, "--column-major") ? COLUMN_MAJOR : ROW_MAJOR;
+        if (const char *k = optionValue(argc, argv, first, "--k=")) table.k = atoi(k);
+        if (const char *metric = optionValue(argc, argv, first, "--metric=")) {
+            for (int m = 0; m < 3; m++) {
+                if (strcmp(metric, metricNames[m]) == 0) table.metric = (DistanceMetric) m;
+            }
+        }
+        if (const char *weights = optionValue(argc, argv, first, "--weights=")) {
+            for (int j = 0; j < table.featureCount; j++) {
+                char *end = nullptr;
+                table.featureWeight[j] = strtof(weights, &end);
+                if (end == weights || table.featureWeight[j] < 0.0f || (*end != ',' && j + 1 < table.featureCount)) {
+                    fprintf(stderr, "--weights needs %d non-negative values\n", table.featureCount);
+                    return 1;
+                }
+                weights = end + 1;
+            }
+        }
+        if (table.k <= 0 || table.k > table.dataCount) {
+            fprintf(stderr, "invalid k %d for %d rows\n", table.k, table.dataCount);
+            return 1;
+        }
+
+        bool written = header ? writeHeader(table, argv[2], argv[3], argv[4]) : writeModelFile(table, argv[3]);
+        if (!written) {
+            fprintf(stderr, "failed to write %s\n", argv[3]);
+            return 1;
+        }
+        printf("%s: %d rows, %d classes\n", argv[3], table.dataCount, table.classCount);
+        return 0;
+    }
+
+    return usage();
+}
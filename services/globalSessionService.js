@@ -24,7 +24,8 @@ export const initializeSystemStatus = async () => {
         lastActivity: null,
         
         // Event-driven weighing fields
-        weighingEvent: '', // start_weighing, continue_weight, continue_height, cancel
+        weighingEvent: '', // start_weighing, continue_weight, continue_height, cancel, confirm_status
+        confirmedStatus: '', // sent with confirm_status, one of the device's five nutrition labels
         weighingStatus: 'idle', // idle, waiting_rfid, weighing, height, calculating, complete
         currentStep: 'idle', // For app state
         realTimeWeight: 0,
@@ -212,7 +213,7 @@ export const startRfidSession = async (userId, userName) => {
 };
 
 // Event-driven weighing functions
-export const sendWeighingEvent = async (event) => {
+export const sendWeighingEvent = async (event, eventFields = {}) => {
   try {
     if (!db) {
       throw new Error('Firestore is not initialized');
@@ -220,6 +221,7 @@ export const sendWeighingEvent = async (event) => {
 
     const systemRef = doc(db, SYSTEM_STATUS_DOC);
     const updateData = {
+      ...eventFields,
       weighingEvent: event,
       lastActivity: new Date()
     };
@@ -245,4 +247,9 @@ export const confirmHeight = async () => {
 
 export const cancelWeighingFlow = async () => {
   return await sendWeighingEvent('cancel');
+};
+
+// The device learns its last weighing under this status; it only accepts the five model labels
+export const confirmNutritionStatus = async (status) => {
+  return await sendWeighingEvent('confirm_status', { confirmedStatus: status });
 };
\ No newline at end of file